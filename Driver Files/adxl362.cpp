@@ -0,0 +1,163 @@
+/*****************************************************************//**
+ * @file adxl362.cpp
+ *
+ * @brief implementation of Adxl362 class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "adxl362.h"
+
+Adxl362::Adxl362(SpiCore *spi_p, int ss) {
+   spi = spi_p;
+   ss_n = ss;
+   n_set = 0;
+   n_part = 0;
+   stat = 0;
+   act = 0;
+   n_bytes = 0;
+   dur_us = 0;
+}
+
+Adxl362::~Adxl362() {
+}
+
+// one transaction: command bytes out, then n bytes in
+void Adxl362::burst(const uint8_t *cmd, int n_cmd, uint8_t *rx, int n) {
+   spi->assert_ss(ss_n);
+   spi->transfer_block(0, rx, n, cmd, n_cmd);
+   spi->deassert_ss(ss_n);
+}
+
+void Adxl362::write_reg(int reg, uint8_t data) {
+   uint8_t cmd[3] = {WR_CMD, (uint8_t) reg, data};
+
+   burst(cmd, 3, 0, 0);
+}
+
+int Adxl362::init() {
+   uint8_t cmd[2] = {RD_CMD, PARTID_REG};
+   uint8_t id;
+
+   spi->set_freq(SPI_FREQ);
+   spi->set_mode(0, 0);
+   write_reg(SOFT_RESET_REG, RESET_KEY);
+   sleep_ms(1);                  // reset takes 0.5 ms
+   burst(cmd, 2, &id, 1);
+   if (id != PARTID)
+      return (0);
+   set_activity(ACT_MG, ACT_SAMPLES);
+   write_reg(FILTER_CTL_REG, 0x13);       // +/-2g, 100 Hz
+   write_reg(FIFO_SAMPLES_REG, 0x80);     // watermark (unused)
+   write_reg(FIFO_CONTROL_REG, 0x02);     // stream mode, no temperature
+   write_reg(POWER_CTL_REG, 0x02);        // measure
+   n_set = 0;
+   n_part = 0;
+   act = 0;
+   return (1);
+}
+
+void Adxl362::set_activity(int thresh_mg, int n_samples) {
+   uint8_t cmd[5];
+
+   cmd[0] = WR_CMD;
+   cmd[1] = THRESH_ACT_REG;
+   cmd[2] = (uint8_t) thresh_mg;
+   cmd[3] = (uint8_t) ((thresh_mg >> 8) & 0x07);
+   cmd[4] = (uint8_t) n_samples;            // TIME_ACT
+   burst(cmd, 5, 0, 0);
+   write_reg(ACT_INACT_CTL_REG, 0x03);      // activity on, referenced
+}
+
+/*
+ * sort fifo entries into x/y/z samples
+ *  - entries are matched by their axis tag, so a sample cut by the
+ *    entry limit continues in the next poll and a sample broken by
+ *    an overrun is dropped
+ */
+void Adxl362::unpack(int n_entry) {
+   uint16_t v;
+   int axis;
+
+   for (int k = 0; k < n_entry; k++) {
+      v = (uint16_t) (raw[2 * k] | (raw[2 * k + 1] << 8));
+      axis = v >> 14;
+      if (axis == 0)
+         n_part = 0;             // a new sample starts
+      if (axis != n_part) {
+         n_part = 0;             // out of step: wait for the next x
+         continue;
+      }
+      part[axis] = (int16_t) (v << 2) >> 2;   // sign-extend 14 bits
+      n_part++;
+      if (n_part == 3) {
+         xyz[n_set][0] = (int16_t) part[0];
+         xyz[n_set][1] = (int16_t) part[1];
+         xyz[n_set][2] = (int16_t) part[2];
+         n_set++;
+         n_part = 0;
+      }
+   }
+}
+
+int Adxl362::poll() {
+   uint8_t cmd[2] = {RD_CMD, STATUS_REG};
+   uint8_t fifo_cmd = FIFO_CMD;
+   uint8_t rx[3];
+   unsigned long t0;
+   int n;
+
+   t0 = now_us();
+   burst(cmd, 2, rx, 3);         // STATUS, FIFO_ENTRIES
+   stat = rx[0];
+   if (stat & STATUS_ACT)
+      act = 1;
+   n = (rx[1] | (rx[2] << 8)) & 0x3ff;
+   n = n - n % 3;                // whole samples only
+   if (n > 3 * MAX_SET)
+      n = 3 * MAX_SET;
+   n_bytes = 5;
+   n_set = 0;
+   if (n > 0) {
+      burst(&fifo_cmd, 1, raw, 2 * n);
+      n_bytes = n_bytes + 1 + 2 * n;
+      unpack(n);
+   }
+   dur_us = now_us() - t0;
+   return (n_set);
+}
+
+int Adxl362::activity() {
+   int a = act;
+
+   act = 0;
+   return (a);
+}
+
+void Adxl362::sample(int i, int *x, int *y, int *z) {
+   *x = xyz[i][0];
+   *y = xyz[i][1];
+   *z = xyz[i][2];
+}
+
+void Adxl362::read_xyz(int *x, int *y, int *z) {
+   uint8_t cmd[2] = {RD_CMD, XDATA_L_REG};
+   uint8_t rx[6];
+
+   burst(cmd, 2, rx, 6);
+   *x = (int16_t) (rx[0] | (rx[1] << 8));
+   *y = (int16_t) (rx[2] | (rx[3] << 8));
+   *z = (int16_t) (rx[4] | (rx[5] << 8));
+}
+
+int Adxl362::status() {
+   return (stat);
+}
+
+int Adxl362::last_bytes() {
+   return (n_bytes);
+}
+
+uint32_t Adxl362::last_us() {
+   return (dur_us);
+}
@@ -0,0 +1,158 @@
+/*****************************************************************//**
+ * @file adxl362.h
+ *
+ * @brief ADXL362 accelerometer on an spi core
+ *
+ * Description:
+ *  - init() configures the sensor once: spi clock/mode, soft reset,
+ *    +/-2g at 100 Hz, fifo in stream mode (x/y/z, no temperature),
+ *    referenced activity detection, measurement mode
+ *  - poll() reads STATUS and FIFO_ENTRIES in one transaction, then
+ *    drains the fifo with one burst read (command 0x0d); a pass with
+ *    no new samples is 5 bytes on the bus
+ *  - every transaction is one SpiCore::transfer_block()
+ *  - activity (a change beyond the threshold on any axis, relative to
+ *    the acceleration when it was last detected) is detected on chip
+ *    and latched in STATUS, so polling can be slow: the fifo holds
+ *    170 x/y/z samples (1.7 s at 100 Hz)
+ *  - fifo entry: bits 15..14 axis (0: x, 1: y, 2: z),
+ *    bits 13..0 sign-extended 12-bit reading (1 mg/LSB at +/-2g)
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _ADXL362_H_INCLUDED
+#define _ADXL362_H_INCLUDED
+
+#include "spi_core.h"
+
+/**
+ * ADXL362 accelerometer driver
+ *
+ */
+class Adxl362 {
+public:
+   /**
+    * register map (partial)
+    *
+    */
+   enum {
+      PARTID_REG = 0x02,
+      XDATA_REG = 0x08,          /**< 8-bit x/y/z */
+      STATUS_REG = 0x0b,
+      FIFO_ENTRIES_REG = 0x0c,   /**< 10-bit, LSB first */
+      XDATA_L_REG = 0x0e,        /**< 12-bit x/y/z, LSB first */
+      SOFT_RESET_REG = 0x1f,
+      THRESH_ACT_REG = 0x20,     /**< 11-bit, LSB first */
+      TIME_ACT_REG = 0x22,
+      ACT_INACT_CTL_REG = 0x27,
+      FIFO_CONTROL_REG = 0x28,
+      FIFO_SAMPLES_REG = 0x29,
+      FILTER_CTL_REG = 0x2c,
+      POWER_CTL_REG = 0x2d
+   };
+   /**
+    * spi commands and field values
+    *
+    */
+   enum {
+      WR_CMD = 0x0a,
+      RD_CMD = 0x0b,
+      FIFO_CMD = 0x0d,
+      PARTID = 0xf2,
+      RESET_KEY = 0x52,
+      STATUS_ACT = 0x10,         /**< activity detected (clears on read) */
+      STATUS_OVERRUN = 0x08      /**< fifo overran; samples were lost */
+   };
+   /**
+    * driver settings
+    *
+    */
+   enum {
+      SPI_FREQ = 4000000,        /**< sensor allows up to 8 MHz */
+      MAX_SET = 32,              /**< x/y/z samples drained per poll */
+      ACT_MG = 1000,             /**< default activity threshold */
+      ACT_SAMPLES = 1            /**< default samples above threshold */
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param spi_p pointer to spi core instance
+    * @param ss slave select # of the sensor
+    *
+    */
+   Adxl362(SpiCore *spi_p, int ss);
+   ~Adxl362();                  // not used
+
+   /**
+    * set up the sensor
+    * @return 1: sensor found and running; 0: wrong part id
+    * @note sets the spi clock and mode; other devices on the bus
+    *       must set their own before a transfer
+    *
+    */
+   int init();
+
+   /**
+    * set activity detection
+    * @param thresh_mg threshold (0 to 2047 mg)
+    * @param n_samples consecutive samples above the threshold (1 to 255)
+    *
+    */
+   void set_activity(int thresh_mg, int n_samples);
+
+   /**
+    * read the status and drain the fifo
+    * @return # x/y/z samples read (at most MAX_SET; the rest is left
+    *         for the next poll)
+    *
+    */
+   int poll();
+
+   /**
+    * activity detected since the last call
+    * @return 1: yes; 0: no
+    * @note updated by poll()
+    *
+    */
+   int activity();
+
+   /**
+    * a sample read by the last poll (oldest first)
+    * @param i sample # (0 to poll() - 1)
+    * @param x/y/z reading in mg
+    *
+    */
+   void sample(int i, int *x, int *y, int *z);
+
+   /**
+    * read the current acceleration (12-bit registers) in one transaction
+    * @param x/y/z reading in mg
+    *
+    */
+   void read_xyz(int *x, int *y, int *z);
+
+   /* statistics of the last poll */
+   int status();              // STATUS register
+   int last_bytes();          // bytes on the bus
+   uint32_t last_us();        // duration
+
+private:
+   SpiCore *spi;
+   int ss_n;
+   uint8_t raw[6 * MAX_SET];     // fifo bytes of a burst
+   int16_t xyz[MAX_SET][3];
+   int n_set;
+   int part[3];                  // x/y of a sample split across polls
+   int n_part;
+   int stat;
+   int act;
+   int n_bytes;
+   uint32_t dur_us;
+   void write_reg(int reg, uint8_t data);
+   void burst(const uint8_t *cmd, int n_cmd, uint8_t *rx, int n);
+   void unpack(int n_entry);
+};
+
+#endif  // _ADXL362_H_INCLUDED
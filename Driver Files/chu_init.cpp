@@ -34,6 +34,11 @@ unsigned long now_ms() {
    return ((unsigned long) _sys_timer.read_time() / 1000);
 }
 
+// current system time in clock ticks
+uint64_t now_tick() {
+   return (_sys_timer.read_tick());
+}
+
 // idle for t microseconds
 void sleep_us(unsigned long int t) {
    _sys_timer.sleep(uint64_t(t));
@@ -55,6 +55,12 @@ unsigned long now_us();
  */
 unsigned long now_ms();
 
+/**
+ * Current system "up time" in system clock ticks.
+ * @note 1 tick = 1/SYS_CLK_FREQ microsecond
+ */
+uint64_t now_tick();
+
 /**
  * idle for t microsecond.
  * @param t idle time
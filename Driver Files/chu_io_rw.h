@@ -11,6 +11,18 @@
 
 // library
 #include <inttypes.h>    // to use unitN_t type
+
+// host (Linux) build: software models replace the I/O bus
+#ifdef _HOST_IO_USED
+#define _VENDOR_IO_ACCESS_USED
+#include "host_io.h"
+#endif
+
+// bus transaction counter
+#ifdef _IO_PROFILE
+#include "io_prof.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -20,8 +32,11 @@ extern "C" {
  *  - offset: 32-bit word offset relative to base
  *  - 4*offset used for byte address
  *  - must bypass data cache for I/O access
- *  - may be replaced with vendor provided macros
- *   (if _VENDOR_IO_ACCESS_USED is defined)
+ *  - raw access may be replaced with vendor provided macros
+ *   (if _VENDOR_IO_ACCESS_USED is defined, the vendor code must
+ *    define io_read_raw() and io_write_raw())
+ *  - io_read()/io_write() go through the transaction counter
+ *    if _IO_PROFILE is defined (see io_prof.h)
  *********************************************************************/
 #ifndef _VENDOR_IO_ACCESS_USED
 
@@ -32,7 +47,7 @@ extern "C" {
  * @return 32-bit data of the register
  * @note macro calculates the byte address of the register and then read
  */
-#define io_read(base_addr, offset) \
+#define io_read_raw(base_addr, offset) \
    (*(volatile uint32_t *)((base_addr) + 4*(offset)))
 
 /**
@@ -41,10 +56,24 @@ extern "C" {
  * @param offset register word offset
  * @param data 32-bit data
  */
-#define io_write(base_addr, offset, data) \
+#define io_write_raw(base_addr, offset, data) \
    (*(volatile uint32_t *)((base_addr) + 4*(offset)) = (data))
 
 #endif  // _VENDOR_IO_ACCESS_USED
+
+#ifdef _IO_PROFILE
+#define io_read(base_addr, offset) \
+   (io_prof_count((uint32_t) ((base_addr) + 4*(offset)), 0), \
+    io_read_raw(base_addr, offset))
+
+#define io_write(base_addr, offset, data) \
+   (io_prof_count((uint32_t) ((base_addr) + 4*(offset)), 1), \
+    io_write_raw(base_addr, offset, data))
+#else
+#define io_read(base_addr, offset) io_read_raw(base_addr, offset)
+#define io_write(base_addr, offset, data) io_write_raw(base_addr, offset, data)
+#endif  // _IO_PROFILE
+
 /**
  * calculate base address of a memory mapped io slot.
  * @param base base-address of FPro system.
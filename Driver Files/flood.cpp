@@ -0,0 +1,253 @@
+/*****************************************************************//**
+ * @file flood.cpp
+ *
+ * @brief implementation of FloodFill class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "flood.h"
+
+FloodFill::FloodFill(FrameCore *frame_p) {
+   frame = frame_p;
+   set_clip(0, 0, FrameCore::HMAX - 1, FrameCore::VMAX - 1);
+   sp = 0;
+   sp_peak = 0;
+   n_drop = 0;
+   n_pre = 0;
+   track = 0;
+}
+
+FloodFill::~FloodFill() {
+}
+
+void FloodFill::set_clip(int x0, int y0, int x1, int y1) {
+   cx0 = (x0 < 0) ? 0 : x0;
+   cy0 = (y0 < 0) ? 0 : y0;
+   cx1 = (x1 > FrameCore::HMAX - 1) ? FrameCore::HMAX - 1 : x1;
+   cy1 = (y1 > FrameCore::VMAX - 1) ? FrameCore::VMAX - 1 : y1;
+}
+
+// queue the scan of row y+dy under run xl..xr of row y
+void FloodFill::push(int y, int xl, int xr, int dy) {
+   Run *r;
+
+   if (y + dy < cy0 || y + dy > cy1)
+      return;
+   if (sp == STACK_SIZE) {
+      // stack full: remember the rows; rescan() picks the run up later
+      n_drop++;
+      if (y < lost_y0)
+         lost_y0 = y;
+      if (y > lost_y1)
+         lost_y1 = y;
+      return;
+   }
+   r = &stack[sp++];
+   r->y = y;
+   r->xl = xl;
+   r->xr = xr;
+   r->dy = dy;
+   if (sp > sp_peak)
+      sp_peak = sp;
+}
+
+/*
+ * note pixels xl..xr of row y as written (call before writing them and
+ * pushing their neighbor rows)
+ *  - until the stack is about to fill, each tile counts its pixels
+ *    written; a rescan only needs runs whose push was dropped, all
+ *    written after that
+ *  - from then on, a tile is read back before its first write: if its
+ *    pixels of the fill color are as many as it counted, all of them
+ *    are this fill's (TILE_CLEAN); otherwise the ones there now are
+ *    kept in a slot as no seeds (pixels written later are seeds)
+ */
+void FloodFill::mark(int y, int xl, int xr) {
+   uint16_t buf[FrameCore::TILE_SIZE];
+   uint8_t bits[FrameCore::TILE_SIZE];
+   int tx, t, x0, x1, y0, y1, row, i, n;
+
+   if (!track && sp >= STACK_SIZE - 1)
+      track = 1;   // the (up to) two pushes of this run may not fit
+   for (tx = xl >> FrameCore::TILE_SHIFT; tx <= xr >> FrameCore::TILE_SHIFT; tx++) {
+      t = (y >> FrameCore::TILE_SHIFT) * FrameCore::TILE_COLS + tx;
+      x0 = tx << FrameCore::TILE_SHIFT;
+      x1 = x0 + FrameCore::TILE_SIZE - 1;
+      if (!track) {
+         tile_st[t] = tile_st[t] + ((x1 < xr) ? x1 : xr) - ((x0 > xl) ? x0 : xl) + 1;
+         continue;
+      }
+      if (tile_st[t] & TILE_TRACKED)
+         continue;
+      // the part of the tile inside the clip rectangle
+      y0 = (y >> FrameCore::TILE_SHIFT) << FrameCore::TILE_SHIFT;
+      y1 = y0 + FrameCore::TILE_SIZE - 1;
+      x0 = (x0 < cx0) ? cx0 : x0;
+      x1 = (x1 > cx1) ? cx1 : x1;
+      y0 = (y0 < cy0) ? cy0 : y0;
+      y1 = (y1 > cy1) ? cy1 : y1;
+      n = 0;
+      for (row = 0; row < FrameCore::TILE_SIZE; row++)
+         bits[row] = 0;
+      for (row = y0; row <= y1; row++) {
+         frame->rd_span(x0, row, x1 - x0 + 1, buf);   // uniform tiles: no bus reads
+         for (i = 0; i <= x1 - x0; i++) {
+            if (buf[i] == new_pix) {
+               bits[row & 7] = bits[row & 7] | (1 << ((x0 + i) & 7));
+               n++;
+            }
+         }
+      }
+      if (n == tile_st[t]) {
+         tile_st[t] = TILE_CLEAN;
+      } else if (n_pre == PRE_SLOTS) {
+         tile_st[t] = TILE_UNSURE;
+      } else {
+         for (row = 0; row < FrameCore::TILE_SIZE; row++)
+            pre_mask[n_pre][row] = bits[row];
+         tile_st[t] = TILE_TRACKED | n_pre;
+         n_pre++;
+      }
+   }
+}
+
+// pixel a rescan may seed from: written by this fill() (0 if not known)
+int FloodFill::marked(int x, int y) {
+   uint8_t st;
+
+   st = tile_st[(y >> FrameCore::TILE_SHIFT) * FrameCore::TILE_COLS + (x >> FrameCore::TILE_SHIFT)];
+   if (!(st & TILE_TRACKED) || st == TILE_UNSURE || frame->rd_pix(x, y) != new_pix)
+      return (0);
+   if (st == TILE_CLEAN)
+      return (1);
+   return (!((pre_mask[st & ~TILE_TRACKED][y & 7] >> (x & 7)) & 1));
+}
+
+int FloodFill::fill(int x, int y, int color) {
+   uint16_t old_pix;
+   int n, i;
+
+   sp = 0;
+   sp_peak = 0;
+   n_drop = 0;
+   if (x < cx0 || x > cx1 || y < cy0 || y > cy1)
+      return (0);
+   old_pix = frame->rd_pix(x, y);
+   new_pix = FrameCore::pack9(color);
+   if (old_pix == new_pix)
+      return (0);
+   for (i = 0; i < FrameCore::TILE_ROWS * FrameCore::TILE_COLS; i++)
+      tile_st[i] = 0;
+   n_pre = 0;
+   track = 0;
+   lost_y0 = cy1 + 1;
+   lost_y1 = cy0 - 1;
+   // seed run: row y scanned under a virtual run above it (popped first);
+   // the row above the seed pixel is not covered by the leak pushes
+   push(y, x, x, -1);
+   push(y - 1, x, x, 1);
+   n = scan(old_pix, color);
+   while (lost_y0 <= lost_y1) {
+      rescan(old_pix);
+      n = n + scan(old_pix, color);
+   }
+   return (n);
+}
+
+/*
+ * pop runs until the stack is empty
+ *  - row y+dy is scanned under parent run xl..xr; every run of old
+ *    color found there is filled and pushed for row y+2*dy
+ *  - parts of a run sticking out past the parent are pushed back
+ *    toward the parent row (the region may turn around a corner)
+ */
+int FloodFill::scan(uint16_t old_pix, int color) {
+   Run *r;
+   int x, y, x1, x2, dy, l, n;
+
+   n = 0;
+   while (sp > 0) {
+      r = &stack[--sp];
+      dy = r->dy;
+      y = r->y + dy;
+      x1 = r->xl;
+      x2 = r->xr;
+      // extend left from x1
+      for (x = x1; x >= cx0 && frame->rd_pix(x, y) == old_pix; x--)
+         ;
+      if (x < x1) {
+         l = x + 1;
+         if (l < x1)
+            push(y, l, x1 - 1, -dy);   // leak on the left
+         x = x1 + 1;
+      } else {
+         l = -1;                       // x1 itself is a border pixel
+      }
+      do {
+         if (l >= 0) {
+            // extend right; l..x-1 is one run of old color
+            for (; x <= cx1 && frame->rd_pix(x, y) == old_pix; x++)
+               ;
+            mark(y, l, x - 1);
+            frame->wr_span(l, y, x - l, color);
+            n = n + x - l;
+            push(y, l, x - 1, dy);
+            if (x > x2 + 1)
+               push(y, x2 + 1, x - 1, -dy);   // leak on the right
+         }
+         // skip border pixels up to the next run under the parent
+         for (x++; x <= x2 && frame->rd_pix(x, y) != old_pix; x++)
+            ;
+         l = x;
+      } while (x <= x2);
+   }
+   return (n);
+}
+
+/*
+ * recover dropped runs
+ *  - in the rows around them, every run of old color with a pixel
+ *    filled by this call directly above or below is pushed as a seed
+ *  - rows are rescanned top-down with the stack refilled as it goes;
+ *    anything dropped again widens the next rescan
+ */
+void FloodFill::rescan(uint16_t old_pix) {
+   int y, x, y0, y1, dy, found;
+
+   y0 = lost_y0 - 1;
+   y1 = lost_y1 + 1;
+   lost_y0 = cy1 + 1;
+   lost_y1 = cy0 - 1;
+   if (y0 < cy0)
+      y0 = cy0;
+   if (y1 > cy1)
+      y1 = cy1;
+   for (y = y0; y <= y1; y++) {
+      x = cx0;
+      while (x <= cx1) {
+         if (frame->rd_pix(x, y) != old_pix) {
+            x++;
+            continue;
+         }
+         // run of old color; look for filled pixels next to it
+         found = 0;
+         for (; x <= cx1 && frame->rd_pix(x, y) == old_pix; x++) {
+            for (dy = -1; dy <= 1 && !found; dy = dy + 2) {
+               if (y + dy >= cy0 && y + dy <= cy1 && marked(x, y + dy)) {
+                  push(y + dy, x, x, -dy);
+                  found = 1;
+               }
+            }
+         }
+      }
+   }
+}
+
+int FloodFill::peak() {
+   return (sp_peak);
+}
+
+int FloodFill::dropped() {
+   return (n_drop);
+}
@@ -0,0 +1,130 @@
+/*****************************************************************//**
+ * @file flood.h
+ *
+ * @brief Bucket (flood) fill of a 4-connected region in the frame buffer
+ *
+ * Description:
+ *  - scanline seed fill (Heckbert, Graphics Gems I): each stack entry
+ *    is a run of a row whose neighbor row still has to be scanned
+ *  - pixels are read back with FrameCore::rd_pix() and each filled
+ *    run is written as one FrameCore::wr_span()
+ *  - the run stack is a fixed member array (no heap, and only a few
+ *    words of the 1K program stack)
+ *  - when the run stack is full, the dropped run is not lost: the
+ *    rows around it are rescanned once the stack drains, and runs
+ *    of the old color touching pixels filled by this call are filled
+ *    from there
+ *  - a rescan seeds only from pixels filled by this call, told apart
+ *    per 8-by-8 frame tile (a byte each, 4.7 KB): each tile counts its
+ *    pixels filled, and once the stack is nearly full, a tile about to
+ *    be written is read back; if it has more pixels of the new color
+ *    than it counted, the ones there now are kept as no seeds in a
+ *    64-bit mask (PRE_SLOTS such tiles), so pixels that had the new
+ *    color before never seed a rescan
+ *  - fill is limited to a clip rectangle (e.g., the canvas)
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _FLOOD_H_INCLUDED
+#define _FLOOD_H_INCLUDED
+
+#include "vga_core.h"
+
+/**
+ * flood fill module
+ *
+ */
+class FloodFill {
+public:
+   /**
+    * run stack size (entries of 8 bytes) and # tiles holding the fill
+    * color from before whose pixels can be told apart
+    *
+    */
+   enum {
+      STACK_SIZE = 256,
+      PRE_SLOTS = 120
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param frame_p pointer to frame buffer instance
+    * @note clip rectangle defaults to the whole frame (cut as in
+    *       set_clip())
+    *
+    */
+   FloodFill(FrameCore *frame_p);
+   ~FloodFill();                  // not used
+
+   /**
+    * limit filling to a rectangle
+    * @param x0 leftmost column
+    * @param y0 top row
+    * @param x1 rightmost column
+    * @param y1 bottom row
+    *
+    */
+   void set_clip(int x0, int y0, int x1, int y1);
+
+   /**
+    * fill the region containing a seed pixel
+    * @param x x-coordinate of the seed
+    * @param y y-coordinate of the seed
+    * @param color 12-bit fill color
+    * @return # pixels filled
+    *
+    * @note nothing is done if the seed is outside the clip rectangle
+    *       or already has the (9-bit) fill color
+    * @note after a stack overflow, pixels in tiles past the first
+    *       PRE_SLOTS that held the fill color from before do not seed
+    *       a rescan: the fill may stop short there, but never leaks
+    *
+    */
+   int fill(int x, int y, int color);
+
+   /**
+    * largest # stack entries used by the last fill()
+    *
+    */
+   int peak();
+
+   /**
+    * # runs dropped (stack full) and recovered by rescans in the last fill()
+    *
+    */
+   int dropped();
+
+private:
+   struct Run {
+      int16_t y;       // row already filled
+      int16_t xl, xr;  // run of that row
+      int16_t dy;      // neighbor row to scan: y + dy
+   };
+   /* tile_st after the tile is read back */
+   enum {
+      TILE_TRACKED = 0x80,   // read back; low bits: pre_mask slot
+      TILE_UNSURE = 0xfe,    // fill color from before, no slot left
+      TILE_CLEAN = 0xff      // every pixel of the fill color is this fill's
+   };
+   FrameCore *frame;
+   int cx0, cy0, cx1, cy1;     // clip rectangle
+   Run stack[STACK_SIZE];
+   uint8_t tile_st[FrameCore::TILE_ROWS * FrameCore::TILE_COLS];   // # pixels filled, or TILE_*
+   uint8_t pre_mask[PRE_SLOTS][8];   // bit x of row y: no seed (first n_pre slots)
+   int n_pre;
+   int track;                  // 1: stack nearly full, tiles are read back
+   uint16_t new_pix;           // 9-bit fill color
+   int sp;
+   int sp_peak;
+   int n_drop;
+   int lost_y0, lost_y1;       // rows around dropped runs (lost_y0 > lost_y1: none)
+   void push(int y, int xl, int xr, int dy);
+   void mark(int y, int xl, int xr);
+   int marked(int x, int y);
+   int scan(uint16_t old_pix, int color);
+   void rescan(uint16_t old_pix);
+};
+
+#endif  // _FLOOD_H_INCLUDED
@@ -0,0 +1,149 @@
+/*****************************************************************//**
+ * @file io_prof.cpp
+ *
+ * @brief implementation of bus transaction counters
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "chu_init.h"
+#include "io_prof.h"
+#include <string.h>
+
+// counter index: frame, 8 video slots, 64 mmio slots
+enum {
+   CORE_FRAME = 0,
+   CORE_VIDEO = 1,
+   CORE_MMIO = 9,
+   N_CORE = 73,
+   N_SITE = 16,
+   BAR_MAX = 40
+};
+
+static const char *const video_name[8] =
+   {"sync", "mouse", "osd", "ghost", "user4", "user5", "gray", "bar"};
+static const char *const mmio_name[14] =
+   {"timer", "uart", "led", "sw", "user", "xadc", "pwm", "btn", "sseg",
+    "spi", "i2c", "ps2", "ddfs", "adsr"};
+
+static uint32_t core_cnt[N_CORE][2];
+static uint32_t site_cnt[N_SITE][2];
+static const char *site_label[N_SITE] = {"other"};
+static int n_site = 1;
+static int cur_site = 0;
+static int paused = 0;
+
+void io_prof_count(uint32_t addr, int wr) {
+   uint32_t fp_addr;
+   int core;
+
+   if (paused)
+      return;
+   fp_addr = (addr >> 2) & 0x001fffff;   // 21-bit word address
+   if (!(addr & 0x00800000))
+      core = CORE_MMIO + ((fp_addr >> 5) & 0x3f);
+   else if (fp_addr & 0x00100000)
+      core = CORE_FRAME;
+   else
+      core = CORE_VIDEO + ((fp_addr >> 14) & 0x07);
+   core_cnt[core][wr]++;
+   site_cnt[cur_site][wr]++;
+}
+
+int io_prof_enter(const char *label) {
+   int prev = cur_site;
+   int i;
+
+   for (i = 0; i < n_site; i++) {
+      if (site_label[i] == label || strcmp(site_label[i], label) == 0)
+         break;
+   }
+   if (i == n_site) {
+      if (n_site == N_SITE) {
+         i = 0;            // table full
+      } else {
+         site_label[i] = label;
+         n_site++;
+      }
+   }
+   cur_site = i;
+   return (prev);
+}
+
+void io_prof_leave(int site) {
+   cur_site = site;
+}
+
+void io_prof_clear() {
+   for (int i = 0; i < N_CORE; i++) {
+      core_cnt[i][0] = 0;
+      core_cnt[i][1] = 0;
+   }
+   for (int i = 0; i < N_SITE; i++) {
+      site_cnt[i][0] = 0;
+      site_cnt[i][1] = 0;
+   }
+}
+
+// one line: name, reads, writes and a bar scaled to max
+static void disp_row(const char *name, int n, uint32_t *cnt, uint32_t max) {
+   uint32_t total = cnt[0] + cnt[1];
+   int len;
+
+   uart.disp("  ");
+   uart.disp(name);
+   if (n >= 0)
+      uart.disp(n);
+   uart.disp(" rd=");
+   uart.disp((int) cnt[0]);
+   uart.disp(" wr=");
+   uart.disp((int) cnt[1]);
+   uart.disp(" |");
+   len = (max == 0) ? 0 : (int) ((uint64_t) total * BAR_MAX / max);
+   if (len == 0 && total > 0)
+      len = 1;
+   for (int i = 0; i < len; i++)
+      uart.disp('#');
+   uart.disp("\n\r");
+}
+
+void io_prof_dump() {
+   uint32_t max;
+   int slot;
+
+   paused = 1;
+   // per core
+   max = 0;
+   for (int i = 0; i < N_CORE; i++) {
+      if (core_cnt[i][0] + core_cnt[i][1] > max)
+         max = core_cnt[i][0] + core_cnt[i][1];
+   }
+   uart.disp("io profile (per core):\n\r");
+   for (int i = 0; i < N_CORE; i++) {
+      if (core_cnt[i][0] + core_cnt[i][1] == 0)
+         continue;
+      if (i == CORE_FRAME) {
+         disp_row("frame", -1, core_cnt[i], max);
+      } else if (i < CORE_MMIO) {
+         disp_row(video_name[i - CORE_VIDEO], -1, core_cnt[i], max);
+      } else {
+         slot = i - CORE_MMIO;
+         if (slot < 14)
+            disp_row(mmio_name[slot], -1, core_cnt[i], max);
+         else
+            disp_row("slot", slot, core_cnt[i], max);
+      }
+   }
+   // per call site
+   max = 0;
+   for (int i = 0; i < n_site; i++) {
+      if (site_cnt[i][0] + site_cnt[i][1] > max)
+         max = site_cnt[i][0] + site_cnt[i][1];
+   }
+   uart.disp("io profile (per site):\n\r");
+   for (int i = 0; i < n_site; i++) {
+      if (site_cnt[i][0] + site_cnt[i][1] > 0)
+         disp_row(site_label[i], -1, site_cnt[i], max);
+   }
+   paused = 0;
+}
@@ -0,0 +1,78 @@
+/*****************************************************************//**
+ * @file io_prof.h
+ *
+ * @brief Count bus transactions per core and per tagged call site
+ *
+ * Description:
+ *  - enabled by defining _IO_PROFILE (e.g., -D_IO_PROFILE); otherwise
+ *    io_read()/io_write() are the raw accesses and IO_PROF_SCOPE()
+ *    expands to nothing
+ *  - each access is charged to the core decoded from its address
+ *    (same decoding as chu_mcs_bridge):
+ *      frame buffer, video slots 0-7, mmio slots 0-63
+ *  - and to the call site tagged by the innermost IO_PROF_SCOPE()
+ *  - io_prof_dump() prints a histogram on the uart console; its own
+ *    uart accesses are not counted
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _IO_PROF_H_INCLUDED
+#define _IO_PROF_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * charge one bus access (called by io_read()/io_write())
+ * @param addr byte address of the register
+ * @param wr 0: read; 1: write
+ */
+void io_prof_count(uint32_t addr, int wr);
+
+/**
+ * make a call site the current one
+ * @param label site name (string literal); at most 15 sites
+ * @return previous site (to be restored by io_prof_leave())
+ * @note accesses beyond the site limit are charged to "other"
+ */
+int io_prof_enter(const char *label);
+
+/**
+ * return to a previous call site
+ * @param site value returned by io_prof_enter()
+ */
+void io_prof_leave(int site);
+
+/**
+ * reset all counters (site labels are kept)
+ */
+void io_prof_clear();
+
+/**
+ * print per-core and per-site counts on the uart console
+ */
+void io_prof_dump();
+
+/**
+ * tag the accesses in the enclosing block
+ */
+class IoProfScope {
+public:
+   IoProfScope(const char *label) {
+      prev = io_prof_enter(label);
+   }
+   ~IoProfScope() {
+      io_prof_leave(prev);
+   }
+private:
+   int prev;
+};
+
+// tag a block; no code is generated unless _IO_PROFILE is defined
+#ifdef _IO_PROFILE
+#define IO_PROF_SCOPE(label) IoProfScope _io_prof_scope(label)
+#else
+#define IO_PROF_SCOPE(label)
+#endif
+
+#endif  // _IO_PROF_H_INCLUDED
@@ -0,0 +1,430 @@
+/*****************************************************************//**
+ * @file journal.cpp
+ *
+ * @brief implementation of Journal class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+/*
+ * operation encoding
+ *  - 0x00-0x78: short move; dx = b / 11 - 5, dy = b % 11 - 5
+ *  - OP_MOVE dx dy: move by signed 8-bit deltas
+ *  - OP_JUMP xy[3]: move to x, y (delta too large for OP_MOVE)
+ *  - OP_DOWN xy[3] r c[2]: stroke starts at x, y with radius r and
+ *    color c (bit 15: eraser)
+ *  - OP_ATTR r c[2]: radius/color change within a stroke
+ *  - OP_UP: pen up
+ *  - OP_FILL xy[3] c[2]: bucket fill at x, y
+ *  - OP_CLEAR: canvas cleared
+ *  - xy[3]: x in bits 9..0, y in bits 19..10, little endian
+ *  - every step starts with OP_DOWN, OP_FILL or OP_CLEAR, so a step
+ *    decodes without the ones before it
+ */
+
+#include "journal.h"
+
+enum {
+   SHORT_MAX = 120,
+   OP_MOVE = 0x80,
+   OP_JUMP,
+   OP_DOWN,
+   OP_ATTR,
+   OP_UP,
+   OP_FILL,
+   OP_CLEAR,
+   ERASE_FLAG = 0x8000
+};
+
+static int pack_xy(uint8_t *p, int x, int y) {
+   uint32_t v = (uint32_t) (x & 0x3ff) | ((uint32_t) (y & 0x3ff) << 10);
+
+   p[0] = (uint8_t) v;
+   p[1] = (uint8_t) (v >> 8);
+   p[2] = (uint8_t) (v >> 16);
+   return (3);
+}
+
+Journal::Journal(FrameCore *frame_p, Stroke *stroke_p, FloodFill *flood_p) {
+   frame = frame_p;
+   stroke = stroke_p;
+   flood = flood_p;
+   snap = 0;
+   since_snap = 0;
+   set_canvas(0, 0, FrameCore::HMAX, FrameCore::VMAX, 0xfff);
+   base = 0;
+   end = 0;
+   base_blank = 1;
+   n_step = 0;
+   cur = 0;
+   open = 0;
+   pen = 0;
+   ex = 0;
+   ey = 0;
+   er = 0;
+   ec = 0;
+   n_evict = 0;
+   n_lost = 0;
+   last_us = 0;
+}
+
+Journal::~Journal() {
+}
+
+void Journal::set_canvas(int x, int y, int w, int h, int bg) {
+   cv_x = x;
+   cv_y = y;
+   cv_w = w;
+   cv_h = h;
+   cv_bg = bg;
+}
+
+void Journal::set_snap(CanvasSnap *snap_p) {
+   snap = snap_p;
+   since_snap = 0;
+}
+
+int Journal::draw(int x, int y, int r, int color, int erase) {
+   uint8_t p[8];
+   int n = 0;
+   int c = (color & 0xfff) | (erase ? ERASE_FLAG : 0);
+   int dx, dy;
+
+   if (!pen) {
+      p[n++] = OP_DOWN;
+      n = n + pack_xy(&p[n], x, y);
+      p[n++] = (uint8_t) r;
+      p[n++] = (uint8_t) c;
+      p[n++] = (uint8_t) (c >> 8);
+   } else {
+      if (r != er || c != ec) {
+         p[n++] = OP_ATTR;
+         p[n++] = (uint8_t) r;
+         p[n++] = (uint8_t) c;
+         p[n++] = (uint8_t) (c >> 8);
+      }
+      dx = x - ex;
+      dy = y - ey;
+      if (dx >= -5 && dx <= 5 && dy >= -5 && dy <= 5) {
+         p[n++] = (uint8_t) ((dx + 5) * 11 + (dy + 5));
+      } else if (dx >= -128 && dx <= 127 && dy >= -128 && dy <= 127) {
+         p[n++] = OP_MOVE;
+         p[n++] = (uint8_t) dx;
+         p[n++] = (uint8_t) dy;
+      } else {
+         p[n++] = OP_JUMP;
+         n = n + pack_xy(&p[n], x, y);
+      }
+   }
+   put(p, n);
+   pen = 1;
+   ex = x;
+   ey = y;
+   er = r;
+   ec = c;
+   return (stroke->draw(x, y, r, color));
+}
+
+void Journal::lift() {
+   uint8_t op = OP_UP;
+
+   stroke->lift();
+   if (!pen)
+      return;
+   put(&op, 1);
+   pen = 0;
+   close_step(0);
+}
+
+int Journal::fill(int x, int y, int color) {
+   uint8_t p[6];
+   int n;
+
+   lift();
+   n = flood->fill(x, y, color);
+   if (n == 0)
+      return (0);                // nothing changed: not a step
+   p[0] = OP_FILL;
+   pack_xy(&p[1], x, y);
+   p[4] = (uint8_t) color;
+   p[5] = (uint8_t) ((color >> 8) & 0x0f);
+   put(p, 6);
+   close_step(0);
+   return (n);
+}
+
+void Journal::clear() {
+   uint8_t op = OP_CLEAR;
+
+   lift();
+   put(&op, 1);
+   close_step(1);
+}
+
+void Journal::restart() {
+   lift();
+   base = end;
+   n_step = 0;
+   cur = 0;
+   open = 0;
+   base_blank = 0;
+   since_snap = 0;
+   if (snap) {
+      snap->keep(base, base);
+      snap->capture(base);
+   }
+}
+
+// append bytes; drop redo steps and old history as needed
+void Journal::put(const uint8_t *p, int n) {
+   if (!open && cur < n_step) {
+      // new operation after undo: the undone steps cannot be redone
+      end = cur ? step_end[cur - 1] : base;
+      n_step = cur;
+      if (snap)
+         snap->keep(base, end);
+   }
+   while (end - base + n > BUF_SIZE)
+      evict();
+   for (int i = 0; i < n; i++)
+      buf[(end + i) % BUF_SIZE] = p[i];
+   end = end + n;
+   open = 1;
+}
+
+void Journal::close_step(int is_clear) {
+   uint8_t c0;
+
+   if (n_step == MAX_STEP) {
+      // table full: merge the two oldest steps
+      c0 = step_clear[0];
+      for (int i = 0; i < n_step - 1; i++) {
+         step_end[i] = step_end[i + 1];
+         step_clear[i] = step_clear[i + 1];
+      }
+      step_clear[0] = c0;
+      n_step--;
+   }
+   step_end[n_step] = end;
+   step_clear[n_step] = (uint8_t) is_clear;
+   n_step++;
+   cur = n_step;
+   open = 0;
+   if (snap && ++since_snap >= SNAP_STEPS) {
+      snap->capture(end);        // on failure, retry after SNAP_STEPS
+      since_snap = 0;
+   }
+}
+
+// free space: drop the oldest steps up to the next clear or snapshot
+void Journal::evict() {
+   int k;
+
+   for (k = 1; k < n_step && !step_clear[k]; k++) {
+      if (snap && snap->find(step_end[k - 1], step_end[k - 1]) >= 0)
+         break;                  // canvas at the start of step k is kept
+   }
+   if (k >= n_step) {
+      // nothing to cut at: the canvas before 'end' cannot be rebuilt
+      base = end;
+      n_step = 0;
+      cur = 0;
+      base_blank = 0;
+      n_lost++;
+      if (snap)
+         snap->keep(base, end);
+      return;
+   }
+   base = step_end[k - 1];
+   for (int i = 0; i < n_step - k; i++) {
+      step_end[i] = step_end[i + k];
+      step_clear[i] = step_clear[i + k];
+   }
+   n_step = n_step - k;
+   cur = cur - k;
+   base_blank = 0;               // base now holds a clear or a snapshot
+   n_evict++;
+   if (snap)
+      snap->keep(base, end);
+}
+
+// check whether the canvas after t steps can be rebuilt
+int Journal::reachable(int t) {
+   if (base_blank)
+      return (1);
+   for (int i = 0; i < t; i++)
+      if (step_clear[i])
+         return (1);
+   return (snap && snap->find(base, t ? step_end[t - 1] : base) >= 0);
+}
+
+/*
+ * rebuild the canvas after t steps
+ *  - start from the latest checkpoint: a snapshot, a clear step or
+ *    the blank canvas at base; a snapshot wins a tie (it rewrites
+ *    only the tiles that changed)
+ *  - return 0 if there is none
+ */
+int Journal::rebuild(int t) {
+   uint32_t from, to;
+   int i, s, found;
+
+   to = t ? step_end[t - 1] : base;
+   for (i = t - 1; i >= 0 && !step_clear[i]; i--)
+      ;
+   found = (i >= 0 || base_blank);
+   from = (i > 0) ? step_end[i - 1] : base;
+   s = snap ? snap->find(base, to) : -1;
+   if (s >= 0 && (!found || snap->tag(s) - base >= from - base)) {
+      snap->restore(s);
+      from = snap->tag(s);
+   } else if (!found) {
+      return (0);                // canvas at base is gone
+   } else if (i < 0) {
+      frame->fillRect(cv_x, cv_y, cv_w, cv_h, cv_bg);
+   }
+   replay(from, to);
+   return (1);
+}
+
+int Journal::undo() {
+   unsigned long t0;
+
+   lift();
+   if (cur == 0)
+      return (0);
+   t0 = now_us();
+   if (!rebuild(cur - 1))
+      return (0);
+   cur--;
+   last_us = now_us() - t0;
+   return (1);
+}
+
+int Journal::redo() {
+   unsigned long t0;
+
+   lift();
+   if (cur == n_step)
+      return (0);
+   t0 = now_us();
+   replay(cur ? step_end[cur - 1] : base, step_end[cur]);
+   cur++;
+   last_us = now_us() - t0;
+   return (1);
+}
+
+uint8_t Journal::byte_at(uint32_t pos) {
+   return (buf[pos % BUF_SIZE]);
+}
+
+// decode and draw the operations in [from, to)
+void Journal::replay(uint32_t from, uint32_t to) {
+   uint32_t pos = from;
+   uint32_t v;
+   int b, x = 0, y = 0, r = 0, c = 0;
+
+   stroke->lift();
+   while (pos != to) {
+      b = byte_at(pos++);
+      if (b <= SHORT_MAX) {
+         x = x + b / 11 - 5;
+         y = y + b % 11 - 5;
+         stroke->draw(x, y, r, c & 0xfff);
+         continue;
+      }
+      switch (b) {
+      case OP_MOVE:
+         x = x + (int8_t) byte_at(pos);
+         y = y + (int8_t) byte_at(pos + 1);
+         pos = pos + 2;
+         stroke->draw(x, y, r, c & 0xfff);
+         break;
+      case OP_JUMP:
+      case OP_DOWN:
+      case OP_FILL:
+         v = byte_at(pos) | (byte_at(pos + 1) << 8) | ((uint32_t) byte_at(pos + 2) << 16);
+         pos = pos + 3;
+         x = v & 0x3ff;
+         y = (v >> 10) & 0x3ff;
+         if (b == OP_DOWN)
+            r = byte_at(pos++);
+         if (b != OP_JUMP) {
+            c = byte_at(pos) | (byte_at(pos + 1) << 8);
+            pos = pos + 2;
+         }
+         if (b == OP_FILL) {
+            flood->fill(x, y, c);
+         } else {
+            if (b == OP_DOWN)
+               stroke->lift();
+            stroke->draw(x, y, r, c & 0xfff);
+         }
+         break;
+      case OP_ATTR:
+         r = byte_at(pos);
+         c = byte_at(pos + 1) | (byte_at(pos + 2) << 8);
+         pos = pos + 3;
+         break;
+      case OP_UP:
+         stroke->lift();
+         break;
+      case OP_CLEAR:
+         frame->fillRect(cv_x, cv_y, cv_w, cv_h, cv_bg);
+         break;
+      default:
+         pos = to;               // not an operation: stop
+         break;
+      }
+   }
+   stroke->lift();
+}
+
+int Journal::bytes_used() {
+   return ((int) (end - base));
+}
+
+int Journal::steps() {
+   return (n_step);
+}
+
+int Journal::undo_levels() {
+   int t;
+
+   // as far back as the oldest canvas that can be rebuilt
+   for (t = 0; t < cur && !reachable(t); t++)
+      ;
+   return (cur - t);
+}
+
+int Journal::redo_levels() {
+   return (n_step - cur);
+}
+
+uint32_t Journal::replay_us() {
+   return (last_us);
+}
+
+void Journal::dump() {
+   uart.disp("journal: ");
+   uart.disp(bytes_used());
+   uart.disp("/");
+   uart.disp((int) BUF_SIZE);
+   uart.disp(" bytes, ");
+   uart.disp(n_step);
+   uart.disp("/");
+   uart.disp((int) MAX_STEP);
+   uart.disp(" steps, undo ");
+   uart.disp(undo_levels());
+   uart.disp(" redo ");
+   uart.disp(redo_levels());
+   uart.disp(", evicted ");
+   uart.disp((int) n_evict);
+   uart.disp(" lost ");
+   uart.disp((int) n_lost);
+   uart.disp(", last replay ");
+   uart.disp((int) last_us);
+   uart.disp(" us\n\r");
+   if (snap)
+      snap->dump();
+}
@@ -0,0 +1,173 @@
+/*****************************************************************//**
+ * @file journal.h
+ *
+ * @brief Drawing journal with multi-level undo/redo
+ *
+ * Description:
+ *  - records brush segments, bucket fills and canvas clears in a
+ *    fixed-size byte ring (delta encoded, see journal.cpp) and draws
+ *    them through Stroke/FloodFill at the same time
+ *  - an undo step ends at pen-up, after a fill and after a clear
+ *  - undo rebuilds the canvas by replaying from the last checkpoint:
+ *    the latest canvas snapshot or clear before the target step, else
+ *    the blank canvas the journal started from
+ *  - with a CanvasSnap attached, a snapshot is taken every SNAP_STEPS
+ *    steps (at the end of a step), so an undo replays a few steps on
+ *    top of the restored tiles instead of the whole session
+ *  - redo replays just the next step on top of the current canvas
+ *  - memory is bounded: when the ring is full, the oldest steps up to
+ *    the next clear or snapshot are discarded; with neither to cut at,
+ *    history is dropped (undo then stops at the next clear)
+ *  - when the step table is full, the two oldest steps are merged
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _JOURNAL_H_INCLUDED
+#define _JOURNAL_H_INCLUDED
+
+#include "stroke.h"
+#include "flood.h"
+#include "snap.h"
+
+/**
+ * drawing journal module
+ *
+ */
+class Journal {
+public:
+   /**
+    * memory budget
+    *
+    */
+   enum {
+      BUF_SIZE = 4096,  /**< bytes of encoded operations */
+      MAX_STEP = 64,    /**< undo steps kept */
+      SNAP_STEPS = 8    /**< steps between canvas snapshots */
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param frame_p pointer to frame buffer instance
+    * @param stroke_p brush stroke engine drawing the segments
+    * @param flood_p flood fill module doing the fills
+    * @note journal starts from a blank canvas
+    *
+    */
+   Journal(FrameCore *frame_p, Stroke *stroke_p, FloodFill *flood_p);
+   ~Journal();                  // not used
+
+   /**
+    * set the canvas rectangle painted by a replayed clear
+    * @param x top left x coordinate
+    * @param y top left y coordinate
+    * @param w width
+    * @param h height
+    * @param bg 12-bit background color
+    *
+    */
+   void set_canvas(int x, int y, int w, int h, int bg);
+
+   /**
+    * take canvas snapshots for faster undo
+    * @param snap_p snapshot module covering the same canvas; 0: none
+    *
+    */
+   void set_snap(CanvasSnap *snap_p);
+
+   /**
+    * record and draw a brush segment (see Stroke::draw())
+    * @param x x-coordinate of brush center
+    * @param y y-coordinate of brush center
+    * @param r brush radius (up to 255)
+    * @param color brush color
+    * @param erase 1: eraser (kept in the journal; color is still drawn)
+    * @return # pixels written
+    *
+    */
+   int draw(int x, int y, int r, int color, int erase);
+
+   /**
+    * record pen-up (ends an undo step if a stroke was open)
+    *
+    */
+   void lift();
+
+   /**
+    * record and do a bucket fill (see FloodFill::fill())
+    * @return # pixels filled
+    *
+    */
+   int fill(int x, int y, int color);
+
+   /**
+    * record a canvas clear (a checkpoint)
+    * @note the caller has already cleared the canvas
+    *
+    */
+   void clear();
+
+   /**
+    * forget all steps; the current canvas becomes the oldest state
+    * (e.g., after an imported image was painted)
+    * @note undo back to it needs a snapshot (set_snap())
+    *
+    */
+   void restart();
+
+   /**
+    * undo the last step
+    * @return 1: done; 0: nothing to undo or history dropped
+    *
+    */
+   int undo();
+
+   /**
+    * redo the last undone step
+    * @return 1: done; 0: nothing to redo
+    *
+    */
+   int redo();
+
+   /* statistics */
+   int bytes_used();     // encoded bytes kept
+   int steps();          // closed steps kept
+   int undo_levels();    // steps that can be undone at most
+   int redo_levels();    // steps that can be redone
+   uint32_t replay_us(); // duration of the last undo/redo
+
+   /**
+    * print memory use and step counts on the uart
+    *
+    */
+   void dump();
+
+private:
+   FrameCore *frame;
+   Stroke *stroke;
+   FloodFill *flood;
+   CanvasSnap *snap;
+   int since_snap;              // steps closed since the last snapshot
+   int cv_x, cv_y, cv_w, cv_h, cv_bg;    // canvas for replayed clears
+   uint8_t buf[BUF_SIZE];
+   uint32_t base, end;          // logical positions of oldest/next byte
+   int base_blank;              // 1: canvas at base is the blank canvas
+   uint32_t step_end[MAX_STEP]; // logical end of each closed step
+   uint8_t step_clear[MAX_STEP];// 1: step is a clear
+   int n_step;                  // closed steps kept
+   int cur;                     // steps currently applied
+   int open;                    // 1: bytes recorded after the last closed step
+   int pen, ex, ey, er, ec;     // encoder state of the open stroke
+   uint32_t n_evict, n_lost;
+   uint32_t last_us;
+   void put(const uint8_t *p, int n);
+   void close_step(int is_clear);
+   void evict();
+   void replay(uint32_t from, uint32_t to);
+   int reachable(int t);
+   int rebuild(int t);
+   uint8_t byte_at(uint32_t pos);
+};
+
+#endif  // _JOURNAL_H_INCLUDED
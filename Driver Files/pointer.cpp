@@ -0,0 +1,131 @@
+/*****************************************************************//**
+ * @file pointer.cpp
+ *
+ * @brief implementation of PointerMotion class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "pointer.h"
+
+PointerMotion::PointerMotion(Ps2Core *ps2_p, int xmax, int ymax) {
+   ps2 = ps2_p;
+   this->xmax = xmax;
+   this->ymax = ymax;
+   set_accel(256, 4, 512);
+   set_xy(xmax / 2, ymax / 2);
+   cur_l = 0;
+   cur_r = 0;
+   last_merged = 0;
+   q_head = 0;
+   q_cnt = 0;
+}
+
+PointerMotion::~PointerMotion() {
+}
+
+void PointerMotion::set_accel(int gain_q8, int thresh, int accel_q8) {
+   gain = gain_q8;
+   this->thresh = thresh;
+   accel = accel_q8;
+}
+
+void PointerMotion::set_xy(int x, int y) {
+   cur_x = x;
+   cur_y = y;
+   frac_x = 0;
+   frac_y = 0;
+}
+
+// accelerated movement in Q8 pixels
+int PointerMotion::scale(int d) {
+   int mag = (d < 0) ? -d : d;
+   int s;
+
+   if (mag <= thresh)
+      s = mag * gain;
+   else
+      s = thresh * gain + (mag - thresh) * accel;
+   return ((d < 0) ? -s : s);
+}
+
+// add Q8 movement to remainder; return whole pixels
+int PointerMotion::step(int *frac, int d) {
+   int pix;
+
+   *frac = *frac + d;
+   pix = *frac / 256;          // truncate toward 0; remainder keeps sign
+   *frac = *frac - pix * 256;
+   return (pix);
+}
+
+int PointerMotion::update() {
+   Ps2MousePacket *p;
+   int sum_x = 0;
+   int sum_y = 0;
+   int n = 0;
+   int old_x = cur_x;
+   int old_y = cur_y;
+   int old_l = cur_l;
+   int old_r = cur_r;
+   int tail;
+
+   /* top up the queue with whatever the ps2 fifo holds */
+   tail = (q_head + q_cnt) % QUEUE_SIZE;
+   if (q_cnt < QUEUE_SIZE) {
+      // fill up to the end of the array; the rest on a later call
+      int room = QUEUE_SIZE - q_cnt;
+      if (room > QUEUE_SIZE - tail)
+         room = QUEUE_SIZE - tail;
+      q_cnt = q_cnt + ps2->poll_mouse(&queue[tail], room);
+   }
+   /* merge packets sharing the button state of the first one */
+   while (q_cnt > 0) {
+      p = &queue[q_head];
+      if (n > 0 && (p->lbtn != cur_l || p->rbtn != cur_r))
+         break;                  // button change: next update
+      cur_l = p->lbtn;
+      cur_r = p->rbtn;
+      sum_x = sum_x + scale(p->xmov);
+      sum_y = sum_y + scale(p->ymov);
+      q_head = (q_head + 1) % QUEUE_SIZE;
+      q_cnt--;
+      n++;
+   }
+   last_merged = n;
+   if (n == 0)
+      return (0);
+   /* mouse y is positive upward; screen y grows downward */
+   cur_x = cur_x + step(&frac_x, sum_x);
+   cur_y = cur_y - step(&frac_y, sum_y);
+   if (cur_x < 0)
+      cur_x = 0;
+   if (cur_x > xmax)
+      cur_x = xmax;
+   if (cur_y < 0)
+      cur_y = 0;
+   if (cur_y > ymax)
+      cur_y = ymax;
+   return (cur_x != old_x || cur_y != old_y || cur_l != old_l
+         || cur_r != old_r);
+}
+
+int PointerMotion::x() {
+   return (cur_x);
+}
+
+int PointerMotion::y() {
+   return (cur_y);
+}
+
+int PointerMotion::lbtn() {
+   return (cur_l);
+}
+
+int PointerMotion::rbtn() {
+   return (cur_r);
+}
+
+int PointerMotion::merged() {
+   return (last_merged);
+}
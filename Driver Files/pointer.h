@@ -0,0 +1,97 @@
+/*****************************************************************//**
+ * @file pointer.h
+ *
+ * @brief Turn PS/2 mouse packets into a cursor position
+ *
+ * Description:
+ *  - uses the full 9-bit x/y movement of each packet
+ *  - acceleration: movement up to a threshold is scaled by a base
+ *    gain; the part above the threshold by an extra gain
+ *    (both gains in Q8, i.e., 256 = 1.0)
+ *  - fractions of a pixel are accumulated, so slow motion is not lost
+ *  - update() merges all queued packets with the same button state
+ *    into one cursor move; a button change starts a new update
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _POINTER_H_INCLUDED
+#define _POINTER_H_INCLUDED
+
+#include "ps2_core.h"
+
+/**
+ * pointer motion (mouse cursor) module
+ *
+ */
+class PointerMotion {
+public:
+   /**
+    * packet queue size
+    *
+    */
+   enum {
+      QUEUE_SIZE = 16
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param ps2_p pointer to ps2 core instance (mouse)
+    * @note cursor limited to 0..xmax / 0..ymax; starts at the center
+    *
+    */
+   PointerMotion(Ps2Core *ps2_p, int xmax, int ymax);
+   ~PointerMotion();                  // not used
+
+   /**
+    * set the acceleration curve
+    * @param gain_q8 gain for movement up to thresh (Q8)
+    * @param thresh threshold in mouse counts per packet
+    * @param accel_q8 gain for movement above thresh (Q8)
+    * @note default: 1.0, 4, 2.0
+    *
+    */
+   void set_accel(int gain_q8, int thresh, int accel_q8);
+
+   /**
+    * move the cursor to a position (clears sub-pixel remainders)
+    *
+    */
+   void set_xy(int x, int y);
+
+   /**
+    * process queued mouse packets
+    * @return 1: cursor moved or buttons changed; 0: nothing new
+    * @note never waits for the mouse
+    *
+    */
+   int update();
+
+   /* current state */
+   int x();
+   int y();
+   int lbtn();
+   int rbtn();
+
+   /**
+    * # packets merged by the last update()
+    *
+    */
+   int merged();
+
+private:
+   Ps2Core *ps2;
+   int xmax, ymax;
+   int gain, thresh, accel;
+   int cur_x, cur_y;
+   int frac_x, frac_y;         // sub-pixel remainders (Q8)
+   int cur_l, cur_r;
+   int last_merged;
+   Ps2MousePacket queue[QUEUE_SIZE];
+   int q_head, q_cnt;
+   int scale(int d);
+   int step(int *frac, int d);
+};
+
+#endif  // _POINTER_H_INCLUDED
@@ -12,6 +12,8 @@
 
 Ps2Core::Ps2Core(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   pkt_len = 0;
+   sync_err = 0;
 }
 
 Ps2Core::~Ps2Core() {
@@ -68,6 +70,8 @@ int Ps2Core::init() {
    while (!rx_fifo_empty()) {
       rx_byte();
    }
+   pkt_len = 0;
+   sync_err = 0;
    /* send reset 0xff  */
    debug("ps2 reset: write command ", 0, 0);
    tx_byte(0xff);
@@ -98,38 +102,65 @@ int Ps2Core::init() {
    return (2);  //success
 }
 
-int Ps2Core::get_mouse_activity(int *lbtn, int *rbtn, int *xmov,
-      int *ymov) {
-   uint8_t b1, b2, b3;
-
+void Ps2Core::decode_mouse(Ps2MousePacket *pkt) {
+   uint8_t b1 = pkt_buf[0];
    uint32_t tmp;
 
-   /* check and retrieve 1st byte */
-   if (rx_fifo_empty())
-      return (0);                         // no data in rx fifo buffer
-   b1 = rx_byte();
-   /* wait and retrieve 2nd byte */
-   while (rx_fifo_empty())
-      ;
-   b2 = rx_byte();
-   /* wait and retrieve 3rd byte */
-   while (rx_fifo_empty())
-      ;
-   b3 = rx_byte();
    /* extract button info */
-   *lbtn = (int) (b1 & 0x01);      // extract bit 0
-   *rbtn = (int) (b1 & 0x02) >> 1; // extract bit 1
+   pkt->lbtn = (int) (b1 & 0x01);      // extract bit 0
+   pkt->rbtn = (int) (b1 & 0x02) >> 1; // extract bit 1
    /* extract x movement; manually convert 9-bit 2's comp to int */
-   tmp = (uint32_t) b2;
+   tmp = (uint32_t) pkt_buf[1];
    if (b1 & 0x10)                // check MSB (sign bit) of x movement
       tmp = tmp | 0xffffff00;    // manual sign-extension if negative
-   *xmov = (int) tmp;            // data conversion
+   pkt->xmov = (int) tmp;        // data conversion
    /* extract y movement; manually convert 9-bit 2's comp to int */
-   tmp = (uint32_t) b3;
+   tmp = (uint32_t) pkt_buf[2];
    if (b1 & 0x20)                // check MSB (sign bit) of y movement
-      tmp = tmp | 0xffffff00;     // manual sign-extension if negative
-   *ymov = (int) tmp;            // data conversion
-   /* success */
+      tmp = tmp | 0xffffff00;    // manual sign-extension if negative
+   pkt->ymov = (int) tmp;        // data conversion
+}
+
+int Ps2Core::poll_mouse(Ps2MousePacket *pkts, int max) {
+   uint32_t rd_word;
+   uint8_t b;
+   int n = 0;
+
+   while (n < max) {
+      /* one read returns both empty flag and data */
+      rd_word = io_read(base_addr, RD_DATA_REG);
+      if (rd_word & RX_EMPT_FIELD)
+         break;                  // fifo drained; keep partial packet
+      io_write(base_addr, RM_RD_DATA_REG, 0);
+      b = (uint8_t) (rd_word & RX_DATA_FIELD);
+      if (pkt_len == 0 && !(b & 0x08)) {
+         sync_err++;             // not a header byte; re-synchronize
+         continue;
+      }
+      pkt_buf[pkt_len++] = b;
+      if (pkt_len == 3) {
+         decode_mouse(&pkts[n]);
+         n++;
+         pkt_len = 0;
+      }
+   }
+   return (n);
+}
+
+uint32_t Ps2Core::mouse_sync_errors() {
+   return (sync_err);
+}
+
+int Ps2Core::get_mouse_activity(int *lbtn, int *rbtn, int *xmov,
+      int *ymov) {
+   Ps2MousePacket pkt;
+
+   if (poll_mouse(&pkt, 1) == 0)
+      return (0);                // no complete packet yet
+   *lbtn = pkt.lbtn;
+   *rbtn = pkt.rbtn;
+   *xmov = pkt.xmov;
+   *ymov = pkt.ymov;
    return (1);
 }
 
@@ -20,8 +20,24 @@
  *  - get mouse movement/button activities
  *  - get keyboard char
  *
+ * mouse packets are decoded incrementally:
+ *  - poll_mouse() consumes only the bytes already in the rx fifo and
+ *    keeps a partial packet until the next call (never busy-waits)
+ *  - a byte with bit 3 cleared cannot start a packet; it is dropped
+ *    to re-synchronize after a lost byte
+ *
  */
 
+/**
+ * decoded 3-byte mouse packet
+ */
+struct Ps2MousePacket {
+   int lbtn;   /**< 1 when left button pressed */
+   int rbtn;   /**< 1 when right button pressed */
+   int xmov;   /**< x-axis movement */
+   int ymov;   /**< y-axis movement (positive is up) */
+};
+
 
 class Ps2Core {
 public:
@@ -109,9 +125,28 @@ public:
     * @return xmov return x-axis movement;
     * @return ymov return y-axis movement;
     *
+    * @note does not wait; returns 0 until a whole packet has arrived
     */
    int get_mouse_activity(int *lbtn, int *rbtn, int *xmov, int *ymov);
 
+   /**
+    * decode mouse packets from the bytes in the rx fifo
+    *
+    * @param pkts array to store decoded packets
+    * @param max size of pkts
+    * @return # packets decoded (0 to max)
+    *
+    * @note returns without waiting; a packet split across calls is
+    *       completed on a later call
+    */
+   int poll_mouse(Ps2MousePacket *pkts, int max);
+
+   /**
+    * # bytes dropped to re-synchronize the packet stream since init()
+    *
+    */
+   uint32_t mouse_sync_errors();
+
 
    /**
     * get keyboard activity
@@ -126,6 +161,10 @@ public:
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
+   uint8_t pkt_buf[3];   // partial mouse packet
+   int pkt_len;          // # bytes in pkt_buf
+   uint32_t sync_err;
+   void decode_mouse(Ps2MousePacket *pkt);
 };
 
 #endif  // _PS2_H_INCLUDED
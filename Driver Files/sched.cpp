@@ -0,0 +1,115 @@
+/*****************************************************************//**
+ * @file sched.cpp
+ *
+ * @brief implementation of Scheduler class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "sched.h"
+
+Scheduler::Scheduler() {
+   n_task = 0;
+   passes = 0;
+}
+
+Scheduler::~Scheduler() {
+}
+
+int Scheduler::add(const char *name, TaskFunc func, uint32_t period_us) {
+   Task *t;
+
+   if (n_task == MAX_TASK)
+      return (-1);
+   t = &task[n_task];
+   t->name = name;
+   t->func = func;
+   t->period = period_us;
+   t->next = now_us() + period_us;
+   t->runs = 0;
+   t->max_us = 0;
+   t->total_us = 0;
+   t->late_us = 0;
+   return (n_task++);
+}
+
+// call a task and account its run time
+void Scheduler::exec(Task *t) {
+   unsigned long start, dt;
+
+   start = now_us();
+   t->func();
+   dt = now_us() - start;
+   t->runs++;
+   t->total_us = t->total_us + dt;
+   if (dt > t->max_us)
+      t->max_us = dt;
+}
+
+void Scheduler::run() {
+   unsigned long now;
+   long late, worst;
+   Task *t, *due;
+
+   passes++;
+   for (int i = 0; i < n_task; i++) {
+      if (task[i].period == 0)
+         exec(&task[i]);
+   }
+   /* pick the most overdue periodic task */
+   now = now_us();
+   due = 0;
+   worst = -1;
+   for (int i = 0; i < n_task; i++) {
+      t = &task[i];
+      if (t->period == 0)
+         continue;
+      late = (long) (now - t->next);      // wrap-around safe
+      if (late > worst) {
+         worst = late;
+         due = t;
+      }
+   }
+   if (!due || worst < 0)
+      return;
+   if ((uint32_t) worst > due->late_us)
+      due->late_us = (uint32_t) worst;
+   due->next = due->next + due->period;
+   if ((long) (now - due->next) >= 0)
+      due->next = now + due->period;      // fell behind; skip missed periods
+   exec(due);
+}
+
+void Scheduler::dump() {
+   Task *t;
+
+   uart.disp("scheduler: ");
+   uart.disp((int) passes);
+   uart.disp(" passes\n\r");
+   for (int i = 0; i < n_task; i++) {
+      t = &task[i];
+      uart.disp("  ");
+      uart.disp(t->name);
+      uart.disp(" period=");
+      uart.disp((int) t->period);
+      uart.disp(" runs=");
+      uart.disp((int) t->runs);
+      uart.disp(" mean=");
+      uart.disp(t->runs ? (int) (t->total_us / t->runs) : 0);
+      uart.disp(" max=");
+      uart.disp((int) t->max_us);
+      uart.disp(" late=");
+      uart.disp((int) t->late_us);
+      uart.disp(" us\n\r");
+   }
+}
+
+void Scheduler::clear_stat() {
+   passes = 0;
+   for (int i = 0; i < n_task; i++) {
+      task[i].runs = 0;
+      task[i].max_us = 0;
+      task[i].total_us = 0;
+      task[i].late_us = 0;
+   }
+}
@@ -0,0 +1,91 @@
+/*****************************************************************//**
+ * @file sched.h
+ *
+ * @brief Cooperative (run-to-completion) task scheduler
+ *
+ * Description:
+ *  - a task is a function called by the main loop; it must return
+ *    quickly and keep its state outside the call
+ *  - period 0: task runs on every pass (e.g., mouse input)
+ *  - period > 0: task runs when its period (in us) has elapsed;
+ *    at most one periodic task runs per pass (the most overdue),
+ *    so the latency of every-pass tasks is bounded by the longest
+ *    single periodic task, not by the sum of all of them
+ *  - missed periods are skipped, not queued
+ *  - run time and lateness of every task are accounted (now_us())
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _SCHED_H_INCLUDED
+#define _SCHED_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * task scheduler
+ *
+ */
+class Scheduler {
+public:
+   /**
+    * size of task table
+    *
+    */
+   enum {
+      MAX_TASK = 8
+   };
+
+   typedef void (*TaskFunc)();
+
+   /* methods */
+   Scheduler();
+   ~Scheduler();                  // not used
+
+   /**
+    * register a task
+    * @param name task name (string literal)
+    * @param func task function
+    * @param period_us period in microsecond; 0 for every pass
+    * @return task number; -1 if table full
+    *
+    */
+   int add(const char *name, TaskFunc func, uint32_t period_us);
+
+   /**
+    * run one pass: all every-pass tasks plus at most one due
+    * periodic task
+    *
+    */
+   void run();
+
+   /**
+    * print per-task run count, run time and lateness on the uart
+    *
+    */
+   void dump();
+
+   /**
+    * reset run-time statistics
+    *
+    */
+   void clear_stat();
+
+private:
+   struct Task {
+      const char *name;
+      TaskFunc func;
+      uint32_t period;      // us; 0: every pass
+      unsigned long next;   // due time (us)
+      uint32_t runs;
+      uint32_t max_us;      // longest run
+      uint64_t total_us;
+      uint32_t late_us;     // worst start delay past due time
+   };
+   Task task[MAX_TASK];
+   int n_task;
+   uint32_t passes;
+   void exec(Task *t);
+};
+
+#endif  // _SCHED_H_INCLUDED
@@ -0,0 +1,105 @@
+/*****************************************************************//**
+ * @file shake.cpp
+ *
+ * @brief implementation of ShakeDetector class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "shake.h"
+
+ShakeDetector::ShakeDetector(int rate_hz) {
+   rate = rate_hz;
+   set_params(800, 300, 4, 1000, 1000);
+}
+
+ShakeDetector::~ShakeDetector() {
+}
+
+void ShakeDetector::set_params(int peak_mg, int energy_mg, int n_peak, int window_ms, int quiet_ms) {
+   peak_th = peak_mg;
+   energy_th = energy_mg * WIN;
+   if (n_peak < 2)
+      n_peak = 2;
+   if (n_peak > MAX_PEAK)
+      n_peak = MAX_PEAK;
+   n_need = n_peak;
+   win_n = (uint32_t) window_ms * rate / 1000;
+   quiet_n = (uint32_t) quiet_ms * rate / 1000;
+   reset();
+}
+
+void ShakeDetector::reset() {
+   for (int k = 0; k < WIN; k++)
+      e_ring[k] = 0;
+   e_sum = 0;
+   for (int a = 0; a < 3; a++)
+      dir[a] = 0;
+   n_peak = 0;
+   p_head = 0;
+   n_samp = 0;
+   quiet_until = 0;
+   primed = 0;
+}
+
+int ShakeDetector::feed(int x, int y, int z) {
+   int v[3] = {x, y, z};
+   int hp[3];
+   int e, a, s, peak, oldest;
+   uint32_t t;
+
+   t = n_samp++;
+   if (!primed) {
+      // start from the first reading, not from 0 g
+      for (a = 0; a < 3; a++)
+         mean[a] = (int32_t) v[a] * (1 << FRAC_BITS);
+      primed = 1;
+   }
+   e = 0;
+   for (a = 0; a < 3; a++) {
+      mean[a] = mean[a] + ((((int32_t) v[a] * (1 << FRAC_BITS)) - mean[a]) >> HP_SHIFT);
+      hp[a] = v[a] - (int) (mean[a] >> FRAC_BITS);
+      e = e + ((hp[a] < 0) ? -hp[a] : hp[a]);
+   }
+   e_sum = e_sum - e_ring[t % WIN] + e;
+   e_ring[t % WIN] = e;
+   if (t < quiet_until || e_sum < energy_th)
+      return (0);
+   peak = 0;
+   for (a = 0; a < 3; a++) {
+      s = (hp[a] > peak_th) ? 1 : (hp[a] < -peak_th) ? -1 : 0;
+      if (s != 0 && s != dir[a]) {
+         dir[a] = s;
+         peak = 1;
+      }
+   }
+   if (!peak)
+      return (0);
+   t_peak[p_head] = t;
+   p_head = (p_head + 1) % MAX_PEAK;
+   if (n_peak < MAX_PEAK)
+      n_peak++;
+   if (n_peak < n_need)
+      return (0);
+   oldest = (p_head + MAX_PEAK - n_need) % MAX_PEAK;
+   if (t - t_peak[oldest] > win_n)
+      return (0);
+   // shake: start over after the quiet time
+   n_peak = 0;
+   for (a = 0; a < 3; a++)
+      dir[a] = 0;
+   quiet_until = t + quiet_n;
+   return (1);
+}
+
+int ShakeDetector::energy() {
+   return (e_sum / WIN);
+}
+
+int ShakeDetector::peaks() {
+   return (n_peak);
+}
+
+uint32_t ShakeDetector::samples() {
+   return (n_samp);
+}
@@ -0,0 +1,103 @@
+/*****************************************************************//**
+ * @file shake.h
+ *
+ * @brief Shake gesture detection on an accelerometer sample stream
+ *
+ * Description:
+ *  - integer only; fed one x/y/z sample (mg) at a time, so the
+ *    sensor can be polled slowly and its fifo replayed in a batch
+ *  - high-pass filter per axis: the mean tracks the input with a
+ *    1/16 step (cutoff about 1 Hz at 100 Hz), kept in Q4; gravity
+ *    and slow tilting are removed
+ *  - energy: sum of |x| + |y| + |z| of the filtered signal over the
+ *    last 8 samples
+ *  - peak: an axis beyond the peak threshold in the opposite direction
+ *    of its last peak, while the energy average is above the energy
+ *    threshold (at most one per sample)
+ *  - shake: n peaks within the window; then no peaks are counted for
+ *    the quiet time
+ *  - defaults: 800 mg peaks, 300 mg energy, 4 peaks in 1000 ms,
+ *    1000 ms quiet; a single spike or a tilt stays below them
+ *  - Host Files/shake_replay.cpp runs the detector over a recorded
+ *    trace
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _SHAKE_H_INCLUDED
+#define _SHAKE_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * shake detector module
+ *
+ */
+class ShakeDetector {
+public:
+   /**
+    * filter constants
+    *
+    */
+   enum {
+      HP_SHIFT = 4,      /**< mean step 1/2^HP_SHIFT */
+      FRAC_BITS = 4,     /**< fraction bits of the mean */
+      WIN = 8,           /**< energy window (samples) */
+      MAX_PEAK = 8       /**< most peaks per shake */
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param rate_hz sample rate
+    *
+    */
+   ShakeDetector(int rate_hz);
+   ~ShakeDetector();                  // not used
+
+   /**
+    * set thresholds and timing
+    * @param peak_mg peak threshold of a filtered axis
+    * @param energy_mg energy threshold (average per sample)
+    * @param n_peak peaks for a shake (2 to MAX_PEAK)
+    * @param window_ms time span of the n peaks
+    * @param quiet_ms time without peaks after a shake
+    *
+    */
+   void set_params(int peak_mg, int energy_mg, int n_peak, int window_ms, int quiet_ms);
+
+   /**
+    * restart (the next sample primes the filters)
+    *
+    */
+   void reset();
+
+   /**
+    * process a sample
+    * @param x/y/z acceleration in mg
+    * @return 1: a shake ends at this sample; 0: otherwise
+    *
+    */
+   int feed(int x, int y, int z);
+
+   /* current state */
+   int energy();          // average of the energy window (mg)
+   int peaks();           // peaks counted toward a shake
+   uint32_t samples();    // samples since reset
+
+private:
+   int rate;
+   int peak_th, energy_th, n_need;
+   uint32_t win_n, quiet_n;      // window and quiet time in samples
+   int32_t mean[3];              // Q(FRAC_BITS)
+   int dir[3];                   // sign of the last peak per axis
+   int e_ring[WIN];
+   int e_sum;
+   uint32_t t_peak[MAX_PEAK];    // sample # of recent peaks
+   int n_peak, p_head;
+   uint32_t n_samp;
+   uint32_t quiet_until;
+   int primed;
+};
+
+#endif  // _SHAKE_H_INCLUDED
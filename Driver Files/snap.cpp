@@ -0,0 +1,304 @@
+/*****************************************************************//**
+ * @file snap.cpp
+ *
+ * @brief implementation of CanvasSnap class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "snap.h"
+
+enum {
+   RUN_SHIFT = 9,
+   RUN_MAX = 128,
+   PIX_FIELD = 0x1ff
+};
+
+CanvasSnap::CanvasSnap(FrameCore *frame_p) {
+   frame = frame_p;
+   set_canvas(0, 0, FrameCore::HMAX, FrameCore::VMAX);
+   n_words = 0;
+   n_tiles = 0;
+   cap_us = 0;
+   res_us = 0;
+}
+
+CanvasSnap::~CanvasSnap() {
+}
+
+void CanvasSnap::set_canvas(int x, int y, int w, int h) {
+   int ny;
+
+   nx = (w + TILE_W - 1) / TILE_W;
+   ny = (h + TILE_H - 1) / TILE_H;
+   if (nx > MAX_TILE)
+      nx = MAX_TILE;
+   if (nx * ny > MAX_TILE) {
+      // cover as many whole tile rows as fit
+      ny = MAX_TILE / nx;
+      h = ny * TILE_H;
+   }
+   if (w > nx * TILE_W)
+      w = nx * TILE_W;
+   cv_x = x;
+   cv_y = y;
+   cv_w = w;
+   cv_h = h;
+   n_tile = nx * ny;
+   for (int s = 0; s < N_SLOT; s++) {
+      valid[s] = 0;
+      built[s] = 0;
+   }
+   newest = -1;
+   top = 0;
+}
+
+void CanvasSnap::tile_rect(int i, int *x, int *y, int *w, int *h) {
+   *x = cv_x + (i % nx) * TILE_W;
+   *y = cv_y + (i / nx) * TILE_H;
+   *w = cv_x + cv_w - *x;
+   if (*w > TILE_W)
+      *w = TILE_W;
+   *h = cv_y + cv_h - *y;
+   if (*h > TILE_H)
+      *h = TILE_H;
+}
+
+/*
+ * run-length code tile i at the top of the pool
+ *  - compacts the pool and retries once if it runs out
+ *  - return 0 if the tile does not fit
+ */
+int CanvasSnap::encode(int s, int i) {
+   uint16_t buf[TILE_W];
+   uint16_t cur = 0;
+   int x, y, w, h, row, k, p, run;
+
+   tile_rect(i, &x, &y, &w, &h);
+   for (int pass = 0; pass < 2; pass++) {
+      p = top;
+      run = 0;
+      for (row = 0; row < h && p >= 0; row++) {
+         frame->rd_span(x, y + row, w, buf);
+         for (k = 0; k < w; k++) {
+            if (run > 0 && buf[k] == cur && run < RUN_MAX) {
+               run++;
+               continue;
+            }
+            if (run > 0) {
+               if (p == POOL_WORDS) {
+                  p = -1;        // out of room
+                  break;
+               }
+               pool[p++] = cur | ((run - 1) << RUN_SHIFT);
+            }
+            cur = buf[k];
+            run = 1;
+         }
+      }
+      if (p >= 0 && p < POOL_WORDS) {
+         pool[p++] = cur | ((run - 1) << RUN_SHIFT);
+         off[s][i] = (uint16_t) top;
+         len[s][i] = (uint16_t) (p - top);
+         n_words = n_words + (p - top);
+         n_tiles++;
+         top = p;
+         return (1);
+      }
+      compact();
+   }
+   return (0);
+}
+
+// move the blobs still referenced to the bottom of the pool
+void CanvasSnap::compact() {
+   int n, i, j, e, prev_old, prev_new;
+   uint16_t *o, *l;
+
+   o = &off[0][0];
+   l = &len[0][0];
+   n = 0;
+   for (int s = 0; s < N_SLOT; s++)
+      for (i = 0; i < built[s]; i++)
+         order[n++] = (uint16_t) (s * MAX_TILE + i);
+   // sort by offset (insertion sort; blobs mostly in order already)
+   for (i = 1; i < n; i++) {
+      e = order[i];
+      for (j = i; j > 0 && o[order[j - 1]] > o[e]; j--)
+         order[j] = order[j - 1];
+      order[j] = (uint16_t) e;
+   }
+   // slide down in address order; a shared blob moves once
+   top = 0;
+   prev_old = -1;
+   prev_new = 0;
+   for (i = 0; i < n; i++) {
+      e = order[i];
+      if (o[e] == prev_old) {
+         o[e] = (uint16_t) prev_new;
+         continue;
+      }
+      prev_old = o[e];
+      for (j = 0; j < l[e]; j++)
+         pool[top + j] = pool[o[e] + j];
+      o[e] = (uint16_t) top;
+      prev_new = top;
+      top = top + l[e];
+   }
+}
+
+int CanvasSnap::capture(uint32_t tag) {
+   unsigned long t0;
+   int s, ref, x, y, w, h;
+
+   t0 = now_us();
+   ref = newest;
+   s = (ref < 0) ? 0 : (ref + 1) % N_SLOT;   // replace the older one
+   valid[s] = 0;
+   built[s] = 0;
+   n_words = 0;
+   n_tiles = 0;
+   for (int i = 0; i < n_tile; i++) {
+      tile_rect(i, &x, &y, &w, &h);
+      if (ref >= 0 && !frame->dirty(x, y, w, h)) {
+         // unchanged since the latest checkpoint: share its blob
+         off[s][i] = off[ref][i];
+         len[s][i] = len[ref][i];
+      } else if (!encode(s, i)) {
+         built[s] = 0;
+         cap_us = now_us() - t0;
+         return (0);
+      }
+      built[s] = i + 1;
+   }
+   valid[s] = 1;
+   tags[s] = tag;
+   newest = s;
+   frame->clear_dirty();
+   cap_us = now_us() - t0;
+   return (1);
+}
+
+int CanvasSnap::find(uint32_t lo, uint32_t hi) {
+   int best = -1;
+
+   for (int s = 0; s < N_SLOT; s++) {
+      if (!valid[s] || tags[s] - lo > hi - lo)
+         continue;
+      if (best < 0 || tags[s] - lo > tags[best] - lo)
+         best = s;
+   }
+   return (best);
+}
+
+uint32_t CanvasSnap::tag(int slot) {
+   return (tags[slot]);
+}
+
+void CanvasSnap::keep(uint32_t lo, uint32_t hi) {
+   for (int s = 0; s < N_SLOT; s++) {
+      if (valid[s] && tags[s] - lo > hi - lo) {
+         valid[s] = 0;
+         built[s] = 0;
+         if (s == newest)
+            newest = -1;         // dirty bits no longer tell what changed
+      }
+   }
+}
+
+void CanvasSnap::restore(int slot) {
+   unsigned long t0;
+   uint16_t *p;
+   int x, y, w, h, n, k, col, row, run, seg, same;
+
+   t0 = now_us();
+   n_tiles = 0;
+   for (int i = 0; i < n_tile; i++) {
+      tile_rect(i, &x, &y, &w, &h);
+      // tiles that may differ from the checkpoint
+      if (newest >= 0 && !frame->dirty(x, y, w, h)
+            && (slot == newest || off[slot][i] == off[newest][i]))
+         continue;
+      p = &pool[off[slot][i]];
+      n = len[slot][i];
+      n_tiles++;
+      same = 1;
+      for (k = 1; k < n && same; k++)
+         same = ((p[k] & PIX_FIELD) == (p[0] & PIX_FIELD));
+      if (same) {
+         frame->fillRect(x, y, w, h, FrameCore::unpack9(p[0] & PIX_FIELD));
+         continue;
+      }
+      col = 0;
+      row = 0;
+      for (k = 0; k < n; k++) {
+         run = (p[k] >> RUN_SHIFT) + 1;
+         while (run > 0) {
+            seg = (run < w - col) ? run : w - col;
+            frame->wr_span(x + col, y + row, seg, FrameCore::unpack9(p[k] & PIX_FIELD));
+            col = col + seg;
+            run = run - seg;
+            if (col == w) {
+               col = 0;
+               row++;
+            }
+         }
+      }
+   }
+   res_us = now_us() - t0;
+}
+
+int CanvasSnap::words_used() {
+   int n = 0;
+   int shared;
+
+   for (int s = 0; s < N_SLOT; s++) {
+      if (!valid[s])
+         continue;
+      for (int i = 0; i < n_tile; i++) {
+         shared = 0;
+         for (int t = 0; t < s; t++)
+            if (valid[t] && off[t][i] == off[s][i])
+               shared = 1;
+         if (!shared)
+            n = n + len[s][i];
+      }
+   }
+   return (n);
+}
+
+int CanvasSnap::last_words() {
+   return (n_words);
+}
+
+int CanvasSnap::last_tiles() {
+   return (n_tiles);
+}
+
+uint32_t CanvasSnap::capture_us() {
+   return (cap_us);
+}
+
+uint32_t CanvasSnap::restore_us() {
+   return (res_us);
+}
+
+void CanvasSnap::dump() {
+   int n = 0;
+
+   for (int s = 0; s < N_SLOT; s++)
+      n = n + valid[s];
+   uart.disp("snap: ");
+   uart.disp(n);
+   uart.disp(" checkpoints, ");
+   uart.disp(words_used() * 2);
+   uart.disp("/");
+   uart.disp((int) POOL_WORDS * 2);
+   uart.disp(" bytes, last capture ");
+   uart.disp(n_words * 2);
+   uart.disp(" bytes ");
+   uart.disp((int) cap_us);
+   uart.disp(" us, last restore ");
+   uart.disp((int) res_us);
+   uart.disp(" us\n\r");
+}
@@ -0,0 +1,141 @@
+/*****************************************************************//**
+ * @file snap.h
+ *
+ * @brief Compressed checkpoints of the canvas for fast undo
+ *
+ * Description:
+ *  - the canvas is split into 40-by-20 tiles; each checkpoint holds
+ *    every tile as a run-length coded blob in a shared word pool
+ *  - run word: bits 8..0 packed 9-bit pixel, bits 15..9 run length - 1;
+ *    runs continue across the rows of a tile, so a blank tile is
+ *    7 words
+ *  - pixels are read back with FrameCore::rd_span(); tiles known to
+ *    be uniform are not read over the bus
+ *  - copy-on-write: a new checkpoint encodes only the tiles written
+ *    since the last one (FrameCore dirty bits) and shares the blobs
+ *    of the others
+ *  - restore writes back only the tiles that may differ from the
+ *    checkpoint
+ *  - two checkpoints are kept; a new one replaces the older
+ *  - when the pool is full, it is compacted; if it is still full, the
+ *    checkpoint is not taken
+ *  - each checkpoint carries a tag (e.g., a journal position)
+ *
+ * @note FrameCore::clear_dirty() belongs to this module
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _SNAP_H_INCLUDED
+#define _SNAP_H_INCLUDED
+
+#include "vga_core.h"
+
+/**
+ * canvas checkpoint module
+ *
+ */
+class CanvasSnap {
+public:
+   /**
+    * tile geometry and memory budget
+    *
+    */
+   enum {
+      TILE_W = 40,
+      TILE_H = 20,
+      MAX_TILE = 192,     /**< e.g., 11 x 17 tiles of a 440 x 340 canvas */
+      N_SLOT = 2,         /**< checkpoints kept */
+      POOL_WORDS = 6144   /**< run words shared by the checkpoints */
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param frame_p pointer to frame buffer instance
+    * @note canvas defaults to the largest area of MAX_TILE tiles at 0, 0
+    *
+    */
+   CanvasSnap(FrameCore *frame_p);
+   ~CanvasSnap();                  // not used
+
+   /**
+    * set the canvas rectangle (drops all checkpoints)
+    * @param x top left x coordinate
+    * @param y top left y coordinate
+    * @param w width
+    * @param h height
+    * @note area beyond MAX_TILE tiles is not covered
+    *
+    */
+   void set_canvas(int x, int y, int w, int h);
+
+   /**
+    * take a checkpoint of the canvas
+    * @param tag value kept with the checkpoint
+    * @return 1: taken; 0: pool full (no checkpoint)
+    *
+    */
+   int capture(uint32_t tag);
+
+   /**
+    * find the latest checkpoint with a tag in a range
+    * @return slot number; -1 if none
+    * @note tags are compared as positions (wrap-around safe, hi - lo
+    *       less than 2^31)
+    *
+    */
+   int find(uint32_t lo, uint32_t hi);
+
+   /**
+    * tag of a checkpoint
+    *
+    */
+   uint32_t tag(int slot);
+
+   /**
+    * restore the canvas from a checkpoint
+    *
+    */
+   void restore(int slot);
+
+   /**
+    * drop checkpoints with a tag out of a range
+    *
+    */
+   void keep(uint32_t lo, uint32_t hi);
+
+   /* statistics */
+   int words_used();         // live run words in the pool
+   int last_words();         // run words encoded by the last capture
+   int last_tiles();         // tiles encoded/restored by the last capture/restore
+   uint32_t capture_us();    // duration of the last capture
+   uint32_t restore_us();    // duration of the last restore
+
+   /**
+    * print pool use and timing on the uart
+    *
+    */
+   void dump();
+
+private:
+   FrameCore *frame;
+   int cv_x, cv_y, cv_w, cv_h;
+   int nx, n_tile;               // tiles per row, tiles in use
+   uint16_t pool[POOL_WORDS];
+   int top;                      // first free word
+   uint16_t off[N_SLOT][MAX_TILE];
+   uint16_t len[N_SLOT][MAX_TILE];
+   uint8_t valid[N_SLOT];
+   int built[N_SLOT];            // tiles of the slot with a blob
+   uint32_t tags[N_SLOT];
+   int newest;                   // slot of the latest checkpoint; -1 none
+   uint16_t order[N_SLOT * MAX_TILE];  // compaction scratch
+   int n_words, n_tiles;
+   uint32_t cap_us, res_us;
+   void tile_rect(int i, int *x, int *y, int *w, int *h);
+   int encode(int s, int i);
+   void compact();
+};
+
+#endif  // _SNAP_H_INCLUDED
@@ -0,0 +1,89 @@
+/*****************************************************************//**
+ * @file spectrum.cpp
+ *
+ * @brief implementation of Spectrum class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "spectrum.h"
+
+enum {
+   OFF = 0,
+   FULL = 1,
+   UP = 2,
+   DOWN = 3,
+   ONE_Q16 = 0x10000
+};
+
+/*
+ * sector table
+ *  - level of the blue, green and red channel (pwm channel order)
+ *  - the fading channel of sectors 2 and 4 is switched off from a
+ *    reading of 0.33/0.66 on (as the original program did)
+ */
+static const struct {
+   uint8_t level[3];
+   int16_t cut_from;
+   int8_t cut_ch;
+} SECTOR[6] = {
+   {{OFF, UP, FULL}, 4096, 0},
+   {{OFF, FULL, DOWN}, 1352, Spectrum::RED_CH},
+   {{UP, FULL, OFF}, 4096, 0},
+   {{FULL, DOWN, OFF}, 2704, Spectrum::GREEN_CH},
+   {{FULL, OFF, UP}, 4096, 0},
+   {{DOWN, OFF, FULL}, 4096, 0}
+};
+
+Spectrum::Spectrum(PwmCore *pwm_p) {
+   pwm = pwm_p;
+}
+
+Spectrum::~Spectrum() {
+}
+
+uint16_t Spectrum::map(int raw, int duty[3]) {
+   uint32_t hue, frac, v;
+   uint16_t color = 0;
+   int k, ch;
+
+   raw = raw & 0xfff;
+   hue = 6 * (uint32_t) raw;                // sector . position in Q12
+   k = hue >> 12;
+   frac = (hue & 0xfff) << 4;               // Q16
+   if (k > 0 && frac == 0) {
+      k--;                                  // sector edge: end of the lower one
+      frac = ONE_Q16;
+   }
+   for (ch = 0; ch < 3; ch++) {
+      switch (SECTOR[k].level[ch]) {
+      case FULL:
+         v = ONE_Q16;
+         break;
+      case UP:
+         v = frac;
+         break;
+      case DOWN:
+         v = ONE_Q16 - frac;
+         break;
+      default:
+         v = 0;
+         break;
+      }
+      duty[ch] = (int) ((v * PwmCore::MAX) >> 16);
+      color = color | (uint16_t) (((v * 15) >> 16) << (4 * ch));
+   }
+   if (raw >= SECTOR[k].cut_from)
+      duty[SECTOR[k].cut_ch] = 0;
+   return (color);
+}
+
+uint16_t Spectrum::set(int raw) {
+   int duty[3];
+   uint16_t color;
+
+   color = map(raw, duty);
+   for (int ch = 0; ch < 3; ch++)
+      pwm->set_duty(duty[ch], ch);
+   return (color);
+}
@@ -0,0 +1,73 @@
+/*****************************************************************//**
+ * @file spectrum.h
+ *
+ * @brief Map a 12-bit potentiometer reading to a hue (integer only)
+ *
+ * Description:
+ *  - the reading sweeps six sectors: red -> yellow -> green -> cyan
+ *    -> blue -> magenta -> red; in each, one channel ramps up or
+ *    down while the others are full or off
+ *  - hue = 6 * reading: sector # in the integer part, position in
+ *    the sector as a Q16 fraction; a 6-entry sector table gives each
+ *    channel's level (off, full, ramp up, ramp down)
+ *  - a level in Q16 (0 to 1.0) scales to a pwm duty cycle and to a
+ *    4-bit brush color channel with one multiply and shift each
+ *  - results match the floating-point spectrum()/map_rgb() of the
+ *    original program for all 4096 readings (colors exactly, duties
+ *    within 1 LSB), including its early cut of the fading channel in
+ *    sectors 2 and 4
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _SPECTRUM_H_INCLUDED
+#define _SPECTRUM_H_INCLUDED
+
+#include "gpio_cores.h"
+
+/**
+ * potentiometer-to-spectrum module
+ *
+ */
+class Spectrum {
+public:
+   /**
+    * pwm channels of the rgb led
+    *
+    */
+   enum {
+      BLUE_CH = 0,
+      GREEN_CH = 1,
+      RED_CH = 2
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param pwm_p pointer to pwm core instance (rgb led)
+    *
+    */
+   Spectrum(PwmCore *pwm_p);
+   ~Spectrum();                  // not used
+
+   /**
+    * map a reading to a color
+    * @param raw 12-bit xadc reading (0 to 4095)
+    * @param duty pwm duty cycles (0 to PwmCore::MAX), indexed by channel
+    * @return 12-bit brush color (4-4-4 rgb)
+    *
+    */
+   uint16_t map(int raw, int duty[3]);
+
+   /**
+    * map a reading and drive the rgb led
+    * @return 12-bit brush color
+    *
+    */
+   uint16_t set(int raw);
+
+private:
+   PwmCore *pwm;
+};
+
+#endif  // _SPECTRUM_H_INCLUDED
@@ -16,6 +16,7 @@ SpiCore::SpiCore(uint32_t core_base_addr) {
    set_mode(0, 0);
    //write_ctrl_reg();
    write_ss_n(0xffffffff);  // de-assert all ss_n signals
+   fifo = -1;               // probed on first use
 }
 SpiCore::~SpiCore() {
 }
@@ -81,3 +82,65 @@ uint8_t SpiCore::transfer(uint8_t wr_data) {
    return ((uint8_t) rd_data);
 }
 
+
+int SpiCore::has_fifo() {
+   // a core without fifos returns the read data register at every address
+   if (fifo < 0)
+      fifo = ((io_read(base_addr, FIFO_REG) & FIFO_SIG_FIELD) == FIFO_SIG) ? 1 : 0;
+   return (fifo);
+}
+
+/* block transfer without fifos: wait and read data in one access per poll */
+static void block_poll(uint32_t base_addr, const uint8_t *tx, uint8_t *rx, int n) {
+   uint32_t rd_data;
+
+   for (int k = 0; k < n; k++) {
+      io_write(base_addr, SpiCore::WRITE_DATA_REG, tx ? tx[k] : 0);
+      do {
+         rd_data = io_read(base_addr, SpiCore::RD_DATA_REG);
+      } while (!(rd_data & SpiCore::READY_FIELD));
+      if (rx)
+         rx[k] = (uint8_t) rd_data;
+   }
+}
+
+void SpiCore::transfer_block(const uint8_t *tx, uint8_t *rx, int n,
+                             const uint8_t *prefix, int n_prefix) {
+   uint32_t st;
+   int total, sent, got, room, k;
+   uint8_t b;
+
+   while (!ready()) {
+   };
+   if (!has_fifo()) {
+      block_poll(base_addr, prefix, 0, n_prefix);
+      block_poll(base_addr, tx, rx, n);
+      return;
+   }
+   // prefix and data as one stream; at most FIFO_DEPTH bytes in flight,
+   // so the rx fifo never overflows
+   total = n_prefix + n;
+   sent = 0;
+   got = 0;
+   room = 0;
+   while (got < total) {
+      while (sent < total && room > 0 && sent - got < (int) FIFO_DEPTH) {
+         if (sent < n_prefix)
+            b = prefix[sent];
+         else
+            b = tx ? tx[sent - n_prefix] : 0;
+         io_write(base_addr, QUEUE_REG, b);
+         sent++;
+         room--;
+      }
+      st = io_read(base_addr, FIFO_REG);
+      room = (st & TX_FREE_FIELD) >> 8;
+      if (st & RX_CNT_FIELD) {
+         k = got - n_prefix;
+         if (rx && k >= 0)
+            rx[k] = (uint8_t) st;
+         io_write(base_addr, FIFO_REG, 0);   // pop
+         got++;
+      }
+   }
+}
@@ -32,12 +32,20 @@ public:
     *   bit  17: cpha;
     *   bits 27-24: ss3, ..., ss0
     *
+    * fifo status register (read; a write pops the rx fifo):
+    *   bits 31-24: signature 0x5f (0 on a core without fifos);
+    *   bits 20-16: rx fifo entries;
+    *   bits 12-8: free tx fifo entries;
+    *   bits 7-0: rx fifo head
+    *
     */
    enum {
       RD_DATA_REG = 0,    /**< 8-bit read data register */
       SS_REG = 1,         /**< 1-bit status register */
       WRITE_DATA_REG = 2, /**< 8-bit write data register */
-      CTRL_REG = 3        /**< control register (ss/cpha/cpol/dvsr) */
+      CTRL_REG = 3,       /**< control register (ss/cpha/cpol/dvsr) */
+      FIFO_REG = 4,       /**< fifo status / rx fifo pop */
+      QUEUE_REG = 5       /**< 8-bit write data queued in the tx fifo */
    };
    /**
     * Field masks
@@ -45,7 +53,12 @@ public:
     */
    enum {
       READY_FIELD = 0x00000100, /**< bit 8 of rd_data_reg; ready bit */
-      RX_DATA_FIELD = 0x000000ff /**< bits 7..0 rd_data_reg; read data */
+      RX_DATA_FIELD = 0x000000ff, /**< bits 7..0 rd_data_reg; read data */
+      FIFO_SIG_FIELD = 0xff000000, /**< bits 31..24 fifo_reg; signature */
+      FIFO_SIG = 0x5f000000,
+      RX_CNT_FIELD = 0x001f0000,   /**< bits 20..16 fifo_reg; rx entries */
+      TX_FREE_FIELD = 0x00001f00,  /**< bits 12..8 fifo_reg; free tx entries */
+      FIFO_DEPTH = 16
    };
    /**
     * Constructor.
@@ -127,6 +140,33 @@ public:
     */
    uint8_t transfer(uint8_t wr_data);
 
+   /**
+    * transfer a block of bytes
+    *
+    *@param tx write data (0: send 0x00 bytes)
+    *@param rx read data (0: discard)
+    *@param n # bytes
+    *@param prefix bytes sent first, e.g., command and register address
+    *       (read data discarded)
+    *@param n_prefix # prefix bytes
+    *
+    *@note ss_n is not changed; assert it around the call as with transfer()
+    *@note with the core fifos, bytes go out back to back while the
+    *      driver collects the read data; otherwise each byte is started
+    *      as soon as the previous one ends, one status poll per wait
+    *
+    */
+   void transfer_block(const uint8_t *tx, uint8_t *rx, int n,
+                       const uint8_t *prefix = 0, int n_prefix = 0);
+
+   /**
+    * the core has tx/rx fifos
+    *
+    * @return 1: yes; 0: no (transfer_block() falls back to polling)
+    * @note probed on first use
+    */
+   int has_fifo();
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
@@ -134,6 +174,7 @@ private:
    uint16_t dvsr;
    int cpol;
    int cpha;
+   int fifo;       // -1: not probed; 0: absent; 1: present
 }
 ;
 
@@ -0,0 +1,72 @@
+/*****************************************************************//**
+ * @file stroke.cpp
+ *
+ * @brief implementation of Stroke class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "stroke.h"
+
+Stroke::Stroke(FrameCore *frame_p) {
+   frame = frame_p;
+   pen_down = 0;
+   last_x = 0;
+   last_y = 0;
+   last_r = -1;
+   last_color = -1;
+   last_seg = 0;
+   clear_stat();
+}
+
+Stroke::~Stroke() {
+}
+
+int Stroke::draw(int x, int y, int r, int color) {
+   int cont;
+
+   if (!pen_down) {
+      // new stroke: degenerate capsule is a single disc
+      last_x = x;
+      last_y = y;
+      pen_down = 1;
+      cont = 0;
+   } else {
+      // the previous segment ended with this disc unless the brush changed
+      cont = (r == last_r && color == last_color);
+   }
+   last_seg = frame->fill_capsule(last_x, last_y, x, y, r, color, cont);
+   last_x = x;
+   last_y = y;
+   last_r = r;
+   last_color = color;
+   pix_cnt = pix_cnt + last_seg;
+   seg_cnt++;
+   debug("stroke: segment pixels / total ", last_seg, (int) pix_cnt);
+   return (last_seg);
+}
+
+void Stroke::lift() {
+   pen_down = 0;
+}
+
+int Stroke::down() {
+   return (pen_down);
+}
+
+int Stroke::seg_pixels() {
+   return (last_seg);
+}
+
+uint32_t Stroke::total_pixels() {
+   return (pix_cnt);
+}
+
+uint32_t Stroke::segments() {
+   return (seg_cnt);
+}
+
+void Stroke::clear_stat() {
+   pix_cnt = 0;
+   seg_cnt = 0;
+}
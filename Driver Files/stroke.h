@@ -0,0 +1,98 @@
+/*****************************************************************//**
+ * @file stroke.h
+ *
+ * @brief Join successive brush positions into continuous strokes
+ *
+ * Description:
+ *  - sits between the mouse (cursor positions) and FrameCore
+ *  - first sample of a stroke stamps a disc
+ *  - each later sample rasterizes the capsule swept from the previous
+ *    position, less the disc there that the previous segment wrote
+ *    (same radius and color), so fast strokes leave no gaps and slow
+ *    strokes write only the pixels the brush newly covers
+ *  - pixel counts are kept to check the overdraw on a host build
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _STROKE_H_INCLUDED
+#define _STROKE_H_INCLUDED
+
+#include "vga_core.h"
+
+/**
+ * brush stroke engine
+ *
+ */
+class Stroke {
+public:
+   /* methods */
+   /**
+    * constructor.
+    * @param frame_p pointer to frame buffer instance
+    *
+    */
+   Stroke(FrameCore *frame_p);
+   ~Stroke();                  // not used
+
+   /**
+    * extend the current stroke to a new brush position
+    * @param x x-coordinate of brush center
+    * @param y y-coordinate of brush center
+    * @param r brush radius
+    * @param color brush color
+    * @return # pixels written for this segment
+    *
+    * @note starts a new stroke (a single disc) if the pen is up
+    *
+    */
+   int draw(int x, int y, int r, int color);
+
+   /**
+    * end the current stroke (pen up)
+    *
+    */
+   void lift();
+
+   /**
+    * check whether a stroke is in progress
+    * @return 1: pen down; 0: pen up
+    *
+    */
+   int down();
+
+   /**
+    * # pixels written by the last segment
+    *
+    */
+   int seg_pixels();
+
+   /**
+    * # pixels written since the last clear_stat()
+    *
+    */
+   uint32_t total_pixels();
+
+   /**
+    * # segments drawn since the last clear_stat()
+    *
+    */
+   uint32_t segments();
+
+   /**
+    * reset pixel/segment statistics
+    *
+    */
+   void clear_stat();
+
+private:
+   FrameCore *frame;
+   int pen_down;
+   int last_x, last_y;
+   int last_r, last_color;
+   int last_seg;
+   uint32_t pix_cnt;
+   uint32_t seg_cnt;
+};
+
+#endif  // _STROKE_H_INCLUDED
@@ -41,10 +41,15 @@ void TimerCore::clear() {
 }
 
 uint64_t TimerCore::read_tick() {
-   uint64_t upper, lower;
+   uint64_t upper, lower, check;
 
-   lower = (uint64_t) io_read(base_addr, COUNTER_LOWER_REG);
+   // re-read if the lower word wrapped between the two reads
    upper = (uint64_t) io_read(base_addr, COUNTER_UPPER_REG);
+   do {
+      check = upper;
+      lower = (uint64_t) io_read(base_addr, COUNTER_LOWER_REG);
+      upper = (uint64_t) io_read(base_addr, COUNTER_UPPER_REG);
+   } while (upper != check);
    return ((upper << 32) | lower);
 }
 
@@ -0,0 +1,156 @@
+/*****************************************************************//**
+ * @file trace.cpp
+ *
+ * @brief implementation of trace-point timing
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "chu_init.h"
+#include "trace.h"
+#include <string.h>
+
+enum {
+   N_LABEL = 16,     // max # labels
+   N_OPEN = 8,       // max nesting depth
+   TRACE_DEPTH = 32  // ring buffer size
+};
+
+// per-label statistics
+static struct {
+   const char *label;
+   uint32_t cnt;
+   uint32_t min;
+   uint32_t max;
+   uint64_t sum;
+} stat[N_LABEL];
+static int n_label = 0;
+
+// open sections
+static struct {
+   int id;
+   uint64_t start;
+} open_sec[N_OPEN];
+static int depth = 0;
+
+// ring buffer of completed sections
+static struct {
+   uint8_t id;
+   uint8_t level;
+   uint64_t start;    // start tick
+   uint32_t ticks;
+} ring[TRACE_DEPTH];
+static int ring_head = 0;
+static int ring_cnt = 0;
+
+static int label_id(const char *label) {
+   for (int i = 0; i < n_label; i++) {
+      if (stat[i].label == label || strcmp(stat[i].label, label) == 0)
+         return (i);
+   }
+   if (n_label == N_LABEL)
+      return (-1);
+   stat[n_label].label = label;
+   stat[n_label].min = 0xffffffff;
+   return (n_label++);
+}
+
+int trace_begin(const char *label) {
+   int id;
+
+   id = label_id(label);
+   if (id < 0 || depth == N_OPEN)
+      return (-1);
+   open_sec[depth].id = id;
+   open_sec[depth].start = now_tick();   // last: exclude the overhead above
+   return (depth++);
+}
+
+void trace_end(int marker) {
+   uint64_t now = now_tick();
+   uint32_t ticks;
+   int id;
+
+   if (marker < 0 || marker != depth - 1)
+      return;        // not timed or ended out of order
+   depth--;
+   id = open_sec[marker].id;
+   ticks = (uint32_t) (now - open_sec[marker].start);
+   stat[id].cnt++;
+   stat[id].sum = stat[id].sum + ticks;
+   if (ticks < stat[id].min)
+      stat[id].min = ticks;
+   if (ticks > stat[id].max)
+      stat[id].max = ticks;
+   ring[ring_head].id = (uint8_t) id;
+   ring[ring_head].level = (uint8_t) marker;
+   ring[ring_head].start = open_sec[marker].start;
+   ring[ring_head].ticks = ticks;
+   ring_head = (ring_head + 1) % TRACE_DEPTH;
+   if (ring_cnt < TRACE_DEPTH)
+      ring_cnt++;
+}
+
+void trace_clear() {
+   for (int i = 0; i < n_label; i++) {
+      stat[i].cnt = 0;
+      stat[i].min = 0xffffffff;
+      stat[i].max = 0;
+      stat[i].sum = 0;
+   }
+   ring_cnt = 0;
+   ring_head = 0;
+}
+
+// print a tick count followed by its value in microseconds
+static void disp_ticks(uint32_t ticks) {
+   uart.disp((int) ticks);
+   uart.disp(" (");
+   uart.disp((int) (ticks / SYS_CLK_FREQ));
+   uart.disp(" us)");
+}
+
+void trace_dump() {
+   int m, i;
+   uint64_t t0, t1, first;
+
+   // timer read cost included in each record
+   t0 = now_tick();
+   t1 = now_tick();
+   uart.disp("trace (ticks @ ");
+   uart.disp(SYS_CLK_FREQ);
+   uart.disp(" MHz, overhead ");
+   uart.disp((int) (t1 - t0));
+   uart.disp("):\n\r");
+   for (i = 0; i < n_label; i++) {
+      if (stat[i].cnt == 0)
+         continue;
+      uart.disp("  ");
+      uart.disp(stat[i].label);
+      uart.disp(" n=");
+      uart.disp((int) stat[i].cnt);
+      uart.disp(" min=");
+      disp_ticks(stat[i].min);
+      uart.disp(" max=");
+      disp_ticks(stat[i].max);
+      uart.disp(" mean=");
+      disp_ticks((uint32_t) (stat[i].sum / stat[i].cnt));
+      uart.disp("\n\r");
+   }
+   uart.disp("last ");
+   uart.disp(ring_cnt);
+   uart.disp(" sections (start in us after the first / ticks):\n\r");
+   first = ring[(ring_head - ring_cnt + TRACE_DEPTH) % TRACE_DEPTH].start;
+   for (i = 0; i < ring_cnt; i++) {
+      m = (ring_head - ring_cnt + i + TRACE_DEPTH) % TRACE_DEPTH;
+      uart.disp("  ");
+      for (int l = 0; l < ring[m].level; l++)
+         uart.disp("  ");
+      uart.disp(stat[ring[m].id].label);
+      uart.disp(" ");
+      uart.disp((int) ((ring[m].start - first) / SYS_CLK_FREQ));   // from 64-bit ticks: no wrap
+      uart.disp(" / ");
+      uart.disp((int) ring[m].ticks);
+      uart.disp("\n\r");
+   }
+}
@@ -0,0 +1,71 @@
+/*****************************************************************//**
+ * @file trace.h
+ *
+ * @brief Time code sections with the system timer
+ *
+ * Description:
+ *  - trace_begin()/trace_end() bracket a section; the elapsed time
+ *    (in system clock ticks) is recorded under a label
+ *  - per label: # calls, min, max, mean
+ *  - the last TRACE_DEPTH records are kept in a ring buffer
+ *  - trace_dump() prints statistics and records on the uart console
+ *  - TRACE_SCOPE(label) times the enclosing block; it expands to
+ *    nothing unless _TRACE is defined
+ *  - timing comes from _sys_timer (now_tick()), so a host build
+ *    measures virtual time of the host timer model
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TRACE_H_INCLUDED
+#define _TRACE_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * start timing a section
+ * @param label section name (string literal); at most 16 labels
+ * @return marker to be passed to trace_end()
+ * @note sections may nest up to 8 deep; deeper ones are not timed
+ */
+int trace_begin(const char *label);
+
+/**
+ * stop timing a section and record it
+ * @param marker value returned by trace_begin()
+ */
+void trace_end(int marker);
+
+/**
+ * reset statistics and ring buffer (labels are kept)
+ */
+void trace_clear();
+
+/**
+ * print per-label statistics and the ring buffer on the uart console
+ */
+void trace_dump();
+
+/**
+ * time the enclosing block
+ */
+class TraceScope {
+public:
+   TraceScope(const char *label) {
+      marker = trace_begin(label);
+   }
+   ~TraceScope() {
+      trace_end(marker);
+   }
+private:
+   int marker;
+};
+
+// time a block; no code is generated unless _TRACE is defined
+#ifdef _TRACE
+#define TRACE_SCOPE(label) TraceScope _trace_scope(label)
+#else
+#define TRACE_SCOPE(label)
+#endif
+
+#endif  // _TRACE_H_INCLUDED
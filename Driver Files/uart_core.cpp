@@ -12,6 +12,10 @@
 UartCore::UartCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
    set_baud_rate(9600);      //default baud rate
+   policy = TX_DIRECT;
+   tx_head = 0;
+   tx_cnt = 0;
+   tx_clear_stat();
 }
 
 UartCore::~UartCore() {
@@ -43,10 +47,78 @@ int UartCore::tx_fifo_full() {
    return (full);
 }
 
+int UartCore::tx_fifo_empty() {
+   uint32_t rd_word;
+   int empty;
+
+   rd_word = io_read(base_addr, RD_DATA_REG);
+   empty = (int) (rd_word & TX_EMPT_FIELD) >> 10;
+   return (empty);
+}
+
 void UartCore::tx_byte(uint8_t byte) {
-   while (tx_fifo_full()) {
-   };  // busy waiting
-   io_write(base_addr, WR_DATA_REG, (uint32_t )byte);
+   if (policy == TX_DIRECT) {
+      while (tx_fifo_full()) {
+      };  // busy waiting
+      io_write(base_addr, WR_DATA_REG, (uint32_t )byte);
+      return;
+   }
+   if (tx_cnt == TX_BUF_SIZE) {
+      pump();
+      while (policy == TX_WAIT && tx_cnt == TX_BUF_SIZE)
+         pump();
+      if (tx_cnt == TX_BUF_SIZE) {
+         drop_cnt++;
+         return;
+      }
+   }
+   tx_buf[(tx_head + tx_cnt) % TX_BUF_SIZE] = byte;
+   tx_cnt++;
+   if (tx_cnt > peak)
+      peak = tx_cnt;
+}
+
+int UartCore::tx_policy(int policy) {
+   int old = this->policy;
+
+   if (policy == TX_DIRECT)
+      flush();                   // keep the byte order
+   this->policy = policy;
+   return (old);
+}
+
+int UartCore::pump() {
+   int n = 0;
+
+   while (tx_cnt > 0 && !tx_fifo_full()) {
+      io_write(base_addr, WR_DATA_REG, (uint32_t) tx_buf[tx_head]);
+      tx_head = (tx_head + 1) % TX_BUF_SIZE;
+      tx_cnt--;
+      n++;
+   }
+   return (n);
+}
+
+void UartCore::flush() {
+   while (tx_cnt > 0)
+      pump();
+}
+
+int UartCore::tx_pending() {
+   return (tx_cnt);
+}
+
+int UartCore::tx_peak() {
+   return (peak);
+}
+
+uint32_t UartCore::tx_dropped() {
+   return (drop_cnt);
+}
+
+void UartCore::tx_clear_stat() {
+   peak = tx_cnt;
+   drop_cnt = 0;
 }
 
 int UartCore::rx_byte() {
@@ -154,6 +226,19 @@ void UartCore::disp(double f) {
 }
 
 void UartCore::disp_str(const char *str) {
+   int len;
+
+   if (policy == TX_DROP) {
+      // drop a whole string rather than its tail
+      for (len = 0; str[len]; len++)
+         ;
+      if (len > TX_BUF_SIZE - tx_cnt)
+         pump();
+      if (len > TX_BUF_SIZE - tx_cnt) {
+         drop_cnt = drop_cnt + len;
+         return;
+      }
+   }
    while ((uint8_t) *str) {
       tx_byte(*str);
       str++;
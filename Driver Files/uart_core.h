@@ -17,6 +17,9 @@
  * uart core driver
  * - transmit/receive data via MMIO uart core.
  * - display (print) number and string on serial console
+ * - optional software transmit buffer: tx_byte() queues the byte and
+ *   pump(), called from the main loop, moves queued bytes into the
+ *   hardware fifo while it has room
  *
  */
 class UartCore {
@@ -35,16 +38,35 @@ class UartCore {
    *
    */
    enum {
+      TX_EMPT_FIELD = 0x00000400, /**< bit 10 of rd_data_reg; tx empty (idle) bit */
       TX_FULL_FIELD = 0x00000200, /**< bit 9 of rd_data_reg; full bit  */
       RX_EMPT_FIELD = 0x00000100, /**< bit 10 of rd_data_reg; empty bit */
       RX_DATA_FIELD = 0x000000ff  /**< bits 7..0 rd_data_reg; read data */
    };
 public:
+   /**
+    * transmit buffer
+    *
+    */
+   enum {
+      TX_BUF_SIZE = 512
+   };
+   /**
+    * transmit policy
+    *
+    */
+   enum {
+      TX_DIRECT = 0,  /**< no buffer: tx_byte() waits for room in the fifo */
+      TX_WAIT = 1,    /**< buffered; tx_byte() pumps while the buffer is full */
+      TX_DROP = 2     /**< buffered; a string (or byte) that does not fit is dropped */
+   };
+
    /* methods */
    /**
     * constructor.
     *
     * @note set the default rate to 9600 baud
+    * @note policy TX_DIRECT
     */
    UartCore(uint32_t core_base_addr);
    ~UartCore();
@@ -73,6 +95,16 @@ public:
     */
    int tx_fifo_full();
 
+   /**
+    * check whether uart transmitter fifo is empty
+    *
+    * @return 1: if empty; 0: otherwise
+    *
+    * @note a byte leaves the fifo after its stop bit: empty means
+    *       the line is idle and the baud rate can be changed
+    */
+   int tx_fifo_empty();
+
    /**
     * transmit a byte
     *
@@ -80,9 +112,42 @@ public:
     *
     * @note the function "busy waits" if tx fifo is full;
     *       to avoid "blocking" execution, use tx_fifo_full() to check status as needed
+    * @note with a buffered policy, the byte is queued (see tx_policy())
     */
    void tx_byte(uint8_t byte);
 
+   /**
+    * select the transmit policy
+    *
+    * @param policy TX_DIRECT, TX_WAIT or TX_DROP
+    * @return previous policy
+    *
+    * @note switching to TX_DIRECT first sends the queued bytes
+    */
+   int tx_policy(int policy);
+
+   /**
+    * move queued bytes into the tx fifo while it is not full
+    *
+    * @return # bytes moved
+    *
+    * @note never waits; call it on every pass of the main loop
+    */
+   int pump();
+
+   /**
+    * pump until the transmit buffer is empty
+    *
+    * @note bytes may still be in the hardware fifo on return
+    */
+   void flush();
+
+   /* transmit buffer statistics */
+   int tx_pending();         // bytes queued
+   int tx_peak();            // most bytes queued at once
+   uint32_t tx_dropped();    // bytes dropped (TX_DROP)
+   void tx_clear_stat();
+
    /**
     * receive a byte
     *
@@ -168,6 +233,11 @@ public:
 private:
    uint32_t base_addr;
    int baud_rate;
+   int policy;
+   uint8_t tx_buf[TX_BUF_SIZE];
+   int tx_head, tx_cnt;
+   int peak;
+   uint32_t drop_cnt;
    void disp_str(const char *str);
 };
 
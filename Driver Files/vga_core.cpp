@@ -103,6 +103,18 @@ void OsdCore::bypass(int by) {
  *********************************************************************/
 FrameCore::FrameCore(uint32_t frame_base_addr) {
    base_addr = frame_base_addr;
+   brush_ready = 0;
+   dither = 0;
+   blit_state = -1;
+   blit_pending = 0;
+   span_hw = 0;
+   span_credit = 0;
+   span_color = TILE_MIXED;      // not a pixel value: first span sets it
+   // frame content unknown at power-up
+   for (int i = 0; i < TILE_ROWS * TILE_COLS; i++) {
+      tile[i] = TILE_MIXED;
+      mark(&tile[i]);
+   }
 }
 FrameCore::~FrameCore() {
 }
@@ -116,31 +128,420 @@ FrameCore::~FrameCore() {
   }
 #endif
 void FrameCore::wr_pix(int x, int y, int color) {
-   uint32_t pix_offset;
+   put_pix(x, y, pack9(color));
+}
+
+void FrameCore::clr_screen(int color) {
+   fill_color(0, 0, HMAX, VMAX, color);
+}
+
+void FrameCore::wr_span(int x, int y, int w, int color) {
+   put_span(x, y, w, pack9(color));
+}
+
+void FrameCore::wr_vspan(int x, int y, int h, int color) {
+   put_vspan(x, y, h, pack9(color));
+}
+
+uint16_t FrameCore::rd_pix(int x, int y) {
+   uint16_t t;
+
+   if (x < 0 || x >= HMAX || y < 0 || y >= VMAX)
+      return (0);
+   t = tile[(y >> TILE_SHIFT) * TILE_COLS + (x >> TILE_SHIFT)];
+   if (t != TILE_MIXED)
+      return (t);
+   hw_wait();
+   return ((uint16_t) (io_read(base_addr, HMAX * y + x) & 0x1ff));
+}
+
+int FrameCore::rd_span(int x, int y, int w, uint16_t *buf) {
+   uint32_t offset;
+   uint16_t t;
+   int xe, seg, n, i;
+
+   // clip run to the frame
+   if (y < 0 || y >= VMAX)
+      return (0);
+   if (x < 0) {
+      w = w + x;
+      x = 0;
+   }
+   if (x + w > HMAX)
+      w = HMAX - x;
+   if (w <= 0)
+      return (0);
+   // one tile piece at a time; uniform pieces come from the tile table
+   offset = HMAX * y + x;
+   xe = x + w;
+   n = 0;
+   while (x < xe) {
+      seg = TILE_SIZE - (x & (TILE_SIZE - 1));
+      if (seg > xe - x)
+         seg = xe - x;
+      t = tile[(y >> TILE_SHIFT) * TILE_COLS + (x >> TILE_SHIFT)];
+      if (t != TILE_MIXED) {
+         for (i = 0; i < seg; i++)
+            buf[n++] = t;
+      } else {
+         hw_wait();
+         for (i = 0; i < seg; i++)
+            buf[n++] = (uint16_t) (io_read(base_addr, offset + i) & 0x1ff);
+      }
+      offset = offset + seg;
+      x = x + seg;
+   }
+   return (n);
+}
+
+int FrameCore::dirty(int x, int y, int w, int h) {
+   int tx, ty, i;
+
+   if (!clip_rect(&x, &y, &w, &h))
+      return (0);
+   for (ty = y >> TILE_SHIFT; ty <= (y + h - 1) >> TILE_SHIFT; ty++)
+      for (tx = x >> TILE_SHIFT; tx <= (x + w - 1) >> TILE_SHIFT; tx++) {
+         i = ty * TILE_COLS + tx;
+         if (dirty_map[i >> 5] & (1UL << (i & 31)))
+            return (1);
+      }
+   return (0);
+}
+
+void FrameCore::clear_dirty() {
+   for (int i = 0; i < (TILE_ROWS * TILE_COLS + 31) / 32; i++)
+      dirty_map[i] = 0;
+}
+
+// record a write to a tile
+void FrameCore::mark(uint16_t *t) {
+   int i = t - tile;
+
+   dirty_map[i >> 5] |= 1UL << (i & 31);
+}
 
+void FrameCore::set_dither(int on) {
+   dither = on;
+}
+
+// put_ helpers and fill_block take a packed 9-bit pixel value
+void FrameCore::put_pix(int x, int y, uint16_t pix) {
+   uint32_t pix_offset;
+   uint16_t *t;
+
+   if (x < 0 || x >= HMAX || y < 0 || y >= VMAX)
+      return;
+   t = &tile[(y >> TILE_SHIFT) * TILE_COLS + (x >> TILE_SHIFT)];
+   if (*t == pix)
+      return;                    // pixel already has this color
+   *t = TILE_MIXED;
+   mark(t);
+   hw_wait();
    pix_offset = HMAX * y + x;
-   io_write(base_addr, pix_offset, color);
+   io_write(base_addr, pix_offset, pix);
    return;
 }
 
-void FrameCore::clr_screen(int color) {
-   int x, y;
+void FrameCore::put_span(int x, int y, int w, uint16_t pix) {
+   uint32_t offset, end, run_offset;
+   uint16_t *t;
+   int xe, seg, run;
 
-   for (x = 0; x < HMAX; x++)
-      for (y = 0; y < VMAX; y++) {
-         wr_pix(x, y, color);
+   // clip run to the frame
+   if (y < 0 || y >= VMAX)
+      return;
+   if (x < 0) {
+      w = w + x;
+      x = 0;
+   }
+   if (x + w > HMAX)
+      w = HMAX - x;
+   if (w <= 0)
+      return;
+   if (!has_span())
+      hw_wait();
+   // consecutive addresses within a row, one tile piece at a time
+   t = &tile[(y >> TILE_SHIFT) * TILE_COLS + (x >> TILE_SHIFT)];
+   offset = HMAX * y + x;
+   xe = x + w;
+   run = 0;                      // pieces joined into one span command
+   run_offset = 0;
+   while (x < xe) {
+      seg = TILE_SIZE - (x & (TILE_SIZE - 1));   // up to the tile edge
+      if (seg > xe - x)
+         seg = xe - x;
+      if (*t != pix) {
+         *t = TILE_MIXED;
+         mark(t);
+         if (span_hw) {
+            if (run == 0)
+               run_offset = offset;
+            run = run + seg;
+            offset = offset + seg;
+         } else {
+            for (end = offset + seg; offset < end; offset++)
+               io_write(base_addr, offset, pix);
+         }
+      } else {
+         if (run > 0) {
+            span_cmd(run_offset, run, pix);
+            run = 0;
+         }
+         offset = offset + seg;  // piece already has this color
+      }
+      x = x + seg;
+      t++;
+   }
+   if (run > 0)
+      span_cmd(run_offset, run, pix);
+}
+
+// queue a span in the hardware fifo; wait only when no entry is known free
+void FrameCore::span_cmd(uint32_t offset, int len, uint16_t pix) {
+   if (pix != span_color) {
+      io_write(base_addr, SPAN_COLOR_REG, pix);   // taken into each command
+      span_color = pix;
+   }
+   while (span_credit == 0)
+      span_credit = (io_read(base_addr, BLIT_CTRL_REG) & BLIT_FREE_FIELD) >> 8;
+   io_write(base_addr, SPAN_CMD_REG, ((uint32_t) len << SPAN_LEN_SHIFT) | offset);
+   span_credit--;
+   blit_pending = 1;
+}
+
+void FrameCore::put_vspan(int x, int y, int h, uint16_t pix) {
+   uint32_t offset, end;
+   uint16_t *t;
+   int ye, seg;
+
+   // clip run to the frame
+   if (x < 0 || x >= HMAX)
+      return;
+   if (y < 0) {
+      h = h + y;
+      y = 0;
+   }
+   if (y + h > VMAX)
+      h = VMAX - y;
+   if (h <= 0)
+      return;
+   hw_wait();
+   // one row (HMAX words) apart, one tile piece at a time
+   t = &tile[(y >> TILE_SHIFT) * TILE_COLS + (x >> TILE_SHIFT)];
+   offset = HMAX * y + x;
+   ye = y + h;
+   while (y < ye) {
+      seg = TILE_SIZE - (y & (TILE_SIZE - 1));
+      if (seg > ye - y)
+         seg = ye - y;
+      if (*t != pix) {
+         *t = TILE_MIXED;
+         mark(t);
+         for (end = offset + HMAX * seg; offset < end; offset += HMAX)
+            io_write(base_addr, offset, pix);
+      } else {
+         offset = offset + HMAX * seg;
+      }
+      y = y + seg;
+      t = t + TILE_COLS;
+   }
+}
+
+// fill a rectangle row by row; fully covered tiles become uniform
+void FrameCore::fill_block(int x, int y, int w, int h, uint16_t pix) {
+   int row;
+
+   if (!clip_rect(&x, &y, &w, &h))
+      return;
+   if (w * h < BLIT_MIN_AREA || !blit_rect(x, y, w, h, pix)) {
+      for (row = y; row < y + h; row++)
+         put_span(x, row, w, pix);
+   }
+#ifndef _NO_TILE_TRACK
+   // tiles completely inside the rectangle now hold only this color
+   int tx, ty, tx0, tx1, ty0, ty1;
+
+   tx0 = (x + TILE_SIZE - 1) >> TILE_SHIFT;
+   tx1 = (x + w) >> TILE_SHIFT;
+   ty0 = (y + TILE_SIZE - 1) >> TILE_SHIFT;
+   ty1 = (y + h) >> TILE_SHIFT;
+   for (ty = ty0; ty < ty1; ty++)
+      for (tx = tx0; tx < tx1; tx++)
+         tile[ty * TILE_COLS + tx] = pix;
+#endif
+}
+
+// fill a rectangle with a 12-bit color; ordered dithering when enabled
+void FrameCore::fill_color(int x, int y, int w, int h, int color) {
+   if (dither)
+      fill_dither(x, y, w, h, color);
+   else
+      fill_block(x, y, w, h, pack9(color));
+}
+
+/*
+ * 2-by-2 ordered dithering of the 4-to-3 bit channel reduction
+ *  - frame_palette_9 expands a 3-bit channel a to 4 bits as {a, a[2]}
+ *  - a 4-bit level v lies between expansions of DITHER_LO[v] and
+ *    DITHER_LO[v]+1; DITHER_Q[v] is its position in quarters
+ *  - a pixel takes the upper level when its Bayer threshold < DITHER_Q[v]
+ */
+void FrameCore::fill_dither(int x, int y, int w, int h, int color) {
+   static const uint8_t DITHER_LO[16] = {0, 0, 1, 1, 2, 2, 3, 3, 3, 4, 4, 5, 5, 6, 6, 7};
+   static const uint8_t DITHER_Q[16]  = {0, 2, 0, 2, 0, 2, 0, 1, 3, 0, 2, 0, 2, 0, 2, 0};
+   static const uint8_t BAYER[2][2] = {{0, 2}, {3, 1}};
+   uint16_t cell[2][2];
+   uint32_t offset, end;
+   int i, j, ch, v, a, row, tx, ty;
+
+   // packed value of each cell of the 2-by-2 pattern
+   for (j = 0; j < 2; j++)
+      for (i = 0; i < 2; i++) {
+         cell[j][i] = 0;
+         for (ch = 2; ch >= 0; ch--) {
+            v = (color >> (4 * ch)) & 0x0f;
+            a = DITHER_LO[v] + ((BAYER[j][i] < DITHER_Q[v]) ? 1 : 0);
+            cell[j][i] = cell[j][i] | (a << (3 * ch));
+         }
+      }
+   if (cell[0][0] == cell[0][1] && cell[0][0] == cell[1][0]) {
+      fill_block(x, y, w, h, cell[0][0]);   // color is exact in 9 bits
+      return;
+   }
+   if (!clip_rect(&x, &y, &w, &h))
+      return;
+   hw_wait();
+   for (row = y; row < y + h; row++) {
+      offset = HMAX * row + x;
+      end = offset + w;
+      for (i = x; offset < end; offset++, i++)
+         io_write(base_addr, offset, cell[row & 1][i & 1]);
+   }
+   // pattern is not a single color
+   for (ty = y >> TILE_SHIFT; ty <= (y + h - 1) >> TILE_SHIFT; ty++)
+      for (tx = x >> TILE_SHIFT; tx <= (x + w - 1) >> TILE_SHIFT; tx++) {
+         tile[ty * TILE_COLS + tx] = TILE_MIXED;
+         mark(&tile[ty * TILE_COLS + tx]);
       }
-   return;
+}
+
+/*
+ * start the fill engine on a clipped rectangle
+ *  - skipped if every tile touched already holds this color
+ *  - partly covered tiles become mixed; fill_block() marks the
+ *    fully covered ones
+ *  - return 0 if there is no engine (caller fills in software)
+ */
+int FrameCore::blit_rect(int x, int y, int w, int h, uint16_t pix) {
+   int tx, ty, tx0, tx1, ty0, ty1, same;
+   uint16_t *t;
+
+   if (!has_blit())
+      return (0);
+   tx0 = x >> TILE_SHIFT;
+   tx1 = (x + w - 1) >> TILE_SHIFT;
+   ty0 = y >> TILE_SHIFT;
+   ty1 = (y + h - 1) >> TILE_SHIFT;
+   same = 1;
+   for (ty = ty0; ty <= ty1; ty++)
+      for (tx = tx0; tx <= tx1; tx++) {
+         t = &tile[ty * TILE_COLS + tx];
+         if (*t != pix) {
+            *t = TILE_MIXED;
+            mark(t);
+            same = 0;
+         }
+      }
+   if (same)
+      return (1);                // area already has this color
+   hw_wait();                    // registers are ignored while busy
+   io_write(base_addr, BLIT_X_REG, x);
+   io_write(base_addr, BLIT_Y_REG, y);
+   io_write(base_addr, BLIT_W_REG, w);
+   io_write(base_addr, BLIT_H_REG, h);
+   io_write(base_addr, BLIT_COLOR_REG, pix);
+   io_write(base_addr, BLIT_CTRL_REG, 1);
+   blit_pending = 1;
+   return (1);
+}
+
+int FrameCore::hw_fill_rect(int x, int y, int w, int h, int color) {
+   fill_block(x, y, w, h, pack9(color));
+   return (has_blit());
+}
+
+int FrameCore::has_blit() {
+   uint32_t st;
+
+   if (blit_state < 0) {
+      st = io_read(base_addr, BLIT_CTRL_REG);
+      blit_state = ((st & BLIT_SIG_FIELD) == BLIT_SIG) ? 1 : 0;
+      span_hw = (blit_state && (st & BLIT_SPAN_FIELD)) ? 1 : 0;
+   }
+   return (blit_state);
+}
+
+int FrameCore::has_span() {
+   has_blit();
+   return (span_hw);
+}
+
+void FrameCore::hw_wait() {
+   if (!blit_pending)
+      return;
+   while (io_read(base_addr, BLIT_CTRL_REG) & BLIT_BUSY_FIELD) {
+   }
+   blit_pending = 0;
+   span_credit = SPAN_FIFO_SIZE;
+}
+
+// clip a rectangle to the frame; return 0 if nothing is left
+int FrameCore::clip_rect(int *x, int *y, int *w, int *h) {
+   if (*x < 0) {
+      *w = *w + *x;
+      *x = 0;
+   }
+   if (*y < 0) {
+      *h = *h + *y;
+      *y = 0;
+   }
+   if (*x + *w > HMAX)
+      *w = HMAX - *x;
+   if (*y + *h > VMAX)
+      *h = VMAX - *y;
+   return (*w > 0 && *h > 0);
 }
 
 void FrameCore::bypass(int by) {
    io_write(base_addr, BYPASS_REG, (uint32_t ) by);
 }
 
+uint32_t FrameCore::frame_count() {
+   return (io_read(base_addr, STATUS_REG) & FRAME_CNT_FIELD);
+}
+
+int FrameCore::in_vblank() {
+   return ((io_read(base_addr, STATUS_REG) & VBLANK_FIELD) ? 1 : 0);
+}
+
+int FrameCore::wait_vblank() {
+   uint32_t start;
+   unsigned long t0;
+
+   start = frame_count();
+   t0 = now_us();
+   while (frame_count() == start) {
+      if (now_us() - t0 > 40000)
+         return (0);
+   }
+   return (1);
+}
+
 // from AdaFruit
 void FrameCore::plot_line(int x0, int y0, int x1, int y1, int color) {
    int dx, dy;
    int err, ystep, steep;
+   uint16_t pix = pack9(color);
 
    if (x0 > x1) {
       swap(x0, x1);
@@ -162,9 +563,9 @@ void FrameCore::plot_line(int x0, int y0, int x1, int y1, int color) {
    }
    for (; x0 <= x1; x0++) {
       if (steep) {
-         wr_pix(y0, x0, color);
+         put_pix(y0, x0, pix);
       } else {
-         wr_pix(x0, y0, color);
+         put_pix(x0, y0, pix);
       }
       err = err - dy;
       if (err < 0) {
@@ -174,6 +575,105 @@ void FrameCore::plot_line(int x0, int y0, int x1, int y1, int color) {
    }
 }
 
+int FrameCore::fill_capsule(int x0, int y0, int x1, int y1, int r, int color, int cont) {
+   const uint8_t *half;
+   uint16_t pix = pack9(color);
+   int ytop, ybot, y, j, hw, l, rt, n;
+   int dx, dy, sx, sy, err, e2;
+   int xs = x0, ys = y0;         // start center
+   int el, er, s, e;
+
+   dx = abs(x1 - x0);
+   sx = (x0 < x1) ? 1 : -1;
+   dy = -abs(y1 - y0);
+   sy = (y0 < y1) ? 1 : -1;
+   err = dx + dy;
+   if (r > BRUSH_R_MAX) {
+      // no span table; stamp a disc at each line point
+      n = 0;
+      while (1) {
+         if (!cont || x0 != xs || y0 != ys)
+            n = n + circle_rows(x0, y0, r, 0, pix);
+         if (x0 == x1 && y0 == y1)
+            break;
+         e2 = 2 * err;
+         if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+         }
+         if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+         }
+      }
+      return (n);
+   }
+   half = brush_spans(r);
+   // rows touched by the capsule, clipped to the frame
+   ytop = ((y0 < y1) ? y0 : y1) - r;
+   ybot = ((y0 > y1) ? y0 : y1) + r;
+   if (ytop < 0)
+      ytop = 0;
+   if (ybot > VMAX - 1)
+      ybot = VMAX - 1;
+   if (ytop > ybot)
+      return (0);
+   for (y = ytop; y <= ybot; y++) {
+      row_l[y] = HMAX;
+      row_r[y] = -1;
+   }
+   // walk the center line; widen each row to cover the disc at every point
+   while (1) {
+      for (j = -r; j <= r; j++) {
+         y = y0 + j;
+         if (y < ytop || y > ybot)
+            continue;
+         hw = half[abs(j)];
+         if (x0 - hw < row_l[y])
+            row_l[y] = x0 - hw;
+         if (x0 + hw > row_r[y])
+            row_r[y] = x0 + hw;
+      }
+      if (x0 == x1 && y0 == y1)
+         break;
+      e2 = 2 * err;
+      if (e2 >= dy) {
+         err += dy;
+         x0 += sx;
+      }
+      if (e2 <= dx) {
+         err += dx;
+         y0 += sy;
+      }
+   }
+   // the capsule is convex: its rows are single runs; when continuing
+   // a stroke, the part el..er of the start disc is cut out of the run
+   n = 0;
+   for (y = ytop; y <= ybot; y++) {
+      l = (row_l[y] < 0) ? 0 : row_l[y];
+      rt = (row_r[y] > HMAX - 1) ? HMAX - 1 : row_r[y];
+      if (rt < l)
+         continue;
+      el = rt + 1;
+      er = rt;
+      if (cont && abs(y - ys) <= r) {
+         el = xs - half[abs(y - ys)];
+         er = xs + half[abs(y - ys)];
+      }
+      e = (rt < el - 1) ? rt : el - 1;   // left of the start disc
+      if (e >= l) {
+         put_span(l, y, e - l + 1, pix);
+         n = n + e - l + 1;
+      }
+      s = (l > er + 1) ? l : er + 1;     // right of the start disc
+      if (s <= rt) {
+         put_span(s, y, rt - s + 1, pix);
+         n = n + rt - s + 1;
+      }
+   }
+   return (n);
+}
+
 void FrameCore::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
 //   startWrite();
   writeFastHLine(x, y, w, color);
@@ -186,9 +686,8 @@ void FrameCore::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t co
 void FrameCore::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
                             uint16_t color) {
 //   startWrite();
-  for (int16_t i = x; i < x + w; i++) {
-    writeFastVLine(i, y, h, color);
-  }
+  // one horizontal span per row instead of one Bresenham line per column
+  fill_color(x, y, w, h, color);
 //   endWrite();
 }
 
@@ -201,12 +700,13 @@ void FrameCore::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
    int16_t ddF_y = -2 * r;
    int16_t x = 0;
    int16_t y = r;
+   uint16_t pix = pack9(color);
 
    // startWrite();
-   wr_pix(x0, y0 + r, color);
-   wr_pix(x0, y0 - r, color);
-   wr_pix(x0 + r, y0, color);
-   wr_pix(x0 - r, y0, color);
+   put_pix(x0, y0 + r, pix);
+   put_pix(x0, y0 - r, pix);
+   put_pix(x0 + r, y0, pix);
+   put_pix(x0 - r, y0, pix);
 
    while (x < y) {
       if (f >= 0) {
@@ -218,23 +718,93 @@ void FrameCore::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
       ddF_x += 2;
       f += ddF_x;
 
-      wr_pix(x0 + x, y0 + y, color);
-      wr_pix(x0 - x, y0 + y, color);
-      wr_pix(x0 + x, y0 - y, color);
-      wr_pix(x0 - x, y0 - y, color);
-      wr_pix(x0 + y, y0 + x, color);
-      wr_pix(x0 - y, y0 + x, color);
-      wr_pix(x0 + y, y0 - x, color);
-      wr_pix(x0 - y, y0 - x, color);
+      put_pix(x0 + x, y0 + y, pix);
+      put_pix(x0 - x, y0 + y, pix);
+      put_pix(x0 + x, y0 - y, pix);
+      put_pix(x0 - x, y0 - y, pix);
+      put_pix(x0 + y, y0 + x, pix);
+      put_pix(x0 - y, y0 + x, pix);
+      put_pix(x0 + y, y0 - x, pix);
+      put_pix(x0 - y, y0 - x, pix);
    }
    // endWrite();
 }
 
 void FrameCore::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
-//   startWrite();
-  writeFastVLine(x0, y0 - r, 2 * r + 1, color);
-  fillCircleHelper(x0, y0, r, 3, 0, color);
-//   endWrite();
+   const uint8_t *half;
+   uint16_t pix = pack9(color);
+   int dy, hw;
+
+   if (r < 0)
+      return;
+   if (r > BRUSH_R_MAX) {
+      circle_rows(x0, y0, r, 0, pix);   // no table; emit rows directly
+      return;
+   }
+   // brush sizes: one span per row from the cached table
+   half = brush_spans(r);
+   put_span(x0 - r, y0, 2 * r + 1, pix);
+   for (dy = 1; dy <= r; dy++) {
+      hw = half[dy];
+      put_span(x0 - hw, y0 - dy, 2 * hw + 1, pix);
+      put_span(x0 - hw, y0 + dy, 2 * hw + 1, pix);
+   }
+}
+
+// row half-widths of a radius-r disc (r <= BRUSH_R_MAX), computed once
+const uint8_t *FrameCore::brush_spans(int r) {
+   if (!(brush_ready & bit(r))) {
+      circle_rows(0, 0, r, brush_tab[r], 0);
+      bit_set(brush_ready, r);
+   }
+   return (brush_tab[r]);
+}
+
+// midpoint algorithm of fillCircleHelper with x and y swapped:
+// every row offset 0..r is produced exactly once
+int FrameCore::circle_rows(int x0, int y0, int r, uint8_t *half, uint16_t pix) {
+   int n;
+   int f = 1 - r;
+   int ddF_x = 1;
+   int ddF_y = -2 * r;
+   int x = 0;
+   int y = r;
+   int px = x;
+   int py = y;
+
+   n = circle_row(x0, y0, 0, r, half, pix);
+   while (x < y) {
+      if (f >= 0) {
+         y--;
+         ddF_y += 2;
+         f += ddF_y;
+      }
+      x++;
+      ddF_x += 2;
+      f += ddF_x;
+      if (x < (y + 1))
+         n = n + circle_row(x0, y0, x, y, half, pix);
+      if (y != py) {
+         n = n + circle_row(x0, y0, py, px, half, pix);
+         py = y;
+      }
+      px = x;
+   }
+   return (n);
+}
+
+// record a row half-width in the table, or write rows y0-dy and y0+dy
+// (return # pixels of the rows, before clipping)
+int FrameCore::circle_row(int x0, int y0, int dy, int hw, uint8_t *half, uint16_t pix) {
+   if (half) {
+      half[dy] = (uint8_t) hw;
+      return (0);
+   }
+   put_span(x0 - hw, y0 - dy, 2 * hw + 1, pix);
+   if (dy == 0)
+      return (2 * hw + 1);
+   put_span(x0 - hw, y0 + dy, 2 * hw + 1, pix);
+   return (4 * hw + 2);
 }
 
 void FrameCore::fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color) {
@@ -288,7 +858,7 @@ void FrameCore::writeFastHLine(int16_t x, int16_t y, int16_t w,
 void FrameCore::drawFastHLine(int16_t x, int16_t y, int16_t w,
                                  uint16_t color) {
 //   startWrite();
-  writeLine(x, y, x + w - 1, y, color);
+  wr_span(x, y, w, color);
 //   endWrite();
 }
 
@@ -303,7 +873,7 @@ void FrameCore::writeFastVLine(int16_t x, int16_t y, int16_t h,
 void FrameCore::drawFastVLine(int16_t x, int16_t y, int16_t h,
                                  uint16_t color) {
 //   startWrite();
-  writeLine(x, y, x, y + h - 1, color);
+  wr_vspan(x, y, h, color);
 //   endWrite();
 }
 
@@ -329,6 +899,7 @@ void FrameCore::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 
   int16_t err = dx / 2;
   int16_t ystep;
+  uint16_t pix = pack9(color);
 
   if (y0 < y1) {
     ystep = 1;
@@ -338,9 +909,9 @@ void FrameCore::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 
   for (; x0 <= x1; x0++) {
     if (steep) {
-      wr_pix(y0, x0, color);
+      put_pix(y0, x0, pix);
     } else {
-      wr_pix(x0, y0, color);
+      put_pix(x0, y0, pix);
     }
     err -= dy;
     if (err < 0) {
@@ -199,6 +199,12 @@ private:
 /**
  * frame buffer core driver
  *
+ * video subsystem HDL parameter:
+ *  - VRAM_DATA_WIDTH = 9 (3-3-3 pixels; expanded by frame_palette_9)
+ *
+ * colors passed to the methods are 12-bit 4-4-4 (as for the other video
+ * cores) and converted to the 9-bit pixel format once per primitive
+ *
  */
 class FrameCore {
 public:
@@ -207,7 +213,42 @@ public:
     *
     */
    enum {
-      BYPASS_REG = 0xfffff  /**< bypass control register */
+      BYPASS_REG = 0xfffff,  /**< bypass control register */
+      STATUS_REG = 0xffffe,  /**< frame count/vblank status (read only) */
+      BLIT_CTRL_REG = 0xffffd, /**< fill engine: write starts / read status */
+      BLIT_COLOR_REG = 0xffffc,/**< fill engine: 9-bit pixel value */
+      BLIT_H_REG = 0xffffb,  /**< fill engine: height */
+      BLIT_W_REG = 0xffffa,  /**< fill engine: width */
+      BLIT_Y_REG = 0xffff9,  /**< fill engine: top row */
+      BLIT_X_REG = 0xffff8,  /**< fill engine: left column */
+      SPAN_COLOR_REG = 0xffff7,/**< span fifo: color of following commands */
+      SPAN_CMD_REG = 0xffff6   /**< span fifo: {length, start offset} */
+   };
+   /**
+    * field masks of status register
+    *
+    */
+   enum {
+      FRAME_CNT_FIELD = 0x0000ffff, /**< bits 15..0: # vertical blanks */
+      VBLANK_FIELD = 0x00010000     /**< bit 16: beam in vertical blanking */
+   };
+   /**
+    * fields of fill engine status register
+    *
+    * @note a bitstream without the engine reads the frame status
+    *       register here, whose bits 31..24 are 0
+    */
+   enum {
+      BLIT_BUSY_FIELD = 0x00000001, /**< bit 0: fill or queued span in progress */
+      BLIT_FREE_FIELD = 0x00001f00, /**< bits 12..8: free span fifo entries */
+      BLIT_SPAN_FIELD = 0x00010000, /**< bit 16: span fifo present */
+      BLIT_SIG_FIELD = 0xff000000,  /**< bits 31..24: signature */
+      BLIT_SIG = 0xb1000000         /**< signature of the fill engine */
+   };
+   enum {
+      BLIT_MIN_AREA = 8,            /**< smaller fills are done in software */
+      SPAN_FIFO_SIZE = 16,          /**< # span commands queued in hardware */
+      SPAN_LEN_SHIFT = 19           /**< length field of span command */
    };
    /**
     * Symbolic constants for frame buffer size
@@ -217,16 +258,74 @@ public:
     HMAX = 640,  /**< 640 pixels per row */
     VMAX = 480   /**< 480 pixels per row */
    };
+   /**
+    * Symbolic constants for brush rendering
+    *
+    */
+   enum {
+    BRUSH_R_MAX = 20   /**< largest radius with a cached span table */
+   };
+   /**
+    * Symbolic constants for tile state tracking
+    *
+    * frame is divided into 8-by-8 tiles; each tile is either known to
+    * hold a single color or marked mixed
+    *
+    * @note -D_NO_TILE_TRACK leaves every tile mixed, so no write is
+    *       skipped (to measure what the tracking saves)
+    *
+    */
+   enum {
+    TILE_SHIFT = 3,                 /**< log2 of tile width/height */
+    TILE_SIZE = 1 << TILE_SHIFT,    /**< 8 pixels per tile side */
+    TILE_COLS = HMAX >> TILE_SHIFT, /**< 80 tiles per row */
+    TILE_ROWS = VMAX >> TILE_SHIFT, /**< 60 tiles per column */
+    TILE_MIXED = 0xffff             /**< tile color unknown or not uniform */
+   };
    /* methods */
    FrameCore(uint32_t frame_base_addr);
    ~FrameCore();                  // not used
 
+   /**
+    * convert a 12-bit 4-4-4 color to a 9-bit 3-3-3 pixel
+    * @param color 12-bit color
+    * @return packed 9-bit pixel value (3 MSBs of each channel)
+    *
+    */
+   static constexpr uint16_t pack9(int color) {
+      return (uint16_t) (((color >> 3) & 0x1c0) | ((color >> 2) & 0x038) | ((color >> 1) & 0x007));
+   }
+
+   /**
+    * convert a 9-bit 3-3-3 pixel to the 12-bit color shown on screen
+    * @param pix packed 9-bit pixel value
+    * @return 12-bit color (each 3-bit channel a expanded to {a, a[2]},
+    *         as frame_palette_9 does)
+    *
+    */
+   static constexpr int unpack9(uint16_t pix) {
+      return (((pix & 0x1c0) << 3) | (pix & 0x100) | ((pix & 0x038) << 2)
+            | ((pix & 0x020) >> 1) | ((pix & 0x007) << 1) | ((pix & 0x004) >> 2));
+   }
+
+   /**
+    * enable/disable ordered dithering of filled areas
+    * @param on 1: dither fillRect()/clr_screen(); 0: nearest 9-bit color
+    *
+    * @note a 2-by-2 pattern recovers the LSB of each 4-bit channel
+    *
+    */
+   void set_dither(int on);
+
    /**
     * write a pixel to frame buffer
     * @param x x-coordinate of the pixel (between 0 and HMAX)
     * @param y y-coordinate of the pixel (between 0 and VMAX)
     * @param color pixel color
     *
+    * @note pixel outside the frame is ignored
+    * @note write skipped if the pixel's tile already holds only this color
+    *
     */
    void wr_pix(int x, int y, int color);
 
@@ -234,9 +333,122 @@ public:
     * clear frame buffer (fill the frame with a specific color)
     * @param color color to fill the frame
     *
+    * @note tiles already holding only this color are skipped
+    *
     */
    void clr_screen(int color);
 
+   /**
+    * fill a rectangle with the hardware fill engine
+    * @param x top left x coordinate
+    * @param y top left y coordinate
+    * @param w width of rectangle
+    * @param h height of rectangle
+    * @param color 12-bit fill color (no dithering)
+    * @return 1: fill engine present; 0: filled in software
+    *
+    * @note rectangle is clipped to the frame
+    * @note returns without waiting; the next frame buffer write
+    *       waits for the fill to finish (hw_wait())
+    * @note fillRect()/clr_screen() use the engine automatically
+    *
+    */
+   int hw_fill_rect(int x, int y, int w, int h, int color);
+
+   /**
+    * check for the hardware fill engine (probed on first use)
+    * @return 1: present; 0: absent
+    *
+    */
+   int has_blit();
+
+   /**
+    * check for the hardware span fifo (probed on first use)
+    * @return 1: present; 0: absent
+    *
+    */
+   int has_span();
+
+   /**
+    * wait until a started hardware fill and all queued spans are finished
+    *
+    */
+   void hw_wait();
+
+   /**
+    * write a horizontal run of pixels to frame buffer
+    * @param x x-coordinate of the leftmost pixel
+    * @param y y-coordinate of the run
+    * @param w # pixels in the run
+    * @param color pixel color
+    *
+    * @note run is clipped to the frame
+    * @note consecutive addresses are written with a running offset
+    *       (no per-pixel multiply, no line setup)
+    * @note pieces of the run inside tiles already of this color are skipped
+    * @note with the span fifo, each remaining piece is one bus write
+    *
+    */
+   void wr_span(int x, int y, int w, int color);
+
+   /**
+    * write a vertical run of pixels to frame buffer
+    * @param x x-coordinate of the run
+    * @param y y-coordinate of the topmost pixel
+    * @param h # pixels in the run
+    * @param color pixel color
+    *
+    * @note run is clipped to the frame; offset advances by HMAX per pixel
+    *
+    */
+   void wr_vspan(int x, int y, int h, int color);
+
+   /**
+    * read a pixel from frame buffer
+    * @param x x-coordinate of the pixel
+    * @param y y-coordinate of the pixel
+    * @return packed 9-bit pixel value (see unpack9()); 0 outside the frame
+    *
+    * @note waits for queued hardware fills first
+    * @note pixels in tiles known to hold a single color are not read
+    *       over the bus
+    *
+    */
+   uint16_t rd_pix(int x, int y);
+
+   /**
+    * read a horizontal run of pixels from frame buffer
+    * @param x x-coordinate of the leftmost pixel
+    * @param y y-coordinate of the run
+    * @param w # pixels in the run
+    * @param buf packed 9-bit pixel values (w entries)
+    * @return # pixels read (run is clipped to the frame; buf[0] is
+    *         the first pixel inside the frame)
+    *
+    */
+   int rd_span(int x, int y, int w, uint16_t *buf);
+
+   /**
+    * check for writes to a rectangle
+    * @param x top left x coordinate
+    * @param y top left y coordinate
+    * @param w width
+    * @param h height
+    * @return 1: a tile overlapping the rectangle was written since the
+    *         last clear_dirty(); 0: area unchanged
+    *
+    * @note tracked per tile; a write that leaves a tile unchanged
+    *       (skipped) does not mark it
+    *
+    */
+   int dirty(int x, int y, int w, int h);
+
+   /**
+    * mark all tiles clean
+    *
+    */
+   void clear_dirty();
+
 
    /**
     * generate pixels for a line in frame buffer (plot a line)
@@ -249,6 +461,25 @@ public:
     */
    void plot_line(int x1, int y1, int x2, int y2, int color);
 
+   /**
+    * generate pixels for a capsule (the area swept by a disc moving along a line)
+    * @param x0 x-coordinate of starting center
+    * @param y0 y-coordinate of starting center
+    * @param x1 x-coordinate of ending center
+    * @param y1 y-coordinate of ending center
+    * @param r radius of the disc
+    * @param color fill color
+    * @param cont 1: the disc at the start was written by the previous
+    *        segment of a stroke (same radius and color); its pixels are
+    *        not written again
+    * @return # pixels written
+    *
+    * @note each covered pixel is written once (at most two spans per row)
+    * @note radius above BRUSH_R_MAX falls back to a disc per line point
+    *
+    */
+   int fill_capsule(int x0, int y0, int x1, int y1, int r, int color, int cont = 0);
+
 
    /* v FROM ADAFRUIT v */
 
@@ -291,6 +522,9 @@ public:
     * @param    r   Radius of circle
     * @param    color 16-bit 5-6-5 Color to fill with
     *
+    * @note each row is written once as a horizontal span;
+    *       row widths for radius 1 to BRUSH_R_MAX are cached after first use
+    *
     */
    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
 
@@ -316,10 +550,57 @@ public:
     */
    void bypass(int by);
 
+   /**
+    * read the frame counter
+    * @return # vertical blanking intervals started (16-bit, wraps)
+    * @note reads 0 on a bitstream without the status register
+    *
+    */
+   uint32_t frame_count();
+
+   /**
+    * check whether the beam is in the vertical blanking interval
+    * @return 1: in vblank (frame buffer not being scanned); 0: otherwise
+    *
+    */
+   int in_vblank();
+
+   /**
+    * wait for the start of the next vertical blanking interval
+    * @return 1: vblank started; 0: timeout (no status register)
+    * @note gives up after 2 frame periods (40 ms)
+    *
+    */
+   int wait_vblank();
+
 
 private:
    uint32_t base_addr;
+   uint8_t brush_tab[BRUSH_R_MAX + 1][BRUSH_R_MAX + 1]; // row half-widths per radius
+   uint32_t brush_ready;                              // bit r set: brush_tab[r] valid
+   int16_t row_l[VMAX], row_r[VMAX];                  // capsule extent of each row
+   uint16_t tile[TILE_ROWS * TILE_COLS];              // uniform pixel or TILE_MIXED
+   uint32_t dirty_map[(TILE_ROWS * TILE_COLS + 31) / 32]; // bit set: tile written
+   int dither;                                        // 1: dither filled areas
+   int blit_state;                                    // -1: not probed; 0: absent; 1: present
+   int blit_pending;                                  // 1: hardware fill may be running
+   int span_hw;                                       // 1: span fifo present
+   int span_credit;                                   // span fifo entries known free
+   uint16_t span_color;                               // value in SPAN_COLOR_REG
+   void mark(uint16_t *t);
+   void put_pix(int x, int y, uint16_t pix);
+   void put_span(int x, int y, int w, uint16_t pix);
+   void put_vspan(int x, int y, int h, uint16_t pix);
+   void fill_block(int x, int y, int w, int h, uint16_t pix);
+   int blit_rect(int x, int y, int w, int h, uint16_t pix);
+   void span_cmd(uint32_t offset, int len, uint16_t pix);
+   void fill_color(int x, int y, int w, int h, int color);
+   void fill_dither(int x, int y, int w, int h, int color);
+   int clip_rect(int *x, int *y, int *w, int *h);
    void swap(int &a, int &b);
+   const uint8_t *brush_spans(int r);
+   int circle_rows(int x0, int y0, int r, uint8_t *half, uint16_t pix);
+   int circle_row(int x0, int y0, int dy, int hw, uint8_t *half, uint16_t pix);
 };
 
 #endif  // _VGA_H_INCLUDED
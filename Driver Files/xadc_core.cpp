@@ -11,6 +11,10 @@
 
 XadcCore::XadcCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   drp = -1;   // probed on first use
+   for (int n = 0; n < N_CH; n++)
+      set_filter(n, 0, 0);
+   primed = 0;
 }
 
 XadcCore::~XadcCore() {
@@ -38,3 +42,71 @@ double XadcCore::read_fpga_vcc() {
 double XadcCore::read_fpga_temp() {
    return (read_adc_in(TMP_REG) * 503.975 - 273.15);
 }
+
+void XadcCore::set_filter(int n, int shift, int hyst) {
+   if (shift > 8)
+      shift = 8;
+   this->shift[n] = (uint8_t) shift;
+   this->hyst[n] = (int16_t) hyst;
+}
+
+uint32_t XadcCore::update(uint32_t mask) {
+   uint32_t changed = 0;
+   int32_t raw;
+   int n, v, d;
+
+   for (n = 0; n < N_CH; n++) {
+      if (!(mask & (1 << n)))
+         continue;
+      raw = (int32_t) (read_raw(n) >> 4) << 4;      // 12 bits, Q4
+      if (!(primed & (1 << n))) {
+         filt[n] = raw;
+         shown[n] = (int16_t) (raw >> 4);
+         primed = primed | (1 << n);
+         changed = changed | (1 << n);
+         continue;
+      }
+      filt[n] = filt[n] + ((raw - filt[n]) >> shift[n]);
+      v = (filt[n] + 8) >> 4;                       // rounded
+      d = v - shown[n];
+      if (d > hyst[n] || -d > hyst[n]) {
+         shown[n] = (int16_t) v;
+         changed = changed | (1 << n);
+      }
+   }
+   return (changed);
+}
+
+int XadcCore::value(int n) {
+   return (shown[n]);
+}
+
+void XadcCore::drp_write(int daddr, uint16_t data) {
+   while (io_read(base_addr, DRP_REG) & DRP_PEND_FIELD) {
+   };
+   io_write(base_addr, DRP_WR_REG, ((uint32_t) daddr << 16) | data);
+}
+
+/*
+ * xadc registers (see Xilinx ug480)
+ *  - 0x40 config 0: bits 13-12 averaging (0: none, 1: 16, 2: 64, 3: 256)
+ *  - 0x4a/0x4b: channels averaged (same bits as the channel selection
+ *    in 0x48/0x49: temp, vccint, aux 2, 3, 10, 11)
+ *  - 0x41 config 1: written again (value of xadc_fpro) to restart
+ *    the sequence with the new setting
+ */
+int XadcCore::set_hw_avg(int n_avg) {
+   int avg;
+
+   // a core without DRP writes returns the vcc reading at register 6
+   if (drp < 0)
+      drp = ((io_read(base_addr, DRP_REG) & DRP_SIG_FIELD) == DRP_SIG) ? 1 : 0;
+   if (!drp)
+      return (0);
+   avg = (n_avg >= 256) ? 3 : (n_avg >= 64) ? 2 : (n_avg >= 16) ? 1 : 0;
+   drp_write(0x4a, avg ? 0x0300 : 0x0000);
+   drp_write(0x4b, avg ? 0x0c0c : 0x0000);
+   drp_write(0x40, (uint16_t) (avg << 12));
+   drp_write(0x41, 0x21af);
+   return (1);
+}
@@ -16,6 +16,12 @@
 /**
  * adsr core driver:
  * - retrieve data from 6 xadc channels
+ * - change detection in integer math: per channel, an IIR filter
+ *   (weight 1/2^shift, Q4 state) and a hysteresis band around the
+ *   last reported value; update() reads the channels and returns the
+ *   ones whose reported value moved
+ * - on a core with a DRP write port, the xadc can average 16 to 256
+ *   conversions per result (set_hw_avg())
  */
 class XadcCore {
 public:
@@ -26,6 +32,21 @@ public:
       ADC_0_REG = 0,  /**< 16-bit data from Nexys 4 adc input #0 */
       TMP_REG   = 4,  /**< FPGA internal temperature */
       VCC_REG   = 5,  /**< FPGA internal core voltage */
+      DRP_REG   = 6,  /**< DRP write status (signature 0xa7 in bits 31-24) */
+      DRP_WR_REG = 7  /**< DRP write: address in bits 22-16, data in bits 15-0 */
+   };
+
+   enum {
+      N_CH = 6        /**< # adc input sources */
+   };
+
+   /**
+    * DRP status fields
+    */
+   enum {
+      DRP_SIG_FIELD = 0xff000000,
+      DRP_SIG = 0xa7000000,
+      DRP_PEND_FIELD = 0x00010000
    };
 
    /**
@@ -67,9 +88,51 @@ public:
     */
    double read_fpga_temp();
 
+   /**
+    * set change detection of a channel
+    *
+    * @param n adc input source (0 to 5)
+    * @param shift filter weight 1/2^shift (0: no filter; up to 8)
+    * @param hyst change (12-bit LSBs) needed to report a new value
+    * @note default: no filter, no hysteresis (any change is reported)
+    */
+   void set_filter(int n, int shift, int hyst);
+
+   /**
+    * read channels and detect changes
+    *
+    * @param mask channels to read (bit n: input source n)
+    * @return channels whose reported value changed
+    * @note the first reading of a channel reports a change
+    */
+   uint32_t update(uint32_t mask);
+
+   /**
+    * reported value of a channel
+    *
+    * @param n adc input source (0 to 5)
+    * @return 12-bit value as of the last change
+    */
+   int value(int n);
+
+   /**
+    * set on-chip averaging of all sequenced channels
+    *
+    * @param n_avg conversions per result (1, 16, 64 or 256)
+    * @return 1: set; 0: core has no DRP write port
+    */
+   int set_hw_avg(int n_avg);
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
+   int drp;                    // DRP write port; -1: not probed; 0: absent; 1: present
+   int32_t filt[N_CH];         // filter state, Q4
+   int16_t shown[N_CH];        // reported value
+   uint8_t shift[N_CH];
+   int16_t hyst[N_CH];
+   uint32_t primed;            // channels read at least once
+   void drp_write(int daddr, uint16_t data);
 }
 ;
 
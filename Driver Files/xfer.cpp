@@ -0,0 +1,185 @@
+/*****************************************************************//**
+ * @file xfer.cpp
+ *
+ * @brief implementation of CanvasXfer class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "xfer.h"
+
+enum {
+   RUN_SHIFT = 9,
+   RUN_MAX = 128,
+   PIX_FIELD = 0x1ff
+};
+
+static const char MAGIC[4] = {'P', '9', 'R', 'L'};
+
+CanvasXfer::CanvasXfer(FrameCore *frame_p, UartCore *uart_p) {
+   frame = frame_p;
+   uart = uart_p;
+   set_canvas(0, 0, FrameCore::HMAX, FrameCore::VMAX);
+   crc = 0xffff;
+   n_bytes = 0;
+   dur_us = 0;
+}
+
+CanvasXfer::~CanvasXfer() {
+}
+
+void CanvasXfer::set_canvas(int x, int y, int w, int h) {
+   cv_x = x;
+   cv_y = y;
+   cv_w = w;
+   cv_h = h;
+}
+
+// CRC-16/CCITT, one bit at a time (no table)
+void CanvasXfer::add_crc(uint8_t b) {
+   crc = crc ^ ((uint16_t) b << 8);
+   for (int i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+}
+
+void CanvasXfer::put(uint8_t b) {
+   add_crc(b);
+   uart->tx_byte(b);
+   n_bytes++;
+}
+
+void CanvasXfer::put16(uint16_t v) {
+   put((uint8_t) v);
+   put((uint8_t) (v >> 8));
+}
+
+int CanvasXfer::send() {
+   uint16_t buf[64];             // a row piece (the program stack is 1K)
+   uint16_t cur = 0;
+   unsigned long t0;
+   int row, x, n, k, run, old;
+
+   t0 = now_us();
+   old = uart->tx_policy(UartCore::TX_WAIT);   // never drop stream bytes
+   crc = 0xffff;
+   n_bytes = 0;
+   for (k = 0; k < 4; k++)
+      put(MAGIC[k]);
+   put16((uint16_t) cv_w);
+   put16((uint16_t) cv_h);
+   run = 0;
+   for (row = 0; row < cv_h; row++) {
+      for (x = 0; x < cv_w; x = x + n) {
+         n = (cv_w - x < 64) ? cv_w - x : 64;
+         frame->rd_span(cv_x + x, cv_y + row, n, buf);
+         for (k = 0; k < n; k++) {
+            if (run > 0 && buf[k] == cur && run < RUN_MAX) {
+               run++;
+               continue;
+            }
+            if (run > 0)
+               put16(cur | ((run - 1) << RUN_SHIFT));
+            cur = buf[k];
+            run = 1;
+         }
+      }
+   }
+   if (run > 0)
+      put16(cur | ((run - 1) << RUN_SHIFT));
+   k = crc;                      // trailer is not part of the crc
+   put16((uint16_t) k);
+   uart->tx_policy(old);
+   dur_us = now_us() - t0;
+   return (n_bytes);
+}
+
+// wait for a byte; -1 on timeout
+int CanvasXfer::get(unsigned long timeout_ms) {
+   unsigned long t0 = now_ms();
+   int b;
+
+   while ((b = uart->rx_byte()) < 0) {
+      if (now_ms() - t0 > timeout_ms)
+         return (-1);
+   }
+   add_crc((uint8_t) b);
+   n_bytes++;
+   return (b);
+}
+
+int CanvasXfer::receive(unsigned long timeout_ms) {
+   unsigned long t0;
+   uint32_t left;
+   uint16_t v, pix;
+   int b[4], m, w, h, col, row, run, seg, k;
+
+   t0 = now_us();
+   n_bytes = 0;
+   /* skip to the magic */
+   m = 0;
+   while (m < 4) {
+      b[0] = get(timeout_ms);
+      if (b[0] < 0)
+         return (XFER_TIMEOUT);
+      if (b[0] == MAGIC[m])
+         m++;
+      else
+         m = (b[0] == MAGIC[0]) ? 1 : 0;
+   }
+   crc = 0xffff;                 // crc starts at the magic
+   for (k = 0; k < 4; k++)
+      add_crc((uint8_t) MAGIC[k]);
+   for (k = 0; k < 4; k++) {
+      b[k] = get(timeout_ms);
+      if (b[k] < 0)
+         return (XFER_TIMEOUT);
+   }
+   w = b[0] | (b[1] << 8);
+   h = b[2] | (b[3] << 8);
+   if (w == 0 || h == 0 || w > cv_w || h > cv_h)
+      return (XFER_FORMAT);
+   /* runs until the image is covered */
+   left = (uint32_t) w * h;
+   col = 0;
+   row = 0;
+   while (left > 0) {
+      b[0] = get(timeout_ms);
+      b[1] = (b[0] < 0) ? -1 : get(timeout_ms);
+      if (b[1] < 0)
+         return (XFER_TIMEOUT);
+      v = (uint16_t) (b[0] | (b[1] << 8));
+      pix = v & PIX_FIELD;
+      run = (v >> RUN_SHIFT) + 1;
+      if ((uint32_t) run > left)
+         return (XFER_FORMAT);
+      left = left - run;
+      while (run > 0) {
+         seg = (run < w - col) ? run : w - col;
+         frame->wr_span(cv_x + col, cv_y + row, seg, FrameCore::unpack9(pix));
+         col = col + seg;
+         run = run - seg;
+         if (col == w) {
+            col = 0;
+            row++;
+         }
+      }
+   }
+   /* trailer */
+   v = crc;
+   b[0] = get(timeout_ms);
+   b[1] = (b[0] < 0) ? -1 : get(timeout_ms);
+   dur_us = now_us() - t0;
+   if (b[1] < 0)
+      return (XFER_TIMEOUT);
+   if ((b[0] | (b[1] << 8)) != v)
+      return (XFER_CHECKSUM);
+   return (XFER_OK);
+}
+
+int CanvasXfer::last_bytes() {
+   return (n_bytes);
+}
+
+uint32_t CanvasXfer::last_us() {
+   return (dur_us);
+}
@@ -0,0 +1,98 @@
+/*****************************************************************//**
+ * @file xfer.h
+ *
+ * @brief Canvas export/import over the uart
+ *
+ * Description:
+ *  - stream format (all 16-bit fields little endian):
+ *     - header: "P9RL", width, height
+ *     - body: run words, row-major over the image, runs continue
+ *       across rows; bits 8..0 packed 9-bit pixel (see
+ *       FrameCore::unpack9()), bits 15..9 run length - 1
+ *     - trailer: CRC-16/CCITT (poly 0x1021, init 0xffff) of header
+ *       and body
+ *  - export reads the canvas back with FrameCore::rd_span()
+ *  - import waits for the header (bytes before it are skipped) and
+ *    paints each run as span writes as it arrives; the image is
+ *    placed at the top left of the canvas and may be smaller
+ *  - a blank 440 x 340 canvas is 2348 bytes (vs. 168 KB raw);
+ *    Host Files/rle2ppm.cpp turns a captured stream into a PPM image
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _XFER_H_INCLUDED
+#define _XFER_H_INCLUDED
+
+#include "vga_core.h"
+#include "uart_core.h"
+
+/**
+ * canvas transfer module
+ *
+ */
+class CanvasXfer {
+public:
+   /**
+    * receive status
+    *
+    */
+   enum {
+      XFER_OK = 0,          /**< image received */
+      XFER_TIMEOUT = -1,    /**< no header, or stream stopped */
+      XFER_FORMAT = -2,     /**< size too large or runs overflow the image */
+      XFER_CHECKSUM = -3    /**< crc mismatch (image already painted) */
+   };
+
+   /* methods */
+   /**
+    * constructor.
+    * @param frame_p pointer to frame buffer instance
+    * @param uart_p pointer to uart core instance
+    * @note canvas defaults to the whole frame
+    *
+    */
+   CanvasXfer(FrameCore *frame_p, UartCore *uart_p);
+   ~CanvasXfer();                  // not used
+
+   /**
+    * set the canvas rectangle
+    *
+    */
+   void set_canvas(int x, int y, int w, int h);
+
+   /**
+    * send the canvas
+    * @return # bytes sent
+    * @note blocks until the last byte is in the uart fifo or (with a
+    *       buffered uart) in its transmit buffer; bytes are never dropped
+    *
+    */
+   int send();
+
+   /**
+    * receive an image and paint it on the canvas
+    * @param timeout_ms longest wait for the header and between bytes
+    * @return XFER_OK or an error status
+    *
+    */
+   int receive(unsigned long timeout_ms);
+
+   /* statistics of the last transfer */
+   int last_bytes();
+   uint32_t last_us();
+
+private:
+   FrameCore *frame;
+   UartCore *uart;
+   int cv_x, cv_y, cv_w, cv_h;
+   uint16_t crc;
+   int n_bytes;
+   uint32_t dur_us;
+   void put(uint8_t b);
+   void put16(uint16_t v);
+   int get(unsigned long timeout_ms);
+   void add_crc(uint8_t b);
+};
+
+#endif  // _XFER_H_INCLUDED
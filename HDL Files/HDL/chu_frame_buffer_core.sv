@@ -6,28 +6,78 @@ module chu_frame_buffer_core
    input  logic clk, reset,
    // frame counter
    input  logic [10:0] x, y,
+   // vertical blanking from vga sync (asynchronous)
+   input  logic vblank,
    // video slot interface
    input  logic cs,      
    input  logic write,  
+   input  logic read,
    input  logic [19:0] addr,    
    input  logic [31:0] wr_data,
+   output logic [31:0] rd_data,
    // stream interface
    input  logic [CD-1:0] si_rgb,
    output logic [CD-1:0] so_rgb
 );
 
    // delaration
-   logic wr_en, wr_pix, wr_bypass;
+   logic wr_en, wr_pix, rd_pix, cpu_pix, wr_bypass, wr_blit, wr_span, wr_span_color;
    logic [CD-1:0] osd_rgb;
    logic [CD-1:0] frame_rgb;
    logic bypass_reg;
+   logic [1:0] vb_sync_reg;
+   logic vb_reg;
+   logic [15:0] frame_cnt_reg;
+   logic [9:0] blit_x_reg, blit_y_reg, blit_w_reg, blit_h_reg;
+   logic [DW-1:0] blit_color_reg;
+   logic blit_start, blit_busy, busy;
+   logic [18:0] blit_addr, ram_addr;
+   logic [DW-1:0] blit_data, ram_data, ram_rd_data;
+   logic blit_write;
+   logic [18:0] rect_addr, go_addr;
+   logic [9:0] go_w, go_h;
+   logic [DW-1:0] go_color;
+   logic go;
+   // span command fifo: {color, length, start address}
+   logic [DW-1:0] span_color_reg;
+   logic [DW+28:0] span_head;
+   logic span_empty, span_full, span_go, span_push;
+   logic [4:0] span_cnt_reg;
    
    // body
    // instantiate osd generator
    frame_src #(.CD(CD)) frame_src_unit (
-      .clk(clk), .x(x), .y(y), .addr_pix(addr[18:0]), 
-      .wr_data_pix(wr_data[DW-1:0]), .write_pix(wr_pix),
+      .clk(clk), .x(x), .y(y), .addr_pix(ram_addr), 
+      .wr_data_pix(ram_data), .write_pix(wr_pix | blit_write),
+      .rd_data_pix(ram_rd_data),
       .frame_rgb(frame_rgb));
+   // instantiate rectangle fill engine
+   frame_blit #(.DW(DW)) blit_unit (
+      .clk(clk), .reset(reset), .start(go),
+      .start_addr(go_addr), .w(go_w), .h(go_h),
+      .color(go_color), .stall(cpu_pix), .busy(blit_busy),
+      .addr_pix(blit_addr), .wr_data_pix(blit_data), .write_pix(blit_write));
+   // instantiate 16-entry span command fifo
+   fifo #(.DATA_WIDTH(DW+29), .ADDR_WIDTH(4)) span_fifo_unit (
+      .clk(clk), .reset(reset), .rd(span_go), .wr(span_push),
+      .w_data({span_color_reg, wr_data[28:0]}),
+      .empty(span_empty), .full(span_full), .r_data(span_head));
+   // engine command: queued span first, else rectangle from registers
+   // rectangle start address = 640*y + x = 512*y + 128*y + x
+   assign rect_addr = {blit_y_reg[8:0], 9'b0} + {2'b00, blit_y_reg[8:0], 7'b0} 
+                      + blit_x_reg;
+   assign span_go = ~blit_busy & ~span_empty;
+   assign go = span_go | blit_start;
+   assign go_addr = span_go ? span_head[18:0] : rect_addr;
+   assign go_w = span_go ? span_head[28:19] : blit_w_reg;
+   assign go_h = span_go ? 10'd1 : blit_h_reg;
+   assign go_color = span_go ? span_head[DW+28:29] : blit_color_reg;
+   assign busy = blit_busy | ~span_empty;
+   // video RAM write/read-back port: processor access has priority over
+   // the engine; the scan pipeline has the other port to itself
+   assign cpu_pix = wr_pix | rd_pix;
+   assign ram_addr = cpu_pix ? addr[18:0] : blit_addr;
+   assign ram_data = wr_pix ? wr_data[DW-1:0] : blit_data;
    // register  
    always_ff @(posedge clk, posedge reset)
       if (reset) 
@@ -35,10 +85,72 @@ module chu_frame_buffer_core
       else 
          if (wr_bypass)
             bypass_reg <= wr_data[0];
+   // span color (taken into each queued command) and fifo occupancy
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         span_color_reg <= 0;
+         span_cnt_reg <= 0;
+      end
+      else begin
+         if (wr_span_color)
+            span_color_reg <= wr_data[DW-1:0];
+         if (span_push & ~span_go)
+            span_cnt_reg <= span_cnt_reg + 1;
+         else if (~span_push & span_go)
+            span_cnt_reg <= span_cnt_reg - 1;
+      end
+   // fill engine registers (ignored while a fill is running)
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         blit_x_reg <= 0;
+         blit_y_reg <= 0;
+         blit_w_reg <= 0;
+         blit_h_reg <= 0;
+         blit_color_reg <= 0;
+      end
+      else if (wr_blit && ~busy)
+         case (addr[2:0])
+            3'b000: blit_x_reg <= wr_data[9:0];
+            3'b001: blit_y_reg <= wr_data[9:0];
+            3'b010: blit_w_reg <= wr_data[9:0];
+            3'b011: blit_h_reg <= wr_data[9:0];
+            3'b100: blit_color_reg <= wr_data[DW-1:0];
+            default: ;
+         endcase
+   // vblank synchronizer and frame counter (+1 at start of vblank)
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         vb_sync_reg <= 0;
+         vb_reg <= 0;
+         frame_cnt_reg <= 0;
+      end   
+      else begin
+         vb_sync_reg <= {vb_sync_reg[0], vblank};
+         vb_reg <= vb_sync_reg[1];
+         if (vb_sync_reg[1] & ~vb_reg)
+            frame_cnt_reg <= frame_cnt_reg + 1;
+      end
    // decoding 
    assign wr_en = write & cs;
    assign wr_bypass = wr_en && addr==20'hfffff;
-   assign wr_pix = wr_en && addr!=20'hfffff;
+   assign wr_blit = wr_en && addr[19:3]==17'h1ffff;   // 0xffff8 - 0xfffff
+   assign wr_span = wr_en && addr==20'hffff6;
+   assign wr_span_color = wr_en && addr==20'hffff7;
+   assign wr_pix = wr_en && addr[19:4]!=16'hffff;    // 0xffff0 - 0xfffff reserved
+   assign rd_pix = read && cs && addr[19:4]!=16'hffff;
+   assign blit_start = wr_blit && addr[2:0]==3'b101 && ~busy;
+   // a full fifo drops the command (driver keeps count of free entries)
+   assign span_push = wr_span & ~span_full;
+   // read data (bus samples it 1 clock after the read strobe, address held)
+   //   pixel addresses: pixel value from the read-back port
+   //   0xffffd: fill engine status: signature 0xb1 (bits 31:24), 
+   //     span fifo present (bit 16), free fifo entries (bits 12:8), 
+   //     busy (bit 0)
+   //   other register addresses: frame status register
+   assign rd_data = (addr[19:4]!=16'hffff) ? {{(32-DW){1'b0}}, ram_rd_data} :
+                    (addr==20'hffffd) ? 
+                    {8'hb1, 7'b0, 1'b1, 3'b0, 5'd16 - span_cnt_reg, 7'b0, busy} :
+                    {15'b0, vb_reg, frame_cnt_reg};
    // stream blending: mux
    assign so_rgb = bypass_reg ? si_rgb : frame_rgb;
 endmodule
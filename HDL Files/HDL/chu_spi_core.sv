@@ -22,24 +22,44 @@ module chu_spi_core
    logic [17:0] ctrl_reg;
    logic [S-1:0] ss_n_reg;
    logic [7:0] spi_out;
-   logic spi_ready, cpol, cpha; 
+   logic spi_ready, spi_done, cpol, cpha; 
    logic [15:0] dvsr;
+   // queued transfers: tx fifo feeds the controller, rx fifo collects
+   // the bytes read back by queued transfers
+   logic wr_queue, rd_rx, q_start, q_reg, rx_push, start;
+   logic tx_empty, tx_full, rx_empty, rx_full;
+   logic [7:0] tx_head, rx_head, din;
+   logic [4:0] tx_cnt_reg, rx_cnt_reg;
    
    // instantiate spi controller
    spi spi_unit(
     .clk(clk), .reset(reset), 
-    .din(wr_data[7:0]),
+    .din(din),
     .dvsr(dvsr),
-    .start(wr_spi),
+    .start(start),
     .cpol(cpol),
     .cpha(cpha),
     .dout(spi_out),
     .sclk(spi_sclk),
     .miso(spi_miso),
     .mosi(spi_mosi),
-    .spi_done_tick(),
+    .spi_done_tick(spi_done),
     .ready(spi_ready)
    );
+   // instantiate 16-entry tx and rx fifos
+   fifo #(.DATA_WIDTH(8), .ADDR_WIDTH(4)) tx_fifo_unit (
+      .clk(clk), .reset(reset), .rd(q_start), .wr(wr_queue),
+      .w_data(wr_data[7:0]), .empty(tx_empty), .full(tx_full), 
+      .r_data(tx_head));
+   fifo #(.DATA_WIDTH(8), .ADDR_WIDTH(4)) rx_fifo_unit (
+      .clk(clk), .reset(reset), .rd(rd_rx), .wr(rx_push),
+      .w_data(spi_out), .empty(rx_empty), .full(rx_full), 
+      .r_data(rx_head));
+   // a direct write (wr_spi) has priority over the queue
+   assign q_start = spi_ready & ~tx_empty & ~wr_spi;
+   assign start = wr_spi | q_start;
+   assign din = wr_spi ? wr_data[7:0] : tx_head;
+   assign rx_push = spi_done & q_reg;
        
    // registers
    always_ff @(posedge clk, posedge reset)
@@ -53,16 +73,42 @@ module chu_spi_core
          if (wr_ss)
              ss_n_reg <= wr_data[S-1:0];
       end
+   // byte in progress came from the queue; fifo occupancy
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         q_reg <= 1'b0;
+         tx_cnt_reg <= 0;
+         rx_cnt_reg <= 0;
+      end 
+      else begin
+         if (start)
+            q_reg <= q_start;
+         if (wr_queue & ~tx_full & ~q_start)
+            tx_cnt_reg <= tx_cnt_reg + 1;
+         else if (~(wr_queue & ~tx_full) & q_start)
+            tx_cnt_reg <= tx_cnt_reg - 1;
+         if (rx_push & ~rx_full & ~(rd_rx & ~rx_empty))
+            rx_cnt_reg <= rx_cnt_reg + 1;
+         else if (~(rx_push & ~rx_full) & rd_rx & ~rx_empty)
+            rx_cnt_reg <= rx_cnt_reg - 1;
+      end
    // decoding
    assign wr_en = cs & write ;
-   assign wr_ss = wr_en && addr[1:0]==2'b01;
-   assign wr_spi = wr_en && addr[1:0]==2'b10;
-   assign wr_ctrl = wr_en && addr[1:0]==2'b11;
+   assign wr_ss = wr_en && addr[2:0]==3'b001;
+   assign wr_spi = wr_en && addr[2:0]==3'b010;
+   assign wr_ctrl = wr_en && addr[2:0]==3'b011;
+   assign rd_rx = wr_en && addr[2:0]==3'b100;     // write pops the rx fifo
+   assign wr_queue = wr_en && addr[2:0]==3'b101;
    // control signals 
    assign dvsr = ctrl_reg[15:0];
    assign cpol = ctrl_reg[16];
    assign cpha = ctrl_reg[17];
    assign spi_ss_n = ss_n_reg;
    // read multiplexing 
-   assign  rd_data = {23'b0, spi_ready, spi_out};
+   //   reg 4: fifo status: signature 0x5f (bits 31:24), rx entries
+   //   (bits 20:16), free tx entries (bits 12:8), rx fifo head (bits 7:0)
+   //   other: ready (idle and tx fifo empty) and last byte read
+   assign  rd_data = (addr[2:0]==3'b100) ?
+                     {8'h5f, 3'b0, rx_cnt_reg, 3'b0, 5'd16 - tx_cnt_reg, rx_head} :
+                     {23'b0, spi_ready & tx_empty, spi_out};
 endmodule  
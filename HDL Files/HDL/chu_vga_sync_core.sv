@@ -15,7 +15,9 @@ module chu_vga_sync_core
     output logic si_ready,
     // to vga monitor
     output logic hsync, vsync,
-    output logic[CD-1:0] rgb
+    output logic[CD-1:0] rgb,
+    // vertical blanking (clk_25M domain)
+    output logic vblank
    );
 
    // signal delaration
@@ -44,6 +46,7 @@ module chu_vga_sync_core
     .vga_si_ready(vga_si_ready),
     .hsync(hsync),
     .vsync(vsync),
-    .rgb(rgb)
+    .rgb(rgb),
+    .vblank(vblank)
    );
 endmodule
\ No newline at end of file
@@ -1,13 +1,17 @@
 module chu_video_controller (
    input  logic video_cs,
    input  logic video_wr,
+   input  logic video_rd,
    input  logic [20:0] video_addr, 
    input  logic [31:0] video_wr_data,
+   output logic [31:0] video_rd_data,
    // MM frame buffer interface 
    output logic frame_cs,
    output logic frame_wr,
+   output logic frame_rd,
    output logic [19:0] frame_addr,
    output logic [31:0] frame_wr_data,
+   input  logic [31:0] frame_rd_data,
    // MM video core slot interface
    output logic [7:0] slot_cs_array,     
    output logic [7:0] slot_mem_wr_array, 
@@ -38,7 +42,10 @@ module chu_video_controller (
    // frame buffer
    assign frame_addr = video_addr[19:0];
    assign frame_wr = video_wr;
+   assign frame_rd = video_rd;
    assign frame_wr_data = video_wr_data;
+   // read data: only the frame buffer core is readable
+   assign video_rd_data = video_addr[20] ? frame_rd_data : 32'h0;
    // broadcast to all video slots 
    generate
       genvar i;
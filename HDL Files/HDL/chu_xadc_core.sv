@@ -4,6 +4,11 @@
 //  * DRP interface is connected to atomtically read
 //    out the pres-designated channels
 //  * the readout is stored into corresponding register
+//  * a write to register 7 ({daddr[22:16], data[15:0]}) is passed on
+//    as a DRP write (e.g., to set on-chip averaging); a conversion
+//    that ends while it is in progress is not read out
+//  * register 6 reads the DRP write status: signature 0xa7 in
+//    bits 31:24, write pending in bit 16
 
 module chu_xadc_core
    (
@@ -30,15 +35,20 @@ module chu_xadc_core
    logic [15:0] adc0_out_reg, adc1_out_reg, adc2_out_reg, adc3_out_reg;
    logic [15:0] tmp_out_reg , vcc_out_reg ;
    logic [31:0] r_data;
+   // DRP write from the processor
+   logic wr_drp, drp_we, drp_den, drp_rd;
+   logic drp_pend_reg, drp_busy_reg, drp_rd_reg;
+   logic [6:0] drp_addr_reg;
+   logic [15:0] drp_data_reg;
    
    // instantiate xadc
    xadc_fpro xadc_unit (
       .dclk_in(clk),         // input logic dclk_in
       .reset_in(reset),      // input logic reset_in
-      .di_in(16'h0000),      // input logic [15 : 0] di_in
+      .di_in(drp_data_reg),  // input logic [15 : 0] di_in
       .daddr_in(daddr_in),   // input logic [6 : 0] daddr_in
-      .den_in(eoc),          // input logic den_in
-      .dwe_in(1'b0),         // input logic dwe_in
+      .den_in(drp_den),      // input logic den_in
+      .dwe_in(drp_we),       // input logic dwe_in
       .drdy_out(rdy),        // output logic drdy_out
       .do_out(adc_data),     // output logic [15 : 0] do_out
       .vp_in(1'b0),          // input logic vp_in
@@ -58,7 +68,36 @@ module chu_xadc_core
       .busy_out()            // output logic busy_out
    );
 
-   assign daddr_in = {2'b00, channel};
+   // one DRP access at a time: a conversion result is read at eoc,
+   // a pending write goes out when the port is free
+   assign wr_drp = cs && write && addr[2:0]==3'b111;
+   assign drp_rd = eoc & ~drp_busy_reg;
+   assign drp_we = drp_pend_reg & ~drp_busy_reg & ~eoc;
+   assign drp_den = drp_rd | drp_we;
+   assign daddr_in = drp_we ? drp_addr_reg : {2'b00, channel};
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         drp_pend_reg <= 1'b0;
+         drp_busy_reg <= 1'b0;
+         drp_rd_reg <= 1'b0;
+         drp_addr_reg <= 7'h00;
+         drp_data_reg <= 16'h0000;
+      end 
+      else begin
+         if (wr_drp) begin
+            drp_pend_reg <= 1'b1;
+            drp_addr_reg <= wr_data[22:16];
+            drp_data_reg <= wr_data[15:0];
+         end
+         else if (drp_we)
+            drp_pend_reg <= 1'b0;
+         if (drp_den) begin
+            drp_busy_reg <= 1'b1;
+            drp_rd_reg <= drp_rd;
+         end
+         else if (rdy)
+            drp_busy_reg <= 1'b0;
+      end
    
    // registers and decoding
    always_ff @(posedge clk, posedge reset)
@@ -71,17 +110,17 @@ module chu_xadc_core
          vcc_out_reg <= 16'h0000;
       end 
       else begin
-         if (rdy && channel == 5'b10011)
+         if (rdy && drp_rd_reg && channel == 5'b10011)
             adc0_out_reg <= adc_data;
-         if (rdy && channel == 5'b11010)
+         if (rdy && drp_rd_reg && channel == 5'b11010)
             adc1_out_reg <= adc_data;
-         if (rdy && channel == 5'b10010)
+         if (rdy && drp_rd_reg && channel == 5'b10010)
             adc2_out_reg <= adc_data;
-         if (rdy && channel == 5'b11011)
+         if (rdy && drp_rd_reg && channel == 5'b11011)
             adc3_out_reg <= adc_data;
-         if (rdy && channel == 5'b00000)
+         if (rdy && drp_rd_reg && channel == 5'b00000)
             tmp_out_reg <= adc_data;
-         if (rdy && channel == 5'b00001)
+         if (rdy && drp_rd_reg && channel == 5'b00001)
             vcc_out_reg <= adc_data;
      end
     
@@ -98,6 +137,8 @@ module chu_xadc_core
             r_data <= {16'h0000, adc3_out_reg};
          3'b100:
             r_data <= {16'h0000, tmp_out_reg};
+         3'b110:
+            r_data <= {8'ha7, 7'b0, drp_pend_reg, 16'h0000};
          default:
             r_data <= {16'h0000, vcc_out_reg};
       endcase
@@ -0,0 +1,76 @@
+// rectangle fill engine of the frame buffer
+//  - writes color into w-by-h pixels starting at start_addr,
+//    one pixel per clock, row by row; a span is a rectangle with h=1
+//  - w and color are latched at start
+//  - stall (processor write in the same clock) has priority;
+//    the engine holds its position and retries
+//  - rectangle must lie inside the 640-by-480 frame (checked by driver)
+module frame_blit
+   #(parameter DW = 9)   // video RAM data width
+   (
+    input  logic clk, reset,
+    // command
+    input  logic start,
+    input  logic [18:0] start_addr,
+    input  logic [9:0] w, h,
+    input  logic [DW-1:0] color,
+    input  logic stall,
+    output logic busy,
+    // video RAM write port
+    output logic [18:0] addr_pix,
+    output logic [DW-1:0] wr_data_pix,
+    output logic write_pix
+   );
+
+   // declaration
+   logic busy_reg;
+   logic [18:0] addr_reg, row_reg;
+   logic [9:0] col_reg, rows_reg, w_reg;
+   logic [DW-1:0] color_reg;
+   logic last_col, last_row;
+   
+   // body
+   assign last_col = (col_reg == 1);
+   assign last_row = (rows_reg == 1);
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         busy_reg <= 0;
+         addr_reg <= 0;
+         row_reg <= 0;
+         col_reg <= 0;
+         rows_reg <= 0;
+         w_reg <= 0;
+         color_reg <= 0;
+      end   
+      else if (~busy_reg) begin
+         if (start && w!=0 && h!=0) begin
+            busy_reg <= 1;
+            addr_reg <= start_addr;
+            row_reg <= start_addr;
+            col_reg <= w;
+            rows_reg <= h;
+            w_reg <= w;
+            color_reg <= color;
+         end
+      end
+      else if (~stall) begin
+         if (~last_col) begin
+            addr_reg <= addr_reg + 1;
+            col_reg <= col_reg - 1;
+         end
+         else if (~last_row) begin
+            // next row: back to the left edge, one line down
+            addr_reg <= row_reg + 640;
+            row_reg <= row_reg + 640;
+            col_reg <= w_reg;
+            rows_reg <= rows_reg - 1;
+         end
+         else
+            busy_reg <= 0;
+      end
+   // output
+   assign busy = busy_reg;
+   assign addr_pix = addr_reg;
+   assign wr_data_pix = color_reg;
+   assign write_pix = busy_reg & ~stall;
+endmodule
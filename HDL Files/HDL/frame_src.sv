@@ -10,6 +10,7 @@ module frame_src
     input  logic [18:0] addr_pix,
     input  logic [DW-1:0] wr_data_pix,
     input  logic write_pix,      
+    output logic [DW-1:0] rd_data_pix,   // pixel at addr_pix, 1 clock later
     // pixel output
     output logic [CD-1:0] frame_rgb
    );
@@ -26,7 +27,7 @@ module frame_src
       .clk(clk),
       // write port (to processor) 
       .we(write_pix), .addr_w(addr_pix[18:0]), 
-      .data_w(wr_data_pix[DW-1:0]),
+      .data_w(wr_data_pix[DW-1:0]), .data_rb(rd_data_pix),
       // read port (to read pipe)
       .addr_r(r_addr), .data_r(ram_rd_out_data)
       );
@@ -60,6 +60,7 @@ module mcs_top_complete
    logic [20:0] fp_addr;       
    logic [31:0] fp_wr_data;    
    logic [31:0] fp_rd_data;    
+   logic [31:0] mmio_rd_data, video_rd_data;
    logic fp_video_cs; 
    // pwm 
    logic [7:0] pwm; 
@@ -128,6 +129,8 @@ module mcs_top_complete
     .fp_wr_data(fp_wr_data),
     .fp_rd_data(fp_rd_data)
     );   
+   // read data mux: video or mmio subsystem
+   assign fp_rd_data = fp_video_cs ? video_rd_data : mmio_rd_data;
     
    // instantiated i/o subsystem
    mmio_sys_sampler #(.N_SW(16),.N_LED(16)) mmio_unit (
@@ -138,7 +141,7 @@ module mcs_top_complete
     .mmio_rd(fp_rd),
     .mmio_addr(fp_addr), 
     .mmio_wr_data(fp_wr_data),
-    .mmio_rd_data(fp_rd_data),
+    .mmio_rd_data(mmio_rd_data),
     .acl_ss(acl_ss_n),          
     .*  
    );   
@@ -150,8 +153,10 @@ module mcs_top_complete
      .reset_sys(reset_sys),
      .video_cs(fp_video_cs),
      .video_wr(fp_wr),
+     .video_rd(fp_rd),
      .video_addr(fp_addr),
      .video_wr_data(fp_wr_data),
+     .video_rd_data(video_rd_data),
      .vsync(vsync),
      .hsync(hsync),
      .rgb(rgb)
@@ -5,6 +5,8 @@
 //     - infer 512K simple RAM with 200K wasted   
 //     - better alternative: use 2 ram modules (256K+64K = 320K)       
 //     - required memory = 320K * color depth
+//     - true dual port: write port also reads back (processor),
+//       read port is owned by the scan pipeline
 module vga_ram
    #(parameter DW = 9) // data width 
   (
@@ -13,26 +15,32 @@ module vga_ram
     input  logic [18:0] addr_w, 
     input  logic [18:0] addr_r, 
     input  logic [DW-1:0] data_w,
+    output logic [DW-1:0] data_rb,   // read back at addr_w (1 clock later)
     output logic [DW-1:0] data_r
    );
  
    // signal declaration
    logic [DW-1:0] data_r_256k, data_r_64k;
+   logic [DW-1:0] data_rb_256k, data_rb_64k;
    logic we_256k, we_64k;
+   logic addr_w_18_reg;
    
    // body 
    // instantiate 64K RAM
-   sync_rw_port_ram #(.ADDR_WIDTH(18), .DATA_WIDTH(DW)) ram_256k_unit ( 
-      .clk(clk), .we(we_256k), .addr_w(addr_w[17:0]), .din(data_w),
-      .addr_r(addr_r[17:0]), .dout(data_r_256k)
+   sync_dual_port_ram #(.ADDR_WIDTH(18), .DATA_WIDTH(DW)) ram_256k_unit ( 
+      .clk(clk), .we_a(we_256k), .addr_a(addr_w[17:0]), .din_a(data_w),
+      .dout_a(data_rb_256k), .addr_b(addr_r[17:0]), .dout_b(data_r_256k)
    );
    // instantiate 256K RAM
-   sync_rw_port_ram #(.ADDR_WIDTH(16), .DATA_WIDTH(DW)) ram_64k_unit ( 
-      .clk(clk), .we(we_64k), .addr_w(addr_w[15:0]), .din(data_w),
-      .addr_r(addr_r[15:0]), .dout(data_r_64k)
+   sync_dual_port_ram #(.ADDR_WIDTH(16), .DATA_WIDTH(DW)) ram_64k_unit ( 
+      .clk(clk), .we_a(we_64k), .addr_a(addr_w[15:0]), .din_a(data_w),
+      .dout_a(data_rb_64k), .addr_b(addr_r[15:0]), .dout_b(data_r_64k)
    );
    // read data multiplexing
    assign data_r = (addr_r[18]) ? data_r_64k : data_r_256k;
+   always_ff @(posedge clk)
+      addr_w_18_reg <= addr_w[18];
+   assign data_rb = (addr_w_18_reg) ? data_rb_64k : data_rb_256k;
    // write decoding
    assign we_256k = we & ~addr_w[18];
    assign we_64k  = we & addr_w[18];
@@ -0,0 +1,40 @@
+// true dual-port RAM with one clock
+//  - port a: write and read (read-first)
+//  - port b: read only
+//  - each port has its own address, so neither ever waits for the other
+module sync_dual_port_ram
+   #(
+    parameter ADDR_WIDTH = 10, // number of address bits
+              DATA_WIDTH = 8   // number of bits
+   )
+   (
+    input  logic clk,
+    // port a
+    input  logic we_a,
+    input  logic [ADDR_WIDTH-1:0] addr_a, 
+    input  logic [DATA_WIDTH-1:0] din_a,
+    output logic [DATA_WIDTH-1:0] dout_a,
+    // port b
+    input  logic [ADDR_WIDTH-1:0] addr_b, 
+    output logic [DATA_WIDTH-1:0] dout_b
+   );
+
+   // signal declaration
+   logic [DATA_WIDTH-1:0] ram [0:2**ADDR_WIDTH-1];
+   logic [DATA_WIDTH-1:0] data_a_reg, data_b_reg;
+
+   // body
+   // port a
+   always_ff @(posedge clk)
+   begin
+     if (we_a)
+         ram[addr_a] <= din_a;
+     data_a_reg <= ram[addr_a];
+   end
+   // port b
+   always_ff @(posedge clk)
+     data_b_reg <= ram[addr_b];
+   // output
+   assign dout_a = data_a_reg;
+   assign dout_b = data_b_reg;
+endmodule
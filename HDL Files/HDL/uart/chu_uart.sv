@@ -23,7 +23,7 @@ module chu_uart
 
    // signal declaration
    logic wr_uart, rd_uart, wr_dvsr ;
-   logic tx_full, rx_empty;
+   logic tx_full, tx_empty, rx_empty;
    logic [10:0] dvsr_reg;
    logic [7:0] r_data;
    logic ctrl_reg;
@@ -45,6 +45,7 @@ module chu_uart
    assign wr_uart = (write && cs && (addr[1:0]==2'b10));
    assign rd_uart = (write && cs && (addr[1:0]==2'b11));
    // slot read interface
-   assign rd_data = {22'h000000, tx_full,  rx_empty, r_data};
+   // tx_empty: the tx fifo pops a byte after its stop bit, so empty means idle
+   assign rd_data = {21'h000000, tx_empty, tx_full,  rx_empty, r_data};
 endmodule
 
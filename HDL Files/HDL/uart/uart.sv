@@ -9,13 +9,13 @@ module uart
     input logic rd_uart, wr_uart, rx,
     input logic [7:0] w_data,
     input logic [10:0] dvsr,
-    output logic tx_full, rx_empty, tx,
+    output logic tx_full, tx_empty, rx_empty, tx,
     output logic [7:0] r_data
    );
 
    // signal declaration
    logic tick, rx_done_s_tick, tx_done_tick;
-   logic tx_empty, tx_fifo_not_empty;
+   logic tx_fifo_not_empty;
    logic [7:0] tx_fifo_out, rx_data_out;
 
    //body
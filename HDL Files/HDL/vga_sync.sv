@@ -15,7 +15,9 @@ module vga_sync
     output logic vga_si_ready,
     // to vga monitor
     output logic hsync, vsync,
-    output logic[CD-1:0] rgb
+    output logic[CD-1:0] rgb,
+    // vertical blanking (below the display area)
+    output logic vblank
    );
 
    // localparam declaration
@@ -39,7 +41,7 @@ module vga_sync
    logic[10:0] x, y;
    logic hsync_i, vsync_i, video_on_i;
    logic scan_end;
-   logic vsync_reg, hsync_reg;
+   logic vsync_reg, hsync_reg, vblank_reg;
    logic [CD-1:0] rgb_reg;
    logic vga_si_ready_i;
    
@@ -68,6 +70,7 @@ module vga_sync
    always_ff @(posedge clk) begin
       vsync_reg <= vsync_i;
       hsync_reg <= hsync_i;
+      vblank_reg <= (y >= VD);
       if (video_on_i)
          rgb_reg <= vga_st_in_color;
       else
@@ -113,6 +116,7 @@ module vga_sync
    // output 
    assign hsync = hsync_reg;
    assign vsync = vsync_reg;
+   assign vblank = vblank_reg;
    assign rgb = rgb_reg;
    assign vga_si_ready = vga_si_ready_i;   
 endmodule
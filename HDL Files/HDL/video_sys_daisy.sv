@@ -29,8 +29,10 @@ module video_sys_daisy
    // FPro bus 
    input logic video_cs,
    input logic video_wr,
+   input logic video_rd,
    input logic [20:0] video_addr, 
    input logic [31:0] video_wr_data,
+   output logic [31:0] video_rd_data,
    // to vga monitor  
    output logic vsync, hsync,
    output logic [11:0] rgb 
@@ -49,9 +51,11 @@ module video_sys_daisy
    logic frame_start_d1_reg, frame_start_d2_reg;
    logic inc_d1_reg, inc_d2_reg;
    // frame interface
-   logic frame_wr, frame_cs;
+   logic frame_wr, frame_rd, frame_cs;
    logic [19:0] frame_addr;
-   logic [31:0] frame_wr_data;
+   logic [31:0] frame_wr_data, frame_rd_data;
+   // vertical blanking from vga sync
+   logic vblank;
    // video core slot interface 
    logic [7:0] slot_cs_array;
    logic [7:0] slot_mem_wr_array;
@@ -75,12 +79,16 @@ module video_sys_daisy
    chu_video_controller ctrl_unit (
       .video_cs(video_cs),
       .video_wr(video_wr),
+      .video_rd(video_rd),
       .video_addr(video_addr),
       .video_wr_data(video_wr_data),
+      .video_rd_data(video_rd_data),
       .frame_cs(frame_cs),
       .frame_wr(frame_wr),
+      .frame_rd(frame_rd),
       .frame_addr(frame_addr),
       .frame_wr_data(frame_wr_data),
+      .frame_rd_data(frame_rd_data),
       .slot_cs_array(slot_cs_array),
       .slot_mem_wr_array(slot_mem_wr_array),
       .slot_reg_addr_array(slot_reg_addr_array),
@@ -93,10 +101,13 @@ module video_sys_daisy
       .reset(reset_sys),
       .x(x),
       .y(y),
+      .vblank(vblank),
       .cs(frame_cs),
       .write(frame_wr),
+      .read(frame_rd),
       .addr(frame_addr),
       .wr_data(video_wr_data),
+      .rd_data(frame_rd_data),
       .si_rgb(12'h008),        // blue screen
       .so_rgb(frame_rgb8)
      );
@@ -206,7 +217,8 @@ module video_sys_daisy
       .si_ready(inc),
       .hsync(hsync),
       .vsync(vsync),
-      .rgb(rgb)
+      .rgb(rgb),
+      .vblank(vblank)
    );
 endmodule
 
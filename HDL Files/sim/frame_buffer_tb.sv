@@ -0,0 +1,249 @@
+// testbench of chu_frame_buffer_core with the frame_blit fill engine
+//  - drives the video slot bus as the processor does and keeps a
+//    reference copy of the frame; pixels are checked by reading them
+//    back over the bus (1 clock after the read strobe, address held)
+//  - engine status: signature 0xb1, span fifo present, 16 free entries
+//  - rectangle fills from the registers, register writes ignored while
+//    busy, w=0/h=0 ignored
+//  - processor pixel writes outside the rectangle while a fill runs:
+//    they land and stall the engine, the fill still covers every pixel
+//  - span fifo: 16 queued spans, free entry count, then drained
+//  - 300 random rectangles/spans/pixels against the reference frame
+//  - frame counter: +1 per vblank start
+//  - run (from HDL Files):
+//      xvlog -sv sim/frame_buffer_tb.sv HDL/chu_frame_buffer_core.sv
+//        HDL/frame_blit.sv HDL/frame_src.sv HDL/ram320K.sv
+//        HDL/sync_dual_port_ram.sv HDL/frame_palette.sv HDL/fifo/*.sv
+//      xelab frame_buffer_tb -s fb_tb && xsim fb_tb -runall
+//    or iverilog -g2012 with the same files; prints PASS or the
+//    number of errors
+`timescale 1ns/1ps
+module frame_buffer_tb;
+   // declaration
+   localparam HMAX = 640,
+              VMAX = 480,
+              REG_SPAN = 20'hffff6,
+              REG_SPAN_COLOR = 20'hffff7,
+              REG_X = 20'hffff8,
+              REG_Y = 20'hffff9,
+              REG_W = 20'hffffa,
+              REG_H = 20'hffffb,
+              REG_COLOR = 20'hffffc,
+              REG_GO = 20'hffffd;
+   logic clk, reset;
+   logic [10:0] x, y;
+   logic vblank;
+   logic cs, write, read;
+   logic [19:0] addr;
+   logic [31:0] wr_data, rd_data;
+   logic [11:0] so_rgb;
+   logic [8:0] ref_mem [0:HMAX*VMAX-1];
+   integer errors;
+
+   // unit under test
+   chu_frame_buffer_core #(.CD(12), .DW(9)) uut (
+      .clk(clk), .reset(reset), .x(x), .y(y), .vblank(vblank),
+      .cs(cs), .write(write), .read(read), .addr(addr),
+      .wr_data(wr_data), .rd_data(rd_data),
+      .si_rgb(12'h008), .so_rgb(so_rgb));
+
+   // 100 MHz clock; beam sweeps the frame, one pixel per clock
+   always #5 clk = ~clk;
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         x <= 0;
+         y <= 0;
+      end
+      else if (x == 799) begin
+         x <= 0;
+         y <= (y == 524) ? 0 : y + 1;
+      end
+      else
+         x <= x + 1;
+   assign vblank = (y >= VMAX);
+
+   // bus cycles
+   task automatic bus_wr(input logic [19:0] a, input logic [31:0] d);
+      @(posedge clk);
+      #1 cs = 1; write = 1; addr = a; wr_data = d;
+      @(posedge clk);
+      #1 cs = 0; write = 0;
+   endtask
+
+   task automatic bus_rd(input logic [19:0] a, output logic [31:0] d);
+      @(posedge clk);
+      #1 cs = 1; read = 1; addr = a;
+      @(posedge clk);
+      #1 cs = 0; read = 0;
+      d = rd_data;
+   endtask
+
+   task automatic wait_idle();
+      logic [31:0] s;
+      integer n;
+      n = 0;
+      do begin
+         bus_rd(REG_GO, s);
+         n = n + 1;
+      end while (s[0] && n < 400000);
+      if (s[0]) begin
+         $display("engine still busy");
+         errors = errors + 1;
+      end
+   endtask
+
+   // processor pixel write, also in the reference frame
+   task automatic wr_pix(input integer px, input integer py, input logic [8:0] c);
+      bus_wr(HMAX*py + px, c);
+      ref_mem[HMAX*py + px] = c;
+   endtask
+
+   // rectangle fill after the previous one, as the driver does
+   task automatic fill(input integer rx, input integer ry, input integer w,
+                       input integer h, input logic [8:0] c);
+      wait_idle();
+      bus_wr(REG_X, rx);
+      bus_wr(REG_Y, ry);
+      bus_wr(REG_W, w);
+      bus_wr(REG_H, h);
+      bus_wr(REG_COLOR, c);
+      bus_wr(REG_GO, 0);
+      for (int j = ry; j < ry + h; j++)
+         for (int i = rx; i < rx + w; i++)
+            ref_mem[HMAX*j + i] = c;
+   endtask
+
+   task automatic span(input integer sx, input integer sy, input integer w);
+      bus_wr(REG_SPAN, {3'b0, w[9:0], 19'(HMAX*sy + sx)});
+   endtask
+
+   // compare a rectangle (one pixel wider all around) with the reference
+   task automatic check(input integer rx, input integer ry, input integer w, input integer h);
+      logic [31:0] d;
+      for (int j = ry - 1; j <= ry + h; j++)
+         for (int i = rx - 1; i <= rx + w; i++)
+            if (i >= 0 && i < HMAX && j >= 0 && j < VMAX) begin
+               bus_rd(HMAX*j + i, d);
+               if (d[8:0] !== ref_mem[HMAX*j + i]) begin
+                  if (errors < 20)
+                     $display("pixel (%0d,%0d): %h, expected %h", i, j, d[8:0],
+                              ref_mem[HMAX*j + i]);
+                  errors = errors + 1;
+               end
+            end
+   endtask
+
+   initial begin
+      logic [31:0] s;
+      logic [15:0] cnt;
+      integer rx, ry, w, h, k;
+      logic [8:0] c;
+
+      clk = 0; reset = 1;
+      cs = 0; write = 0; read = 0; addr = 0; wr_data = 0;
+      errors = 0;
+      #20 reset = 0;
+      // known frame content under the test areas
+      for (int j = 0; j < 64; j++)
+         for (int i = 0; i < 64; i++)
+            wr_pix(i, j, 9'(i ^ j));
+      for (int j = VMAX - 8; j < VMAX; j++)
+         for (int i = HMAX - 40; i < HMAX; i++)
+            wr_pix(i, j, 9'h155);
+
+      // status
+      bus_rd(REG_GO, s);
+      if (s[31:24] != 8'hb1 || !s[16] || s[12:8] != 16 || s[0]) begin
+         $display("status %h", s);
+         errors = errors + 1;
+      end
+
+      // rectangle fill; register writes while busy are ignored
+      fill(5, 7, 30, 20, 9'h1c0);
+      bus_wr(REG_COLOR, 9'h007);
+      bus_wr(REG_GO, 0);
+      wait_idle();
+      check(5, 7, 30, 20);
+      fill(0, 0, 0, 10, 9'h0ff);      // w = 0
+      fill(0, 0, 10, 0, 9'h0ff);      // h = 0
+      wait_idle();
+      check(0, 0, 12, 12);
+      fill(HMAX - 33, VMAX - 5, 33, 5, 9'h03f);   // frame corner
+      wait_idle();
+      check(HMAX - 33, VMAX - 5, 33, 5);
+
+      // processor writes while the engine runs
+      fill(100, 100, 200, 100, 9'h038);
+      for (int i = 0; i < 40; i++)
+         wr_pix(10 + i, 300, 9'(i));
+      wait_idle();
+      check(100, 100, 200, 100);
+      check(10, 300, 40, 1);
+
+      // span fifo
+      bus_wr(REG_SPAN_COLOR, 9'h1f8);
+      for (int j = 0; j < 16; j++)
+         span(400 + j, 20 + j, 50 - j);
+      bus_rd(REG_GO, s);
+      if (!s[0] || s[12:8] == 16) begin
+         $display("span fifo status %h", s);
+         errors = errors + 1;
+      end
+      wait_idle();
+      for (int j = 0; j < 16; j++)
+         for (int i = 0; i < 50 - j; i++)
+            ref_mem[HMAX*(20 + j) + 400 + j + i] = 9'h1f8;
+      check(400, 20, 50, 16);
+      bus_rd(REG_GO, s);
+      if (s[12:8] != 16) begin
+         $display("span fifo not drained: %h", s);
+         errors = errors + 1;
+      end
+
+      // random operations
+      for (k = 0; k < 300; k++) begin
+         w = 1 + $urandom % 24;
+         h = 1 + $urandom % 16;
+         rx = $urandom % (HMAX - w);
+         ry = 200 + $urandom % (VMAX - 200 - h);
+         c = $urandom;
+         case ($urandom % 3)
+            0: fill(rx, ry, w, h, c);
+            1: begin
+                  wait_idle();
+                  bus_wr(REG_SPAN_COLOR, c);
+                  span(rx, ry, w);
+                  for (int i = 0; i < w; i++)
+                     ref_mem[HMAX*ry + rx + i] = c;
+               end
+            default: begin
+                  wait_idle();
+                  wr_pix(rx, ry, c);
+               end
+         endcase
+         if (k % 30 == 29) begin
+            wait_idle();
+            check(0, 200, HMAX, VMAX - 200);
+         end
+      end
+
+      // frame counter: +1 at each vblank start
+      bus_rd(20'hffffe, s);
+      cnt = s[15:0];
+      wait (y == VMAX - 1);
+      wait (y == 0);
+      wait (y == VMAX - 1);
+      wait (y == 0);
+      bus_rd(20'hffffe, s);
+      if (s[15:0] != cnt + 2) begin
+         $display("frame count %0d, expected %0d", s[15:0], cnt + 2);
+         errors = errors + 1;
+      end
+
+      if (errors == 0)
+         $display("PASS");
+      else
+         $display("FAIL: %0d errors", errors);
+      $finish;
+   end
+endmodule
@@ -0,0 +1,105 @@
+// testbench of the vga_ram read-back path (sync_dual_port_ram pair)
+//  - port b (scan pipeline) sweeps the 640-by-480 addresses without
+//    pause, one per 4 clocks (25 MHz pixel rate), as in active video
+//  - port a (processor/fill engine) does random writes and read-backs
+//    in the same clocks, in both RAMs (address bit 18 clear and set),
+//    including the address the scan is reading
+//  - data_rb must be the pixel at addr_w one clock later (read-first:
+//    the old value in the clock of a write); data_r must be the pixel
+//    at addr_r one clock later, never held up by port a (checked while
+//    addr_r is held: the bank mux of data_r follows the live address)
+//  - reference: a copy of the RAM updated with each write
+//  - run (from HDL Files):
+//      xvlog -sv sim/vga_ram_tb.sv HDL/ram320K.sv HDL/sync_dual_port_ram.sv
+//      xelab vga_ram_tb -s ram_tb && xsim ram_tb -runall
+//    or iverilog -g2012 with the same files; prints PASS or the
+//    number of errors
+`timescale 1ns/1ps
+module vga_ram_tb;
+   // declaration
+   localparam DW = 9,
+              NPIX = 640*480;
+   logic clk;
+   logic we;
+   logic [18:0] addr_w, addr_r;
+   logic [DW-1:0] data_w, data_rb, data_r;
+   logic [DW-1:0] ref_mem [0:NPIX-1];
+   logic [DW-1:0] exp_rb, exp_r;
+   logic chk_rb, chk_r;
+   integer errors, rb_checked, r_checked;
+
+   // unit under test
+   vga_ram #(.DW(DW)) uut (
+      .clk(clk), .we(we), .addr_w(addr_w), .addr_r(addr_r),
+      .data_w(data_w), .data_rb(data_rb), .data_r(data_r));
+
+   always #5 clk = ~clk;
+
+   // expected outputs of each clock: values before its writes
+   always @(posedge clk) begin
+      exp_rb <= ref_mem[addr_w];
+      exp_r <= ref_mem[addr_r];
+      if (we)
+         ref_mem[addr_w] <= data_w;
+   end
+
+   // compare just before the next edge
+   always @(negedge clk) begin
+      if (chk_rb) begin
+         rb_checked = rb_checked + 1;
+         if (data_rb !== exp_rb) begin
+            if (errors < 20)
+               $display("read-back %h, expected %h", data_rb, exp_rb);
+            errors = errors + 1;
+         end
+      end
+      if (chk_r) begin
+         r_checked = r_checked + 1;
+         if (data_r !== exp_r) begin
+            if (errors < 20)
+               $display("scan %h, expected %h", data_r, exp_r);
+            errors = errors + 1;
+         end
+      end
+   end
+
+   initial begin
+      integer i, k;
+
+      clk = 0; we = 0; addr_w = 0; addr_r = 0; data_w = 0;
+      chk_rb = 0; chk_r = 0;
+      errors = 0; rb_checked = 0; r_checked = 0;
+      // known content: port a writes every pixel, scan not checked yet
+      for (i = 0; i < NPIX; i++) begin
+         @(posedge clk);
+         #1 we = 1; addr_w = i; data_w = DW'(i * 7);
+         ref_mem[i] = DW'(i * 7);
+      end
+      @(posedge clk);
+      #1 we = 0;
+      @(posedge clk);
+      // scan sweeps; port a writes or reads back at random each clock
+      #1 chk_rb = 1;
+      for (k = 0; k < 4 * NPIX + 8; k++) begin
+         addr_r = (k / 4) % NPIX;
+         chk_r = (k % 4 != 0);
+         case ($urandom % 4)
+            0: addr_w = addr_r;                          // same pixel as the scan
+            1: addr_w = 19'h40000 + $urandom % (NPIX - 19'h40000);   // 64K RAM
+            default: addr_w = $urandom % NPIX;
+         endcase
+         we = $urandom % 2;
+         data_w = $urandom;
+         @(posedge clk);
+         #1;
+      end
+      we = 0;
+      @(posedge clk);
+      #1 chk_rb = 0; chk_r = 0;
+      if (errors == 0)
+         $display("PASS: %0d read-backs, %0d scan reads", rb_checked, r_checked);
+      else
+         $display("FAIL: %0d errors", errors);
+      $finish;
+   end
+endmodule
@@ -0,0 +1,125 @@
+/*****************************************************************//**
+ * @file blit_test.cpp
+ *
+ * @brief same frames with and without the fill engine/span fifo
+ *
+ * Description:
+ *  - a random sequence of fills (partly off the frame, some dithered,
+ *    some clears), pixels, horizontal/vertical spans, discs, capsules
+ *    and lines, with pixel/span reads in between
+ *  - the sequence runs once on a FrameCore without the engine
+ *    (host_set_no_blit(1)) and once with it, each from the same random
+ *    frame content written around FrameCore
+ *  - the final frames and every value read must be identical; the bus
+ *    writes of both runs are printed
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include <vector>
+#include "vga_core.h"
+#include "host_test.h"
+
+enum {
+   SEQ_LEN = 3000
+};
+
+static int rnd(int lo, int hi) {
+   return (lo + rand() % (hi - lo + 1));
+}
+
+// random frame content, written around FrameCore
+static void noise(unsigned seed) {
+   srand(seed);
+   for (int i = 0; i < FrameCore::HMAX * FrameCore::VMAX; i++)
+      io_write(FRAME_BASE, i, rand() & 0x1ff);
+}
+
+static void grab(std::vector<uint16_t> &img) {
+   img.resize(FrameCore::HMAX * FrameCore::VMAX);
+   for (int y = 0; y < FrameCore::VMAX; y++)
+      for (int x = 0; x < FrameCore::HMAX; x++)
+         img[y * FrameCore::HMAX + x] = host_frame_pixel(x, y);
+}
+
+// run the sequence of seed; values read go to rd
+static void run(FrameCore *frame, unsigned seed, std::vector<uint16_t> &rd) {
+   uint16_t buf[64];
+   int i, op, x, y, w, h, c, n;
+
+   srand(seed);
+   for (i = 0; i < SEQ_LEN; i++) {
+      op = rnd(0, 99);
+      x = rnd(-40, FrameCore::HMAX + 20);
+      y = rnd(-40, FrameCore::VMAX + 20);
+      c = rnd(0, 0xfff);
+      if (op < 2) {
+         frame->clr_screen(c);
+      } else if (op < 25) {
+         frame->set_dither(rnd(0, 3) == 0);
+         w = rnd(0, 3) ? rnd(1, 40) : rnd(1, 500);
+         h = rnd(0, 3) ? rnd(1, 40) : rnd(1, 400);
+         frame->fillRect(x, y, w, h, c);
+      } else if (op < 45) {
+         frame->wr_pix(x, y, c);
+      } else if (op < 60) {
+         frame->wr_span(x, y, rnd(0, 120), c);
+      } else if (op < 68) {
+         frame->wr_vspan(x, y, rnd(0, 120), c);
+      } else if (op < 78) {
+         frame->fillCircle(x, y, rnd(0, FrameCore::BRUSH_R_MAX + 3), c);
+      } else if (op < 84) {
+         frame->fill_capsule(x, y, x + rnd(-30, 30), y + rnd(-30, 30),
+                             rnd(1, FrameCore::BRUSH_R_MAX), c, rnd(0, 1));
+      } else if (op < 88) {
+         frame->plot_line(x, y, rnd(0, FrameCore::HMAX - 1), rnd(0, FrameCore::VMAX - 1), c);
+      } else if (op < 94) {
+         rd.push_back(frame->rd_pix(x, y));
+      } else {
+         w = rnd(1, 64);
+         n = frame->rd_span(x, y, w, buf);
+         rd.push_back((uint16_t) n);
+         for (int k = 0; k < n && k < w; k++)
+            rd.push_back(buf[k]);
+      }
+   }
+   frame->hw_wait();
+}
+
+int main() {
+   std::vector<uint16_t> img_sw, img_hw, rd_sw, rd_hw;
+   uint64_t w_sw = 0, w_hw = 0;
+   BusCount bus;
+
+   for (unsigned seed = 1; seed <= 4; seed++) {
+      host_set_no_blit(1);
+      noise(seed + 100);
+      FrameCore *sw = new FrameCore(FRAME_BASE);
+      CHECK(!sw->has_blit());
+      bus.start();
+      run(sw, seed, rd_sw);
+      w_sw += bus.writes();
+      grab(img_sw);
+      delete sw;
+
+      host_set_no_blit(0);
+      noise(seed + 100);
+      FrameCore *hw = new FrameCore(FRAME_BASE);
+      CHECK(hw->has_blit() && hw->has_span());
+      bus.start();
+      run(hw, seed, rd_hw);
+      w_hw += bus.writes();
+      grab(img_hw);
+      delete hw;
+
+      CHECK(img_sw == img_hw);
+      CHECK(rd_sw == rd_hw);
+   }
+   printf("  4 x %d operations, %u values read\n", SEQ_LEN, (unsigned) rd_sw.size());
+   printf("  bus writes: %llu without the engine, %llu with it\n",
+          (unsigned long long) w_sw, (unsigned long long) w_hw);
+   return (test_result("blit_test"));
+}
@@ -0,0 +1,179 @@
+/*****************************************************************//**
+ * @file dab_bench.cpp
+ *
+ * @brief bus writes and line/span setups per brush dab (fillCircle)
+ *
+ * Description:
+ *  - old: the original Adafruit path, fillCircle() ->
+ *    fillCircleHelper() -> one writeLine() per column
+ *  - rows: FrameCore::fillCircle() row spans (cached table) without
+ *    the fill engine, then with the span fifo
+ *  - for radius 1 to 20 (the pot's brush sizes): each dab is drawn
+ *    on a white area; both paths must cover the same pixels
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include "vga_core.h"
+#include "host_test.h"
+
+static const uint32_t BASE = FRAME_BASE;
+static int old_lines;   // writeLine() calls (Bresenham setups)
+
+static void old_wr_pix(int x, int y, int color) {
+   io_write(BASE, FrameCore::HMAX * y + x, color);
+}
+
+// original Adafruit writeLine()
+static void old_write_line(int x0, int y0, int x1, int y1, int color) {
+   int steep = abs(y1 - y0) > abs(x1 - x0);
+   int t, dx, dy, err, ystep;
+
+   old_lines++;
+   if (steep) {
+      t = x0; x0 = y0; y0 = t;
+      t = x1; x1 = y1; y1 = t;
+   }
+   if (x0 > x1) {
+      t = x0; x0 = x1; x1 = t;
+      t = y0; y0 = y1; y1 = t;
+   }
+   dx = x1 - x0;
+   dy = abs(y1 - y0);
+   err = dx / 2;
+   ystep = (y0 < y1) ? 1 : -1;
+   for (; x0 <= x1; x0++) {
+      if (steep)
+         old_wr_pix(y0, x0, color);
+      else
+         old_wr_pix(x0, y0, color);
+      err -= dy;
+      if (err < 0) {
+         y0 += ystep;
+         err += dx;
+      }
+   }
+}
+
+static void old_vline(int x, int y, int h, int color) {
+   old_write_line(x, y, x, y + h - 1, color);
+}
+
+// original fillCircle()/fillCircleHelper(), both corners
+static void old_fill_circle(int x0, int y0, int r, int color) {
+   int f = 1 - r;
+   int ddF_x = 1;
+   int ddF_y = -2 * r;
+   int x = 0;
+   int y = r;
+   int px = x;
+   int py = y;
+
+   old_vline(x0, y0 - r, 2 * r + 1, color);
+   while (x < y) {
+      if (f >= 0) {
+         y--;
+         ddF_y += 2;
+         f += ddF_y;
+      }
+      x++;
+      ddF_x += 2;
+      f += ddF_x;
+      if (x < (y + 1)) {
+         old_vline(x0 + x, y0 - y, 2 * y + 1, color);
+         old_vline(x0 - x, y0 - y, 2 * y + 1, color);
+      }
+      if (y != py) {
+         old_vline(x0 + py, y0 - px, 2 * px + 1, color);
+         old_vline(x0 - py, y0 - px, 2 * px + 1, color);
+         py = y;
+      }
+      px = x;
+   }
+}
+
+enum {
+   CX = 320,
+   CY = 240,
+   BOX = 2 * FrameCore::BRUSH_R_MAX + 3
+};
+
+static uint16_t area[BOX][BOX];
+
+// white box under the dab; written around the FrameCore instances so
+// their tile tables never take the box for uniform
+static void clear_box(void) {
+   for (int j = 0; j < BOX; j++)
+      for (int i = 0; i < BOX; i++)
+         old_wr_pix(CX - BOX / 2 + i, CY - BOX / 2 + j, FrameCore::pack9(0xfff));
+}
+
+static void grab(void) {
+   for (int j = 0; j < BOX; j++)
+      for (int i = 0; i < BOX; i++)
+         area[j][i] = host_frame_pixel(CX - BOX / 2 + i, CY - BOX / 2 + j);
+}
+
+static int same_as_grab(void) {
+   for (int j = 0; j < BOX; j++)
+      for (int i = 0; i < BOX; i++)
+         if (area[j][i] != host_frame_pixel(CX - BOX / 2 + i, CY - BOX / 2 + j))
+            return (0);
+   return (1);
+}
+
+int main() {
+   const uint16_t BLACK = FrameCore::pack9(0x001);
+   uint64_t w_old, w_rows, w_fifo, sum_old = 0, sum_rows = 0, sum_fifo = 0;
+   int lines, pixels;
+   BusCount bus;
+
+   host_set_no_blit(1);
+   FrameCore *sw = new FrameCore(FRAME_BASE);
+   CHECK(!sw->has_blit());   // probed now, while the engine is absent
+   host_set_no_blit(0);
+   FrameCore *hw = new FrameCore(FRAME_BASE);
+   CHECK(hw->has_span());
+   printf("  r   old writes lines   rows writes spans   span fifo writes\n");
+   for (int r = 1; r <= FrameCore::BRUSH_R_MAX; r++) {
+      clear_box();
+      old_lines = 0;
+      bus.start();
+      old_fill_circle(CX, CY, r, BLACK);
+      w_old = bus.writes();
+      lines = old_lines;
+      grab();
+      pixels = 0;
+      for (int j = 0; j < BOX; j++)
+         for (int i = 0; i < BOX; i++)
+            pixels += (area[j][i] == BLACK);
+
+      clear_box();
+      bus.start();
+      sw->fillCircle(CX, CY, r, 0x001);
+      w_rows = bus.writes();
+      CHECK(same_as_grab());
+
+      clear_box();
+      bus.start();
+      hw->fillCircle(CX, CY, r, 0x001);
+      hw->hw_wait();
+      w_fifo = bus.writes();
+      CHECK(same_as_grab());
+
+      // rows path writes each disc pixel once
+      CHECK(w_rows == (uint64_t) pixels);
+      printf("  %2d  %10llu %5d   %11llu %5d   %16llu\n", r, (unsigned long long) w_old,
+             lines, (unsigned long long) w_rows, 2 * r + 1, (unsigned long long) w_fifo);
+      sum_old += w_old;
+      sum_rows += w_rows;
+      sum_fifo += w_fifo;
+   }
+   printf("  all  %9llu         %11llu         %16llu\n", (unsigned long long) sum_old,
+          (unsigned long long) sum_rows, (unsigned long long) sum_fifo);
+   delete sw;
+   delete hw;
+   return (test_result("dab_bench"));
+}
@@ -0,0 +1,155 @@
+/*****************************************************************//**
+ * @file fill_bench.cpp
+ *
+ * @brief bus writes and cycles per clear/rectangle fill (FrameCore)
+ *
+ * Description:
+ *  - old: column-wise clr_screen() (wr_pix() with a multiply per
+ *    pixel) and fillRect() as one Bresenham writeLine() per column,
+ *    as in the original driver
+ *  - span: FrameCore row spans without the fill engine
+ *    (host_set_no_blit(1)); also a second clear to the same color
+ *    (tiles already uniform)
+ *  - engine: FrameCore with the fill engine
+ *  - cycles are virtual (bus accesses plus engine time); host ns is
+ *    the wall time per pixel of the driver loop and the bus model, a
+ *    rough measure of the per-pixel work the old loops add
+ *  - every case checks the frame content afterward
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <chrono>
+#include "vga_core.h"
+#include "host_test.h"
+
+static const uint32_t BASE = FRAME_BASE;
+
+// original FrameCore::wr_pix()/clr_screen(): x outer, y inner
+static void old_wr_pix(int x, int y, int color) {
+   uint32_t pix_offset;
+
+   pix_offset = FrameCore::HMAX * y + x;
+   io_write(BASE, pix_offset, color);
+}
+
+static void old_clr_screen(int color) {
+   for (int x = 0; x < FrameCore::HMAX; x++)
+      for (int y = 0; y < FrameCore::VMAX; y++)
+         old_wr_pix(x, y, color);
+}
+
+// original Adafruit writeLine() (used for every vertical line)
+static void old_write_line(int x0, int y0, int x1, int y1, int color) {
+   int steep = abs(y1 - y0) > abs(x1 - x0);
+   int t, dx, dy, err, ystep;
+
+   if (steep) {
+      t = x0; x0 = y0; y0 = t;
+      t = x1; x1 = y1; y1 = t;
+   }
+   if (x0 > x1) {
+      t = x0; x0 = x1; x1 = t;
+      t = y0; y0 = y1; y1 = t;
+   }
+   dx = x1 - x0;
+   dy = abs(y1 - y0);
+   err = dx / 2;
+   ystep = (y0 < y1) ? 1 : -1;
+   for (; x0 <= x1; x0++) {
+      if (steep)
+         old_wr_pix(y0, x0, color);
+      else
+         old_wr_pix(x0, y0, color);
+      err -= dy;
+      if (err < 0) {
+         y0 += ystep;
+         err += dx;
+      }
+   }
+}
+
+static void old_fill_rect(int x, int y, int w, int h, int color) {
+   for (int i = x; i < x + w; i++)
+      old_write_line(i, y, i, y + h - 1, color);
+}
+
+// every pixel of the rectangle has the (9-bit) color
+static int frame_is(int x, int y, int w, int h, uint16_t pix) {
+   for (int j = y; j < y + h; j++)
+      for (int i = x; i < x + w; i++)
+         if (host_frame_pixel(i, j) != pix)
+            return (0);
+   return (1);
+}
+
+struct Result {
+   uint64_t writes, cycles;
+   double ns_pix;
+};
+
+static void report(const char *what, Result r) {
+   printf("  %-34s %8llu writes %9llu cycles %6.1f host ns/pixel\n", what,
+          (unsigned long long) r.writes, (unsigned long long) r.cycles, r.ns_pix);
+}
+
+// run op; count bus writes and cycles until the frame is written
+template<typename Op>
+static Result measure(FrameCore *frame, int n_pix, Op op) {
+   BusCount bus;
+   Result r;
+
+   auto t0 = std::chrono::steady_clock::now();
+   op();
+   if (frame)
+      frame->hw_wait();
+   auto t1 = std::chrono::steady_clock::now();
+   r.writes = bus.writes();
+   r.cycles = bus.cycles();
+   r.ns_pix = std::chrono::duration<double, std::nano>(t1 - t0).count() / n_pix;
+   return (r);
+}
+
+int main() {
+   const int N = FrameCore::HMAX * FrameCore::VMAX;
+   const int RX = 100, RY = 70, RW = 440, RH = 340;   // the canvas
+   Result old_clr, span_clr, same_clr, hw_clr, old_rect, span_rect, hw_rect;
+
+   host_set_no_blit(1);
+   FrameCore *sw = new FrameCore(FRAME_BASE);
+   old_clr = measure(0, N, [] { old_clr_screen(0x0f0); });
+   CHECK(frame_is(0, 0, FrameCore::HMAX, FrameCore::VMAX, 0x0f0));
+   span_clr = measure(sw, N, [&] { sw->clr_screen(0xfff); });
+   CHECK(frame_is(0, 0, FrameCore::HMAX, FrameCore::VMAX, FrameCore::pack9(0xfff)));
+   same_clr = measure(sw, N, [&] { sw->clr_screen(0xfff); });
+   CHECK(same_clr.writes == 0);
+   old_rect = measure(0, RW * RH, [&] { old_fill_rect(RX, RY, RW, RH, 0x00f); });
+   CHECK(frame_is(RX, RY, RW, RH, 0x00f));
+   span_rect = measure(sw, RW * RH, [&] { sw->fillRect(RX, RY, RW, RH, 0xf00); });
+   CHECK(frame_is(RX, RY, RW, RH, FrameCore::pack9(0xf00)));
+   CHECK(span_clr.writes == (uint64_t) N && span_rect.writes == (uint64_t) (RW * RH));
+
+   host_set_no_blit(0);
+   FrameCore *hw = new FrameCore(FRAME_BASE);
+   CHECK(hw->has_blit());
+   hw_clr = measure(hw, N, [&] { hw->clr_screen(0x888); });
+   CHECK(frame_is(0, 0, FrameCore::HMAX, FrameCore::VMAX, FrameCore::pack9(0x888)));
+   hw_rect = measure(hw, RW * RH, [&] { hw->fillRect(RX, RY, RW, RH, 0x0f0); });
+   CHECK(frame_is(RX, RY, RW, RH, FrameCore::pack9(0x0f0)));
+   CHECK(frame_is(0, 0, FrameCore::HMAX, RY, FrameCore::pack9(0x888)));
+
+   printf("clear (640x480):\n");
+   report("old column-wise wr_pix()", old_clr);
+   report("span path, no engine", span_clr);
+   report("span path, same color again", same_clr);
+   report("fill engine", hw_clr);
+   printf("fillRect (440x340):\n");
+   report("old writeLine() per column", old_rect);
+   report("span path, no engine", span_rect);
+   report("fill engine", hw_rect);
+   delete sw;
+   delete hw;
+   return (test_result("fill_bench"));
+}
@@ -0,0 +1,151 @@
+/*****************************************************************//**
+ * @file flood_bench.cpp
+ *
+ * @brief bucket fill time and run stack use (FloodFill::fill())
+ *
+ * Description:
+ *  - inputs on the 440-by-340 canvas: blank, 1-pixel spiral, comb,
+ *    checkerboards (1-pixel cells: the seed cell alone; 8-pixel cells
+ *    with 6-pixel black squares: a lattice of 2-pixel corridors), dot
+ *    grid, and the dot grid left of a wall with one pixel of the fill
+ *    color from before on the right
+ *  - time is virtual (bus accesses and engine, SYS_CLK_FREQ), up to
+ *    hw_wait() after the fill; host us is the wall time of the driver
+ *    and the model, a rough measure of the CPU work
+ *  - peak: largest # run stack entries; dropped: runs recovered by
+ *    rescans after the stack was full
+ *  - every fill's pixel count must match a reference 4-connected fill
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <chrono>
+#include <vector>
+#include "flood.h"
+#include "host_test.h"
+
+enum {
+   HMAX = FrameCore::HMAX,
+   CX0 = 100,   // canvas
+   CY0 = 70,
+   CX1 = 539,
+   CY1 = 409
+};
+
+// # pixels of the 4-connected region of (x, y) inside the canvas
+static int ref_count(int x, int y) {
+   std::vector<uint8_t> seen(HMAX * FrameCore::VMAX, 0);
+   std::vector<int> q;
+   uint16_t old_pix = host_frame_pixel(x, y);
+
+   seen[y * HMAX + x] = 1;
+   q.push_back(y * HMAX + x);
+   for (size_t h = 0; h < q.size(); h++) {
+      int px = q[h] % HMAX, py = q[h] / HMAX;
+      const int dx[4] = {1, -1, 0, 0}, dy[4] = {0, 0, 1, -1};
+      for (int k = 0; k < 4; k++) {
+         int nx = px + dx[k], ny = py + dy[k];
+         if (nx < CX0 || nx > CX1 || ny < CY0 || ny > CY1 || seen[ny * HMAX + nx]
+               || host_frame_pixel(nx, ny) != old_pix)
+            continue;
+         seen[ny * HMAX + nx] = 1;
+         q.push_back(ny * HMAX + nx);
+      }
+   }
+   return ((int) q.size());
+}
+
+static void canvas(FrameCore *frame) {
+   frame->fillRect(CX0, CY0, CX1 - CX0 + 1, CY1 - CY0 + 1, 0xfff);
+}
+
+static void dots(FrameCore *frame, int x_end) {
+   for (int y = CY0 + 1; y < CY1; y += 2)
+      for (int x = CX0 + 1 + (y & 2); x < x_end; x += 4)
+         frame->wr_pix(x, y, 0x001);
+}
+
+static void bench(FrameCore *frame, FloodFill *flood, const char *name, int x, int y,
+                  int color) {
+   BusCount bus;
+   int n, n_ref;
+
+   frame->hw_wait();
+   n_ref = ref_count(x, y);
+   bus.start();
+   auto t0 = std::chrono::steady_clock::now();
+   n = flood->fill(x, y, color);
+   frame->hw_wait();
+   auto t1 = std::chrono::steady_clock::now();
+   CHECK(n == n_ref);
+   printf("  %-24s %6d px %7.2f ms %7.0f host us %8llu rd %7llu wr  peak %3d  dropped %5d\n",
+          name, n, bus.cycles() / (SYS_CLK_FREQ * 1000.0),
+          std::chrono::duration<double, std::micro>(t1 - t0).count(),
+          (unsigned long long) bus.reads(), (unsigned long long) bus.writes(), flood->peak(),
+          flood->dropped());
+}
+
+int main() {
+   int x, y, l, t, r, b;
+
+   host_set_no_blit(0);
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+   FloodFill *flood = new FloodFill(frame);
+   flood->set_clip(CX0, CY0, CX1, CY1);
+   frame->clr_screen(0xA8B);
+
+   canvas(frame);
+   bench(frame, flood, "blank", 320, 240, 0x0f0);
+
+   // square spiral wall of 1-pixel width
+   canvas(frame);
+   l = CX0 + 1, t = CY0 + 1, r = CX1 - 1, b = CY1 - 1;
+   while (r - l > 4 && b - t > 4) {
+      frame->wr_span(l, t, r - l + 1, 0x001);
+      frame->wr_vspan(r, t, b - t + 1, 0x001);
+      frame->wr_span(l, b, r - l + 1, 0x001);
+      frame->wr_vspan(l, t + 2, b - t - 1, 0x001);
+      l += 2;
+      t += 2;
+      r -= 2;
+      b -= 2;
+      frame->wr_pix(l - 1, t, 0x001);
+      frame->wr_pix(l - 1, t - 1, 0xfff);   // opening of the next turn
+   }
+   bench(frame, flood, "spiral (1 px)", CX0 + 3, CY0 + 3, 0xf00);
+
+   // comb: teeth from the top and the bottom, alternating
+   canvas(frame);
+   for (x = CX0 + 4; x < CX1 - 4; x += 4)
+      frame->wr_vspan(x, (x & 4) ? CY0 : CY0 + 3, CY1 - CY0 - 2, 0x001);
+   bench(frame, flood, "comb", CX0 + 1, CY0 + 1, 0x00f);
+
+   canvas(frame);
+   for (y = CY0; y <= CY1; y++)
+      for (x = CX0 + ((y ^ CX0) & 1); x <= CX1; x += 2)
+         frame->wr_pix(x, y, 0x001);
+   bench(frame, flood, "checkerboard 1 px", CX0 + 1, CY0, 0x0f0);
+
+   canvas(frame);
+   for (y = CY0; y <= CY1 - 6; y += 8)
+      for (x = CX0 + ((y / 8) & 1) * 8; x <= CX1 - 6; x += 16)
+         frame->fillRect(x, y, 6, 6, 0x001);
+   bench(frame, flood, "checkerboard 8 px", CX1, CY1, 0x0f0);
+
+   canvas(frame);
+   dots(frame, CX1);
+   bench(frame, flood, "dot grid", CX0, CY0, 0xf00);
+
+   // overflow on the left of a wall, a pixel of the fill color on the right
+   canvas(frame);
+   frame->wr_vspan(320, CY0, CY1 - CY0 + 1, 0x001);
+   dots(frame, 318);
+   frame->wr_pix(430, 240, 0xf00);
+   bench(frame, flood, "dots | old fill color", CX0 + 1, CY0 + 1, 0xf00);
+   CHECK(host_frame_pixel(431, 240) == FrameCore::pack9(0xfff));
+   delete flood;
+   delete frame;
+   return (test_result("flood_bench"));
+}
@@ -0,0 +1,229 @@
+/*****************************************************************//**
+ * @file flood_test.cpp
+ *
+ * @brief FloodFill::fill() against a reference 4-connected fill
+ *
+ * Description:
+ *  - reference: breadth-first fill of a copy of the frame, same clip
+ *    rectangle (the canvas)
+ *  - each case checks the frame and the pixel count fill() returns
+ *  - cases: blank canvas, 1-pixel spiral, comb, dot grid (run stack
+ *    overflows), random blobs from many seeds, seed outside the clip
+ *    or already of the fill color
+ *  - stack overflow next to a separate region holding a pixel of the
+ *    fill color from before: the rescan must not seed there
+ *  - stack overflow around 1-pixel pockets whose edge has a pixel of
+ *    the fill color from before, in tiles the fill writes: the pockets
+ *    stay unfilled; with more such tiles than PRE_SLOTS, the fill may
+ *    stop short but must fill nothing outside the region
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include <vector>
+#include "flood.h"
+#include "host_test.h"
+
+enum {
+   HMAX = FrameCore::HMAX,
+   VMAX = FrameCore::VMAX,
+   CX0 = 100,   // canvas
+   CY0 = 70,
+   CX1 = 539,
+   CY1 = 409
+};
+
+static std::vector<uint16_t> img;
+
+static void grab(std::vector<uint16_t> &v) {
+   v.resize(HMAX * VMAX);
+   for (int y = 0; y < VMAX; y++)
+      for (int x = 0; x < HMAX; x++)
+         v[y * HMAX + x] = host_frame_pixel(x, y);
+}
+
+// reference fill of img; return # pixels filled
+static int ref_fill(int x, int y, int color) {
+   std::vector<int> q;
+   uint16_t old_pix, new_pix = FrameCore::pack9(color);
+   int n = 0;
+
+   if (x < CX0 || x > CX1 || y < CY0 || y > CY1)
+      return (0);
+   old_pix = img[y * HMAX + x];
+   if (old_pix == new_pix)
+      return (0);
+   img[y * HMAX + x] = new_pix;
+   q.push_back(y * HMAX + x);
+   for (size_t h = 0; h < q.size(); h++) {
+      int px = q[h] % HMAX, py = q[h] / HMAX;
+      const int dx[4] = {1, -1, 0, 0}, dy[4] = {0, 0, 1, -1};
+      n++;
+      for (int k = 0; k < 4; k++) {
+         int nx = px + dx[k], ny = py + dy[k];
+         if (nx < CX0 || nx > CX1 || ny < CY0 || ny > CY1 || img[ny * HMAX + nx] != old_pix)
+            continue;
+         img[ny * HMAX + nx] = new_pix;
+         q.push_back(ny * HMAX + nx);
+      }
+   }
+   return (n);
+}
+
+// fill both ways and compare; print the result if name is given
+static void run(FrameCore *frame, FloodFill *flood, const char *name, int x, int y,
+                int color) {
+   std::vector<uint16_t> out;
+   int n, n_ref;
+
+   frame->hw_wait();   // drawing done before the reference copy
+   grab(img);
+   n_ref = ref_fill(x, y, color);
+   n = flood->fill(x, y, color);
+   frame->hw_wait();
+   grab(out);
+   CHECK(n == n_ref);
+   CHECK(out == img);
+   if (name)
+      printf("  %-26s %6d px  peak %3d  dropped %5d\n", name, n, flood->peak(),
+             flood->dropped());
+}
+
+static void canvas(FrameCore *frame) {
+   frame->fillRect(CX0, CY0, CX1 - CX0 + 1, CY1 - CY0 + 1, 0xfff);
+}
+
+// square spiral wall of 1-pixel width
+static void spiral(FrameCore *frame) {
+   int l = CX0 + 1, t = CY0 + 1, r = CX1 - 1, b = CY1 - 1;
+
+   canvas(frame);
+   while (r - l > 4 && b - t > 4) {
+      frame->wr_span(l, t, r - l + 1, 0x001);
+      frame->wr_vspan(r, t, b - t + 1, 0x001);
+      frame->wr_span(l, b, r - l + 1, 0x001);
+      frame->wr_vspan(l, t + 2, b - t - 1, 0x001);
+      l += 2;
+      t += 2;
+      r -= 2;
+      b -= 2;
+      frame->wr_pix(l - 1, t, 0x001);
+      frame->wr_pix(l - 1, t - 1, 0xfff);   // opening of the next turn
+   }
+}
+
+// fill; every pixel changed must be in the reference region
+static void run_no_leak(FrameCore *frame, FloodFill *flood, const char *name, int x, int y,
+                        int color) {
+   std::vector<uint16_t> before, out;
+   int n, n_ref, leak = 0;
+
+   frame->hw_wait();
+   grab(img);
+   before = img;
+   n_ref = ref_fill(x, y, color);
+   n = flood->fill(x, y, color);
+   frame->hw_wait();
+   grab(out);
+   for (size_t k = 0; k < out.size(); k++)
+      leak += (out[k] != before[k] && out[k] != img[k]);
+   CHECK(leak == 0);
+   CHECK(n <= n_ref);
+   printf("  %-26s %6d px  peak %3d  dropped %5d  (%d px short)\n", name, n, flood->peak(),
+          flood->dropped(), n_ref - n);
+}
+
+// dot grid with pockets every step pixels: a white pixel boxed in
+// black, with a red pixel above it
+static void pockets(FrameCore *frame, int step) {
+   int x, y;
+
+   canvas(frame);
+   for (y = CY0 + 1; y < CY1; y += 2)
+      for (x = CX0 + 1 + (y & 2); x < CX1; x += 4)
+         frame->wr_pix(x, y, 0x001);
+   for (y = CY0 + 20; y < CY1 - 20; y += step) {
+      for (x = CX0 + 20; x < CX1 - 20; x += step) {
+         frame->fillRect(x - 1, y - 1, 3, 3, 0x001);
+         frame->wr_pix(x, y, 0xfff);
+         frame->wr_pix(x, y - 1, 0xf00);
+      }
+   }
+}
+
+int main() {
+   int x, y, i;
+
+   host_set_no_blit(0);
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+   FloodFill *flood = new FloodFill(frame);
+   flood->set_clip(CX0, CY0, CX1, CY1);
+   frame->clr_screen(0xA8B);
+
+   canvas(frame);
+   run(frame, flood, "blank canvas", 320, 240, 0x0f0);
+
+   spiral(frame);
+   run(frame, flood, "spiral", CX0 + 3, CY0 + 3, 0xf00);
+
+   // comb: teeth from the top and the bottom, alternating
+   canvas(frame);
+   for (x = CX0 + 4; x < CX1 - 4; x += 4)
+      frame->wr_vspan(x, (x & 4) ? CY0 : CY0 + 3, CY1 - CY0 - 2, 0x001);
+   run(frame, flood, "comb", CX0 + 1, CY0 + 1, 0x00f);
+
+   // dot grid: many short runs, the run stack overflows
+   canvas(frame);
+   for (y = CY0 + 1; y < CY1; y += 2)
+      for (x = CX0 + 1 + (y & 2); x < CX1; x += 4)
+         frame->wr_pix(x, y, 0x001);
+   run(frame, flood, "dot grid", CX0, CY0, 0xf00);
+   CHECK(flood->dropped() > 0);
+
+   // overflow on the left of a wall; on the right, one pixel of the
+   // fill color from before and white around it
+   canvas(frame);
+   frame->wr_vspan(320, CY0, CY1 - CY0 + 1, 0x001);
+   for (y = CY0 + 1; y < CY1; y += 2)
+      for (x = CX0 + 1 + (y & 2); x < 318; x += 4)
+         frame->wr_pix(x, y, 0x001);
+   frame->wr_pix(430, 240, 0xf00);
+   run(frame, flood, "dots | old fill color", CX0 + 1, CY0 + 1, 0xf00);
+   CHECK(flood->dropped() > 0);
+   CHECK(host_frame_pixel(431, 240) == FrameCore::pack9(0xfff));
+   CHECK(host_frame_pixel(321, CY0) == FrameCore::pack9(0xfff));
+   // the lone pixel's region: the 1 pixel itself is already red
+   run(frame, flood, "lone pixel, same color", 430, 240, 0xf00);
+
+   // pockets in 80 tiles (fewer than PRE_SLOTS), then in 234
+   pockets(frame, 40);
+   run(frame, flood, "dots, 80 red-edged pockets", CX0, CY0, 0xf00);
+   CHECK(flood->dropped() > 0);
+   CHECK(host_frame_pixel(CX0 + 20, CY0 + 20) == FrameCore::pack9(0xfff));
+   pockets(frame, 24);
+   run_no_leak(frame, flood, "dots, 234 pockets", CX0, CY0, 0xf00);
+
+   // random blobs, filled from many seeds
+   canvas(frame);
+   srand(3);
+   for (i = 0; i < 400; i++)
+      frame->fillCircle(CX0 + rand() % 440, CY0 + rand() % 340, 2 + rand() % 12,
+                        (rand() & 1) ? 0x001 : 0x00f);
+   for (i = 0; i < 40; i++) {
+      x = CX0 + rand() % 440;
+      y = CY0 + rand() % 340;
+      run(frame, flood, i ? 0 : "random blobs, first of 40", x, y, (i & 1) ? 0x0f0 : 0xff0);
+   }
+
+   // no fill
+   CHECK(flood->fill(CX0 - 1, CY0, 0x0f0) == 0);
+   CHECK(flood->fill(CX0, CY1 + 1, 0x0f0) == 0);
+   canvas(frame);
+   CHECK(flood->fill(CX0, CY0, 0xfff) == 0);
+   delete flood;
+   delete frame;
+   return (test_result("flood_test"));
+}
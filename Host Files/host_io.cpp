@@ -0,0 +1,987 @@
+/*****************************************************************//**
+ * @file host_io.cpp
+ *
+ * @brief software models of the FPro MMIO and video subsystems
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "host_io.h"
+#include "chu_io_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <string>
+
+/**********************************************************************
+ * virtual time and statistics
+ *********************************************************************/
+static uint64_t cycles = 0;        // system clock count
+static int io_cycles = 4;          // cycles per bus access
+static uint64_t rd_cnt = 0;
+static uint64_t wr_cnt = 0;
+
+static void script_poll();
+
+// charge one bus access and run due script events
+static void tick() {
+   cycles = cycles + io_cycles;
+   script_poll();
+}
+
+void host_set_io_cycles(int n) {
+   io_cycles = n;
+}
+
+uint64_t host_cycles() {
+   return (cycles);
+}
+
+uint64_t host_io_reads() {
+   return (rd_cnt);
+}
+
+uint64_t host_io_writes() {
+   return (wr_cnt);
+}
+
+/**********************************************************************
+ * timer (slot 0): 48-bit counter, go/clear control
+ *********************************************************************/
+static struct {
+   int go;
+   uint64_t base;     // cycle count at last clear
+   uint64_t frozen;   // count while paused
+} timer = {0, 0, 0};
+
+static uint64_t timer_count() {
+   return (timer.go ? cycles - timer.base : timer.frozen);
+}
+
+static uint32_t timer_read(int reg) {
+   uint64_t count = timer_count() & 0xffffffffffffULL;
+
+   return ((reg & 1) ? (uint32_t) (count >> 32) : (uint32_t) count);
+}
+
+static void timer_write(int reg, uint32_t data) {
+   if ((reg & 3) != 2)
+      return;
+   if (data & 0x02) {           // clear pulse
+      timer.base = cycles;
+      timer.frozen = 0;
+   }
+   if ((data & 0x01) && !timer.go)
+      timer.base = cycles - timer.frozen;
+   if (!(data & 0x01) && timer.go)
+      timer.frozen = cycles - timer.base;
+   timer.go = data & 0x01;
+}
+
+/**********************************************************************
+ * uart (slot 1): 256-byte fifos; tx drains at the programmed baud rate;
+ * a file queued by the script arrives at the baud rate (bytes that
+ * find the rx fifo full are lost)
+ *********************************************************************/
+static struct {
+   uint32_t dvsr;
+   std::deque<uint8_t> rx;
+   std::deque<uint8_t> tx;
+   uint64_t tx_next;   // cycle count when head of tx fifo is sent
+   std::deque<uint8_t> rx_line;   // bytes still on the line
+   uint64_t rx_next;   // cycle count when head of rx_line arrives
+   uint64_t rx_lost;   // bytes dropped at a full rx fifo
+} uart_m = {650, {}, {}, 0, {}, 0, 0};
+
+enum { UART_FIFO_SIZE = 256 };
+
+static void uart_drain() {
+   // 10 bits per byte, 16 ticks per bit
+   uint64_t byte_cycles = 160ULL * (uart_m.dvsr + 1);
+
+   while (!uart_m.tx.empty() && cycles >= uart_m.tx_next) {
+      fputc(uart_m.tx.front(), stdout);
+      uart_m.tx.pop_front();
+      uart_m.tx_next = uart_m.tx_next + byte_cycles;
+   }
+   while (!uart_m.rx_line.empty() && cycles >= uart_m.rx_next) {
+      if (uart_m.rx.size() < UART_FIFO_SIZE)
+         uart_m.rx.push_back(uart_m.rx_line.front());
+      else
+         uart_m.rx_lost++;
+      uart_m.rx_line.pop_front();
+      uart_m.rx_next = uart_m.rx_next + byte_cycles;
+   }
+   if (uart_m.tx.empty())
+      fflush(stdout);
+}
+
+static uint32_t uart_read(int reg) {
+   uint32_t data = 0;
+
+   if (reg != 0)
+      return (0);
+   uart_drain();
+   if (uart_m.rx.empty())
+      data = data | 0x100;
+   else
+      data = data | uart_m.rx.front();
+   if (uart_m.tx.size() >= UART_FIFO_SIZE)
+      data = data | 0x200;
+   if (uart_m.tx.empty())
+      data = data | 0x400;   // the head byte stays in the fifo until sent
+   return (data);
+}
+
+static void uart_write(int reg, uint32_t data) {
+   switch (reg) {
+   case 1:
+      uart_m.dvsr = data & 0x7ff;
+      break;
+   case 2:
+      uart_drain();
+      if (uart_m.tx.size() >= UART_FIFO_SIZE)
+         break;          // fifo full; byte lost as in hardware
+      if (uart_m.tx.empty())
+         uart_m.tx_next = cycles + 160ULL * (uart_m.dvsr + 1);
+      uart_m.tx.push_back((uint8_t) data);
+      break;
+   case 3:
+      if (!uart_m.rx.empty())
+         uart_m.rx.pop_front();
+      break;
+   }
+}
+
+void host_uart_push(uint8_t byte) {
+   if (uart_m.rx.size() < UART_FIFO_SIZE)
+      uart_m.rx.push_back(byte);
+}
+
+/**********************************************************************
+ * gpio (slots 2/3/7), pwm (slot 6), sseg (slot 8)
+ *********************************************************************/
+static uint32_t led_reg = 0;
+static uint32_t sw_reg = 0;
+static uint32_t btn_reg = 0;
+static uint32_t pwm_reg[32];
+static uint32_t sseg_reg[2];
+
+/**********************************************************************
+ * xadc (slot 5): 16-bit readings, 12 MSBs used
+ *  - reg 6: DRP write status (signature 0xa7, never pending);
+ *    reg 7: DRP write; only the averaging field of config register
+ *    0x40 is modeled
+ *  - host_xadc_noise(): each read adds uniform noise, reduced by the
+ *    on-chip averaging (16: 1/4, 64: 1/8, 256: 1/16)
+ *********************************************************************/
+static uint16_t xadc_reg[6] = {0x8000, 0x8000, 0, 0, 0x9a00, 0x5500};
+static int xadc_noise[6];
+static int xadc_avg = 0;
+static uint32_t xadc_seed = 1;
+
+void host_xadc_set(int ch, int value) {
+   if (ch >= 0 && ch < 6)
+      xadc_reg[ch] = (uint16_t) ((value & 0xfff) << 4);
+}
+
+void host_xadc_noise(int ch, int amp) {
+   if (ch >= 0 && ch < 6)
+      xadc_noise[ch] = (amp < 0) ? 0 : amp;
+}
+
+static uint32_t xadc_read(int reg) {
+   int ch, amp, v;
+
+   ch = reg & 7;
+   if (ch == 6)
+      return (0xa7000000);
+   if (ch == 7)
+      ch = 5;
+   amp = (xadc_avg == 0) ? xadc_noise[ch] : xadc_noise[ch] >> (xadc_avg + 1);
+   if (amp == 0)
+      return (xadc_reg[ch]);
+   xadc_seed = xadc_seed * 1103515245 + 12345;
+   v = (xadc_reg[ch] >> 4) + (int) ((xadc_seed >> 16) % (2 * amp + 1)) - amp;
+   v = (v < 0) ? 0 : (v > 4095) ? 4095 : v;
+   return ((uint32_t) v << 4);
+}
+
+static void xadc_write(int reg, uint32_t data) {
+   if ((reg & 7) == 7 && ((data >> 16) & 0x7f) == 0x40)
+      xadc_avg = (data >> 12) & 3;
+}
+
+/**********************************************************************
+ * spi (slot 9) with an ADXL362 accelerometer on ss_n[0]
+ *  - a transfer takes 8 sclk periods: 16*(dvsr+1) system clocks
+ *  - 16-entry tx/rx fifos (reg 4/5): queued bytes go out back to
+ *    back; the byte read by each lands in the rx fifo when its
+ *    transfer ends (HOST_NO_SPI_FIFO=1 models the core without them)
+ *  - in measurement mode, the reading set by host_acl_set() is
+ *    sampled at the output data rate into a 512-entry fifo
+ *    (stream and oldest-saved modes, x/y/z entries only) and checked
+ *    for activity (absolute or referenced; the reference is taken
+ *    when detection is enabled and when activity is detected)
+ *  - STATUS: activity and fifo overrun (both cleared by reading
+ *    STATUS), data ready; FIFO_ENTRIES follows the fifo
+ *********************************************************************/
+enum {
+   SPI_FIFO_SIZE = 16
+};
+
+static struct {
+   uint32_t ctrl;
+   uint32_t ss_n;
+   uint8_t rx;
+   uint64_t busy_until;
+   int absent;                            // HOST_NO_SPI_FIFO
+   std::deque<uint8_t> txq;               // queued, not started
+   std::deque<uint8_t> rxq;               // read back by queued bytes
+   std::deque<uint64_t> rx_at;            // ... available from
+} spi_m = {0x200, 0xffffffff, 0, 0, 0, {}, {}, {}};
+
+enum {
+   ACL_WR_CMD = 0x0a,
+   ACL_RD_CMD = 0x0b,
+   ACL_FIFO_CMD = 0x0d,
+   ACL_FIFO_SIZE = 512,
+   ACL_ST_DATA = 0x01,
+   ACL_ST_OVERRUN = 0x08,
+   ACL_ST_ACT = 0x10
+};
+
+static struct {
+   uint8_t reg[64];
+   int state;           // 0: command; 1: address; 2: data
+   uint8_t cmd;
+   uint8_t addr;
+   int v[3];            // current acceleration
+   std::deque<uint16_t> fifo;
+   int hi;              // fifo read: high byte of the entry being read; -1 none
+   uint64_t next;       // next sample time
+   int ref[3];          // activity reference
+   int ref_ok;
+   int act_cnt;         // consecutive samples above threshold
+} acl;
+
+static void acl_reset() {
+   memset(acl.reg, 0, sizeof(acl.reg));
+   acl.reg[0x00] = 0xad;   // DEVID_AD
+   acl.reg[0x01] = 0x1d;   // DEVID_MST
+   acl.reg[0x02] = 0xf2;   // PARTID
+   acl.reg[0x03] = 0x01;   // REVID
+   acl.reg[0x2c] = 0x13;   // FILTER_CTL
+   acl.state = 0;
+   acl.fifo.clear();
+   acl.hi = -1;
+   acl.ref_ok = 0;
+   acl.act_cnt = 0;
+   host_acl_set(acl.v[0], acl.v[1], acl.v[2]);   // data registers keep the reading
+}
+
+static void acl_update();
+
+void host_acl_set(int x, int y, int z) {
+   int v[3] = {x, y, z};
+
+   acl_update();   // samples due so far see the old reading
+   for (int i = 0; i < 3; i++) {
+      acl.v[i] = v[i];
+      acl.reg[0x08 + i] = (uint8_t) (v[i] >> 4);           // 8 MSBs
+      acl.reg[0x0e + 2 * i] = (uint8_t) v[i];              // 12-bit, LSB
+      acl.reg[0x0f + 2 * i] = (uint8_t) ((v[i] >> 8) & 0x0f);
+      if (v[i] < 0)
+         acl.reg[0x0f + 2 * i] |= 0xf0;                    // sign extension
+   }
+}
+
+// one sample at the output data rate
+static void acl_sample() {
+   int mode = acl.reg[0x28] & 0x03;
+   int ctl = acl.reg[0x27];
+   int thresh = acl.reg[0x20] | ((acl.reg[0x21] & 0x07) << 8);
+   int over = 0;
+
+   acl.reg[0x0b] |= ACL_ST_DATA;
+   for (int i = 0; i < 3 && mode != 0; i++) {
+      if (acl.fifo.size() >= ACL_FIFO_SIZE) {
+         acl.reg[0x0b] |= ACL_ST_OVERRUN;
+         if (mode == 1)
+            break;                // oldest saved: new samples are lost
+         acl.fifo.pop_front();
+      }
+      acl.fifo.push_back((uint16_t) ((i << 14) | (acl.v[i] & 0x3fff)));
+   }
+   if (!(ctl & 0x01))
+      return;
+   if ((ctl & 0x02) && !acl.ref_ok) {
+      memcpy(acl.ref, acl.v, sizeof(acl.ref));
+      acl.ref_ok = 1;
+   }
+   for (int i = 0; i < 3; i++) {
+      int d = (ctl & 0x02) ? acl.v[i] - acl.ref[i] : acl.v[i];
+      if (d > thresh || -d > thresh)
+         over = 1;
+   }
+   acl.act_cnt = over ? acl.act_cnt + 1 : 0;
+   if (acl.act_cnt > 0 && acl.act_cnt >= acl.reg[0x22]) {
+      acl.reg[0x0b] |= ACL_ST_ACT;
+      acl.act_cnt = 0;
+      memcpy(acl.ref, acl.v, sizeof(acl.ref));
+   }
+}
+
+// catch up with the samples due by now
+static void acl_update() {
+   // 12.5 Hz * 2^odr
+   uint64_t period = (uint64_t) (SYS_CLK_FREQ * 1000000.0 / (12.5 * (1 << (acl.reg[0x2c] & 0x07))));
+
+   if ((acl.reg[0x2d] & 0x03) != 0x02) {
+      acl.next = cycles + period;   // standby
+      return;
+   }
+   while (cycles >= acl.next) {
+      acl_sample();
+      acl.next = acl.next + period;
+   }
+}
+
+// one byte exchanged with the accelerometer
+static uint8_t acl_transfer(uint8_t mosi) {
+   uint8_t miso = 0;
+   int n;
+
+   acl_update();
+   switch (acl.state) {
+   case 0:
+      acl.cmd = mosi;
+      acl.state = (mosi == ACL_FIFO_CMD) ? 2 : 1;
+      acl.hi = -1;
+      break;
+   case 1:
+      acl.addr = mosi & 0x3f;
+      acl.state = 2;
+      break;
+   default:
+      if (acl.cmd == ACL_FIFO_CMD) {
+         if (acl.hi >= 0) {
+            miso = (uint8_t) acl.hi;
+            acl.hi = -1;
+         } else if (!acl.fifo.empty()) {
+            miso = (uint8_t) acl.fifo.front();
+            acl.hi = acl.fifo.front() >> 8;
+            acl.fifo.pop_front();
+         }
+         break;
+      }
+      if (acl.cmd == ACL_RD_CMD) {
+         n = (int) acl.fifo.size();
+         acl.reg[0x0c] = (uint8_t) n;
+         acl.reg[0x0d] = (uint8_t) (n >> 8);
+         miso = acl.reg[acl.addr];
+         if (acl.addr == 0x0b)
+            acl.reg[0x0b] &= ~(ACL_ST_ACT | ACL_ST_OVERRUN);
+      } else if (acl.cmd == ACL_WR_CMD) {
+         if (acl.addr == 0x1f && mosi == 0x52) {
+            acl_reset();   // soft reset
+            return (0);
+         }
+         if (acl.addr >= 0x1f)
+            acl.reg[acl.addr] = mosi;
+         if (acl.addr == 0x27)
+            acl.ref_ok = 0;   // detection restarts
+         if (acl.addr == 0x28 && (mosi & 0x03) == 0)
+            acl.fifo.clear(); // fifo off
+      }
+      acl.addr = (acl.addr + 1) & 0x3f;   // auto increment
+      break;
+   }
+   return (miso);
+}
+
+// start queued bytes whose turn came by now
+static void spi_update() {
+   uint8_t miso;
+
+   while (!spi_m.txq.empty() && cycles >= spi_m.busy_until) {
+      miso = (spi_m.ss_n & 1) ? 0xff : acl_transfer(spi_m.txq.front());
+      spi_m.txq.pop_front();
+      spi_m.rx = miso;
+      // back to back with the previous byte, or now if the wire was idle
+      if (spi_m.busy_until < cycles)
+         spi_m.busy_until = cycles;
+      spi_m.busy_until = spi_m.busy_until + 16ULL * ((spi_m.ctrl & 0xffff) + 1);
+      if (spi_m.rxq.size() < SPI_FIFO_SIZE) {
+         spi_m.rxq.push_back(miso);
+         spi_m.rx_at.push_back(spi_m.busy_until);
+      }
+   }
+}
+
+// # rx fifo entries whose transfer has ended
+static int spi_rx_count() {
+   int n = 0;
+
+   while (n < (int) spi_m.rx_at.size() && spi_m.rx_at[n] <= cycles)
+      n++;
+   return (n);
+}
+
+static uint32_t spi_read(int reg) {
+   int ready, n;
+
+   spi_update();
+   ready = (cycles >= spi_m.busy_until && spi_m.txq.empty()) ? 1 : 0;
+   if (reg == 4 && !spi_m.absent) {
+      n = spi_rx_count();
+      return (0x5f000000 | (n << 16) | ((SPI_FIFO_SIZE - spi_m.txq.size()) << 8) 
+              | (n > 0 ? spi_m.rxq.front() : 0));
+   }
+   if (reg != 0)
+      return (0);
+   return ((uint32_t) (ready << 8) | spi_m.rx);
+}
+
+static void spi_write(int reg, uint32_t data) {
+   spi_update();
+   switch (reg & 7) {
+   case 1:
+      if ((data & 1) && !(spi_m.ss_n & 1))
+         acl.state = 0;            // ss_n de-asserted: end of transaction
+      spi_m.ss_n = data;
+      break;
+   case 2:
+      if (cycles < spi_m.busy_until)
+         break;                    // transfer in progress; ignored
+      spi_m.rx = (spi_m.ss_n & 1) ? 0xff : acl_transfer((uint8_t) data);
+      spi_m.busy_until = cycles + 16ULL * ((spi_m.ctrl & 0xffff) + 1);
+      break;
+   case 3:
+      spi_m.ctrl = data;
+      break;
+   case 4:
+      if (!spi_m.absent && spi_rx_count() > 0) {
+         spi_m.rxq.pop_front();
+         spi_m.rx_at.pop_front();
+      }
+      break;
+   case 5:
+      if (!spi_m.absent && spi_m.txq.size() < SPI_FIFO_SIZE) {
+         spi_m.txq.push_back((uint8_t) data);
+         spi_update();             // starts now if the wire is idle
+      }
+      break;
+   }
+}
+
+void host_set_no_spi_fifo(int absent) {
+   spi_update();
+   spi_m.absent = absent;
+}
+
+/**********************************************************************
+ * ps2 (slot 11) with a stream-mode mouse
+ *  - each byte takes about 1 ms to arrive, so packets can be
+ *    observed half-received
+ *********************************************************************/
+enum {
+   PS2_FIFO_SIZE = 256,
+   PS2_BYTE_CYCLES = SYS_CLK_FREQ * 1000   // 1 ms per byte
+};
+
+static struct {
+   std::deque<uint8_t> fifo;                 // bytes received
+   std::deque<uint8_t> wire;                 // bytes still in transit
+   uint64_t next_arrival;
+} ps2_m;
+
+static void ps2_update() {
+   while (!ps2_m.wire.empty() && cycles >= ps2_m.next_arrival) {
+      if (ps2_m.fifo.size() < PS2_FIFO_SIZE)
+         ps2_m.fifo.push_back(ps2_m.wire.front());
+      ps2_m.wire.pop_front();
+      ps2_m.next_arrival = ps2_m.next_arrival + PS2_BYTE_CYCLES;
+   }
+}
+
+void host_ps2_push(uint8_t byte) {
+   ps2_update();
+   if (ps2_m.wire.empty())
+      ps2_m.next_arrival = cycles + PS2_BYTE_CYCLES;
+   ps2_m.wire.push_back(byte);
+}
+
+void host_mouse_packet(int dx, int dy, int lbtn, int rbtn) {
+   uint8_t b1;
+
+   b1 = 0x08 | (lbtn ? 0x01 : 0) | (rbtn ? 0x02 : 0);
+   if (dx < 0)
+      b1 = b1 | 0x10;
+   if (dy < 0)
+      b1 = b1 | 0x20;
+   host_ps2_push(b1);
+   host_ps2_push((uint8_t) dx);
+   host_ps2_push((uint8_t) dy);
+}
+
+// mouse responses to host commands
+static void ps2_command(uint8_t cmd) {
+   host_ps2_push(0xfa);             // acknowledge
+   if (cmd == 0xff) {               // reset: self-test passed, mouse id
+      host_ps2_push(0xaa);
+      host_ps2_push(0x00);
+   }
+}
+
+static uint32_t ps2_read(int reg) {
+   uint32_t data = 0x200;         // transmitter always idle
+
+   if (reg != 0)
+      return (0);
+   ps2_update();
+   if (ps2_m.fifo.empty())
+      data = data | 0x100;
+   else
+      data = data | ps2_m.fifo.front();
+   return (data);
+}
+
+static void ps2_write(int reg, uint32_t data) {
+   ps2_update();
+   if (reg == 1)
+      ps2_command((uint8_t) data);
+   else if (reg == 2 && !ps2_m.fifo.empty())
+      ps2_m.fifo.pop_front();
+}
+
+/**********************************************************************
+ * mmio subsystem: 64 slots of 32 registers
+ *********************************************************************/
+static uint32_t mmio_read(int slot, int reg) {
+   switch (slot) {
+   case S0_SYS_TIMER:
+      return (timer_read(reg));
+   case S1_UART1:
+      return (uart_read(reg));
+   case S3_SW:
+      return (sw_reg);
+   case S5_XDAC:
+      return (xadc_read(reg));
+   case S7_BTN:
+      return (btn_reg);
+   case S9_SPI:
+      return (spi_read(reg));
+   case S11_PS2:
+      return (ps2_read(reg));
+   default:
+      return (0);
+   }
+}
+
+static void mmio_write(int slot, int reg, uint32_t data) {
+   switch (slot) {
+   case S0_SYS_TIMER:
+      timer_write(reg, data);
+      break;
+   case S1_UART1:
+      uart_write(reg, data);
+      break;
+   case S2_LED:
+      led_reg = data;
+      break;
+   case S5_XDAC:
+      xadc_write(reg, data);
+      break;
+   case S6_PWM:
+      pwm_reg[reg] = data;
+      break;
+   case S8_SSEG:
+      sseg_reg[reg & 1] = data;
+      break;
+   case S9_SPI:
+      spi_write(reg, data);
+      break;
+   case S11_PS2:
+      ps2_write(reg, data);
+      break;
+   default:
+      break;
+   }
+}
+
+/**********************************************************************
+ * video subsystem
+ *  - frame buffer: 640*480 9-bit pixels, bypass register at 0xfffff,
+ *    status register (frame count/vblank) at 0xffffe, fill engine
+ *    registers at 0xffff8-0xffffd, span fifo at 0xffff6/0xffff7
+ *    (one pixel per clock; a processor pixel write takes the clock);
+ *    pixels read back at their addresses
+ *  - slot 2 (osd): 80-by-30 tile ram, bypass/fg/bg registers
+ *  - slots 1/3 (sprites): 1024-word ram, bypass/x/y/ctrl registers
+ *  - other slots: bypass register only
+ *********************************************************************/
+enum {
+   FRAME_H = 640,
+   FRAME_V = 480,
+   // 25 MHz pixel clock: 4 system clocks per pixel, 800-by-525 scan
+   LINE_CYCLES = 800 * 4,
+   FRAME_CYCLES = 525 * LINE_CYCLES,
+   VBLANK_START = FRAME_V * LINE_CYCLES
+};
+
+static uint16_t frame_ram[FRAME_H * FRAME_V];
+static uint32_t frame_bypass = 0;
+
+static struct {
+   uint32_t ram[1 << 12];
+   uint32_t reg[4];      // bypass, x/fg, y/bg, ctrl
+} vslot[8];
+
+// fill engine of chu_frame_buffer_core (frame_blit) and its
+// 16-entry span command fifo
+enum {
+   SPAN_FIFO_SIZE = 16
+};
+
+static struct {
+   uint32_t reg[5];      // x, y, w, h, color
+   uint32_t span_color;
+   int busy;
+   uint32_t w, color;    // latched at start
+   uint32_t addr, row;   // current pixel, start of current row
+   uint32_t col, rows;   // pixels left in row, rows left
+   uint64_t last;        // cycle count the engine has run up to
+   uint32_t q[SPAN_FIFO_SIZE][3];   // addr, length, color
+   int q_head, q_cnt;
+   int absent;           // HOST_NO_BLIT: model a bitstream without it
+} blit;
+
+static void blit_start(uint32_t addr, uint32_t w, uint32_t h, uint32_t color) {
+   if (w == 0 || h == 0)
+      return;
+   blit.busy = 1;
+   blit.row = addr;
+   blit.addr = addr;
+   blit.w = w;
+   blit.col = w;
+   blit.rows = h;
+   blit.color = color;
+}
+
+// run the engine up to cycle count t
+static void blit_run(uint64_t t) {
+   uint32_t *c;
+
+   while (blit.last < t) {
+      if (!blit.busy) {
+         if (blit.q_cnt == 0)
+            break;
+         // idle with a queued span: start it (takes one clock)
+         c = blit.q[blit.q_head];
+         blit.q_head = (blit.q_head + 1) % SPAN_FIFO_SIZE;
+         blit.q_cnt--;
+         blit_start(c[0], c[1], 1, c[2]);
+         blit.last++;
+         continue;
+      }
+      blit.last++;
+      if (blit.addr < FRAME_H * FRAME_V)
+         frame_ram[blit.addr] = (uint16_t) blit.color;
+      if (blit.col > 1) {
+         blit.addr++;
+         blit.col--;
+      } else if (blit.rows > 1) {
+         blit.row = blit.row + FRAME_H;
+         blit.addr = blit.row;
+         blit.col = blit.w;
+         blit.rows--;
+      } else {
+         blit.busy = 0;
+      }
+   }
+   if (blit.last < t)
+      blit.last = t;
+}
+
+static void blit_write(uint32_t addr, uint32_t data) {
+   uint32_t *c;
+
+   blit_run(cycles);
+   if (blit.absent)
+      return;
+   if (addr == 7) {
+      blit.span_color = data & 0x1ff;
+   } else if (addr == 6) {
+      if (blit.q_cnt == SPAN_FIFO_SIZE)
+         return;               // full fifo drops the command
+      c = blit.q[(blit.q_head + blit.q_cnt) % SPAN_FIFO_SIZE];
+      c[0] = data & 0x7ffff;
+      c[1] = (data >> 19) & 0x3ff;
+      c[2] = blit.span_color;
+      blit.q_cnt++;
+   } else if (blit.busy || blit.q_cnt > 0) {
+      return;                  // registers ignored while busy
+   } else if (addr >= 8 && addr < 13) {
+      blit.reg[addr - 8] = data & ((addr == 12) ? 0x1ff : 0x3ff);
+   } else if (addr == 13) {
+      blit_start((blit.reg[1] & 0x1ff) * FRAME_H + blit.reg[0],
+                 blit.reg[2], blit.reg[3], blit.reg[4]);
+   }
+}
+
+void host_set_no_blit(int absent) {
+   blit_run(cycles);
+   blit.absent = absent;
+}
+
+static uint32_t blit_status() {
+   blit_run(cycles);
+   return (0xb1000000 | 0x00010000 | ((SPAN_FIFO_SIZE - blit.q_cnt) << 8)
+           | ((blit.busy || blit.q_cnt > 0) ? 1 : 0));
+}
+
+static void frame_write(uint32_t addr, uint32_t data) {
+   if (addr == 0xfffff)
+      frame_bypass = data & 1;
+   else if ((addr & 0xffff0) == 0xffff0)
+      blit_write(addr & 0xf, data);
+   else if (addr < FRAME_H * FRAME_V) {
+      blit_run(cycles - 1);
+      blit.last = cycles;      // processor write has priority this clock
+      frame_ram[addr] = (uint16_t) (data & 0x1ff);   // wr_data[8:0] latched
+   }
+}
+
+// read-back port: the processor takes the clock from the fill engine
+static uint32_t frame_read(uint32_t addr) {
+   blit_run(cycles - 1);
+   blit.last = cycles;
+   if (addr < FRAME_H * FRAME_V)
+      return (frame_ram[addr]);
+   return (0);
+}
+
+static void vslot_write(int slot, uint32_t addr, uint32_t data) {
+   if (addr & 0x2000)
+      vslot[slot].reg[addr & 3] = data;
+   else
+      vslot[slot].ram[addr & 0xfff] = data;
+}
+
+// status register of chu_frame_buffer_core: {vblank, frame_cnt[15:0]}
+static uint32_t frame_status() {
+   uint64_t pos = cycles % FRAME_CYCLES;
+   uint64_t cnt = (cycles + (FRAME_CYCLES - VBLANK_START)) / FRAME_CYCLES;
+   uint32_t vblank = (pos >= VBLANK_START) ? 1 : 0;
+
+   return ((vblank << 16) | (uint32_t) (cnt & 0xffff));
+}
+
+uint16_t host_frame_pixel(int x, int y) {
+   blit_run(cycles);
+   if (x < 0 || x >= FRAME_H || y < 0 || y >= FRAME_V)
+      return (0);
+   return (frame_ram[y * FRAME_H + x]);
+}
+
+int host_frame_dump_ppm(const char *fname) {
+   FILE *fp;
+   uint16_t p;
+   uint8_t rgb[3];
+
+   fp = fopen(fname, "wb");
+   if (!fp)
+      return (-1);
+   blit_run(cycles);
+   fprintf(fp, "P6\n%d %d\n255\n", FRAME_H, FRAME_V);
+   for (int i = 0; i < FRAME_H * FRAME_V; i++) {
+      p = frame_ram[i];
+      // frame_palette_9: 3-bit channel a expands to {a, a[2]}
+      for (int ch = 0; ch < 3; ch++) {
+         int a = (p >> (6 - 3 * ch)) & 0x07;
+         int c4 = (a << 1) | (a >> 2);
+         rgb[ch] = (uint8_t) (c4 * 17);
+      }
+      fwrite(rgb, 1, 3, fp);
+   }
+   fclose(fp);
+   return (0);
+}
+
+/**********************************************************************
+ * bus decoding (chu_mcs_bridge, chu_mmio_controller, chu_video_controller)
+ *********************************************************************/
+uint32_t host_io_read(uint32_t addr) {
+   uint32_t fp_addr;
+
+   rd_cnt++;
+   tick();
+   if ((addr >> 24) != (BRIDGE_BASE >> 24))
+      return (0);
+   fp_addr = (addr >> 2) & 0x1fffff;
+   if (addr & 0x00800000) {
+      // video subsystem: only the frame buffer core is readable
+      if (!(fp_addr & 0x100000))
+         return (0);
+      if ((fp_addr & 0xffff0) != 0xffff0)
+         return (frame_read(fp_addr & 0xfffff));
+      if ((fp_addr & 0xfffff) == 0xffffd && !blit.absent)
+         return (blit_status());
+      return (frame_status());
+   }
+   return (mmio_read((fp_addr >> 5) & 0x3f, fp_addr & 0x1f));
+}
+
+void host_io_write(uint32_t addr, uint32_t data) {
+   uint32_t fp_addr;
+
+   wr_cnt++;
+   tick();
+   if ((addr >> 24) != (BRIDGE_BASE >> 24))
+      return;
+   fp_addr = (addr >> 2) & 0x1fffff;
+   if (!(addr & 0x00800000))
+      mmio_write((fp_addr >> 5) & 0x3f, fp_addr & 0x1f, data);
+   else if (fp_addr & 0x100000)
+      frame_write(fp_addr & 0xfffff, data);
+   else
+      vslot_write((fp_addr >> 14) & 0x07, fp_addr & 0x3fff, data);
+}
+
+/**********************************************************************
+ * event script
+ *********************************************************************/
+static struct {
+   int loaded;
+   FILE *fp;
+   uint64_t next;      // cycle count of pending event
+   char line[256];     // pending event (after the time stamp)
+   uint64_t limit;     // HOST_RUN_MS limit; 0 if none
+} script = {0, 0, 0, "", 0};
+
+static void host_quit() {
+   uart_m.tx_next = 0;   // flush pending uart output
+   uart_drain();
+   fprintf(stderr, "host: %.3f ms, %llu reads, %llu writes\n",
+           (double) cycles / (SYS_CLK_FREQ * 1000.0),
+           (unsigned long long) rd_cnt, (unsigned long long) wr_cnt);
+   if (uart_m.rx_lost)
+      fprintf(stderr, "host: %llu uart rx bytes lost (fifo full)\n",
+              (unsigned long long) uart_m.rx_lost);
+   exit(0);
+}
+
+// read next event line; return 0 at end of script
+static int script_next() {
+   char buf[300];
+   double ms;
+   int n;
+
+   while (script.fp && fgets(buf, sizeof(buf), script.fp)) {
+      if (buf[0] == '#' || sscanf(buf, "%lf %n", &ms, &n) < 1)
+         continue;
+      strncpy(script.line, buf + n, sizeof(script.line) - 1);
+      script.line[strcspn(script.line, "\r\n")] = '\0';
+      script.next = (uint64_t) (ms * SYS_CLK_FREQ * 1000.0);
+      return (1);
+   }
+   return (0);
+}
+
+static void script_run(char *ev) {
+   char cmd[16], arg[256];
+   int a, b, c, d, n;
+   unsigned int h;
+
+   arg[0] = '\0';
+   if (sscanf(ev, "%15s %n", cmd, &n) < 1)
+      return;
+   strncpy(arg, ev + n, sizeof(arg) - 1);
+   arg[sizeof(arg) - 1] = '\0';
+   if (!strcmp(cmd, "mouse") && sscanf(arg, "%d %d %d %d", &a, &b, &c, &d) == 4) {
+      host_mouse_packet(a, b, c, d);
+   } else if (!strcmp(cmd, "ps2")) {
+      char *p = arg;
+      while (sscanf(p, "%x%n", &h, &n) == 1) {
+         host_ps2_push((uint8_t) h);
+         p = p + n;
+      }
+   } else if (!strcmp(cmd, "adc") && sscanf(arg, "%d %d", &a, &b) == 2) {
+      host_xadc_set(a, b);
+   } else if (!strcmp(cmd, "adcnoise") && sscanf(arg, "%d %d", &a, &b) == 2) {
+      host_xadc_noise(a, b);
+   } else if (!strcmp(cmd, "acl") && sscanf(arg, "%d %d %d", &a, &b, &c) == 3) {
+      host_acl_set(a, b, c);
+   } else if (!strcmp(cmd, "sw") && sscanf(arg, "%x", &h) == 1) {
+      sw_reg = h;
+   } else if (!strcmp(cmd, "btn") && sscanf(arg, "%x", &h) == 1) {
+      btn_reg = h;
+   } else if (!strcmp(cmd, "uart")) {
+      for (char *p = arg; *p; p++)
+         host_uart_push((uint8_t) *p);
+      host_uart_push('\r');
+   } else if (!strcmp(cmd, "uartfile")) {
+      FILE *fp = fopen(arg, "rb");
+      if (!fp) {
+         fprintf(stderr, "host: cannot open %s\n", arg);
+         return;
+      }
+      if (uart_m.rx_line.empty())
+         uart_m.rx_next = cycles;
+      while ((a = fgetc(fp)) != EOF)
+         uart_m.rx_line.push_back((uint8_t) a);
+      fclose(fp);
+   } else if (!strcmp(cmd, "dump")) {
+      if (host_frame_dump_ppm(arg) != 0)
+         fprintf(stderr, "host: cannot write %s\n", arg);
+   } else if (!strcmp(cmd, "stats")) {
+      fprintf(stderr, "host: %.3f ms, %llu reads, %llu writes\n",
+              (double) cycles / (SYS_CLK_FREQ * 1000.0),
+              (unsigned long long) rd_cnt, (unsigned long long) wr_cnt);
+   } else if (!strcmp(cmd, "quit")) {
+      host_quit();
+   } else {
+      fprintf(stderr, "host: unknown event '%s'\n", ev);
+   }
+}
+
+static void script_poll() {
+   if (!script.loaded) {
+      const char *fname = getenv("HOST_SCRIPT");
+      const char *lim = getenv("HOST_RUN_MS");
+      const char *cyc = getenv("HOST_IO_CYCLES");
+      const char *noblit = getenv("HOST_NO_BLIT");
+      const char *nospi = getenv("HOST_NO_SPI_FIFO");
+
+      script.loaded = 1;
+      acl_reset();
+      if (lim)
+         script.limit = (uint64_t) (atof(lim) * SYS_CLK_FREQ * 1000.0);
+      if (cyc)
+         io_cycles = atoi(cyc);
+      if (noblit)
+         blit.absent = atoi(noblit);
+      if (nospi)
+         spi_m.absent = atoi(nospi);
+      if (fname) {
+         script.fp = fopen(fname, "r");
+         if (!script.fp)
+            fprintf(stderr, "host: cannot open %s\n", fname);
+      }
+      if (!script_next() && script.fp) {
+         fclose(script.fp);
+         script.fp = 0;
+      }
+   }
+   while (script.fp && cycles >= script.next) {
+      script_run(script.line);
+      if (!script_next()) {
+         fclose(script.fp);
+         script.fp = 0;
+      }
+   }
+   if (script.limit && cycles >= script.limit)
+      host_quit();
+}
@@ -0,0 +1,152 @@
+/*****************************************************************//**
+ * @file host_io.h
+ *
+ * @brief host (Linux) replacement of the MMIO bus
+ *
+ * Description:
+ *  - selected by defining _HOST_IO_USED (see chu_io_rw.h)
+ *  - io_read_raw()/io_write_raw() call software models instead of
+ *    dereferencing the MicroBlaze I/O addresses
+ *  - addresses are decoded the same way as chu_mcs_bridge and the
+ *    mmio/video controllers do
+ *  - models: timer, uart, led/sw/btn, xadc (DRP averaging), pwm, sseg, spi (ADXL362
+ *    with fifo and activity detection),
+ *    ps2 (mouse), frame buffer, osd and sprite/gpv video slots
+ *  - time is virtual: each bus access advances the system clock by
+ *    a fixed # of cycles (host_set_io_cycles())
+ *  - stimulus and checkpoints come from an event script
+ *    (file named by HOST_SCRIPT environment variable)
+ *
+ * Event script format (one event per line, '#' starts a comment):
+ *   <ms> mouse <dx> <dy> <lbtn> <rbtn>  queue a 3-byte mouse packet
+ *   <ms> ps2 <hex byte> ...             queue raw ps2 bytes
+ *   <ms> adc <ch> <value>               set xadc channel (12-bit value)
+ *   <ms> adcnoise <ch> <amp>            add +/-amp LSB noise to a channel
+ *   <ms> acl <x> <y> <z>                set accelerometer (12-bit, 1 mg/LSB)
+ *   <ms> sw <hex value>                 set switches
+ *   <ms> btn <hex value>                set buttons
+ *   <ms> uart <text>                    queue text in uart rx fifo
+ *   <ms> uartfile <file>                send a file to the uart at the baud rate
+ *   <ms> dump <file.ppm>                dump frame buffer
+ *   <ms> stats                          print bus statistics to stderr
+ *   <ms> quit                           exit the program
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _HOST_IO_H_INCLUDED
+#define _HOST_IO_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * read an io register (host model).
+ * @param addr byte address on the MicroBlaze I/O bus
+ * @return 32-bit data of the register
+ */
+uint32_t host_io_read(uint32_t addr);
+
+/**
+ * write an io register (host model).
+ * @param addr byte address on the MicroBlaze I/O bus
+ * @param data 32-bit data
+ */
+void host_io_write(uint32_t addr, uint32_t data);
+
+// same interface as the default raw macros in chu_io_rw.h
+#define io_read_raw(base_addr, offset) \
+   host_io_read((uint32_t) ((base_addr) + 4*(offset)))
+
+#define io_write_raw(base_addr, offset, data) \
+   host_io_write((uint32_t) ((base_addr) + 4*(offset)), (uint32_t) (data))
+
+/**********************************************************************
+ * model control (used by event script and host-only test code)
+ *********************************************************************/
+/**
+ * set # system clock cycles charged per bus access
+ * @param n cycles per access (default 4)
+ */
+void host_set_io_cycles(int n);
+
+/**
+ * current virtual system clock count
+ */
+uint64_t host_cycles();
+
+/**
+ * total # bus reads/writes since start
+ */
+uint64_t host_io_reads();
+uint64_t host_io_writes();
+
+/**
+ * model a frame buffer core without the fill engine and span fifo
+ * @param absent 1: engine absent; 0: present (as HOST_NO_BLIT)
+ * @note a FrameCore probes the engine once; use a new instance
+ *       after changing this
+ */
+void host_set_no_blit(int absent);
+
+/**
+ * model an spi core without the tx/rx fifos
+ * @param absent 1: fifos absent; 0: present (as HOST_NO_SPI_FIFO)
+ * @note a SpiCore probes the fifos on first use; use a new instance
+ *       after changing this
+ */
+void host_set_no_spi_fifo(int absent);
+
+/**
+ * queue a byte in ps2 receiver fifo
+ * @param byte byte sent by the device
+ */
+void host_ps2_push(uint8_t byte);
+
+/**
+ * queue a 3-byte ps2 mouse packet
+ * @param dx x movement (-256 to 255)
+ * @param dy y movement (-256 to 255; positive is up)
+ * @param lbtn left button
+ * @param rbtn right button
+ */
+void host_mouse_packet(int dx, int dy, int lbtn, int rbtn);
+
+/**
+ * set an xadc reading
+ * @param ch channel (0 to 5)
+ * @param value 12-bit conversion result
+ */
+void host_xadc_set(int ch, int value);
+
+/**
+ * set the noise of an xadc channel
+ * @param ch channel (0 to 5)
+ * @param amp uniform noise of +/-amp LSB per read (0: none), reduced
+ *        by the on-chip averaging set over DRP
+ */
+void host_xadc_noise(int ch, int amp);
+
+/**
+ * set accelerometer acceleration
+ * @param x/y/z 12-bit signed reading (1 mg/LSB in +/-2g range)
+ */
+void host_acl_set(int x, int y, int z);
+
+/**
+ * queue a byte in uart receiver fifo
+ */
+void host_uart_push(uint8_t byte);
+
+/**
+ * read a frame buffer pixel (9-bit)
+ */
+uint16_t host_frame_pixel(int x, int y);
+
+/**
+ * write frame buffer to a binary PPM file
+ * @param fname file name
+ * @return 0 on success; -1 otherwise
+ */
+int host_frame_dump_ppm(const char *fname);
+
+#endif  // _HOST_IO_H_INCLUDED
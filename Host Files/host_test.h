@@ -0,0 +1,62 @@
+/*****************************************************************//**
+ * @file host_test.h
+ *
+ * @brief checks and bus counters shared by the host tests/benchmarks
+ *
+ * Description:
+ *  - CHECK(cond) counts and reports a failed condition, then goes on
+ *  - test_result() prints the summary; main() returns it as the
+ *    exit code (0: all checks passed)
+ *  - BusCount takes a snapshot of the model's bus counters and
+ *    virtual clock; the members return what happened since
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _HOST_TEST_H_INCLUDED
+#define _HOST_TEST_H_INCLUDED
+
+#include <cstdio>
+#include "host_io.h"
+
+static int test_checks = 0;
+static int test_fails = 0;
+
+#define CHECK(cond) test_check((cond) ? 1 : 0, #cond, __FILE__, __LINE__)
+
+static inline int test_check(int ok, const char *expr, const char *file, int line) {
+   test_checks++;
+   if (!ok) {
+      test_fails++;
+      printf("FAIL %s:%d: %s\n", file, line, expr);
+   }
+   return (ok);
+}
+
+static inline int test_result(const char *name) {
+   printf("%s: %d checks, %d failed\n", name, test_checks, test_fails);
+   return (test_fails ? 1 : 0);
+}
+
+struct BusCount {
+   uint64_t rd, wr, cyc;
+   BusCount() {
+      start();
+   }
+   void start() {
+      rd = host_io_reads();
+      wr = host_io_writes();
+      cyc = host_cycles();
+   }
+   uint64_t reads() {
+      return (host_io_reads() - rd);
+   }
+   uint64_t writes() {
+      return (host_io_writes() - wr);
+   }
+   uint64_t cycles() {
+      return (host_cycles() - cyc);
+   }
+};
+
+#endif  // _HOST_TEST_H_INCLUDED
@@ -0,0 +1,187 @@
+/*****************************************************************//**
+ * @file journal_test.cpp
+ *
+ * @brief Journal undo/redo against saved canvases, and replay speed
+ *
+ * Description:
+ *  - random sessions on the 440-by-340 canvas: strokes (brush radius
+ *    5/8/11/16, short and long moves, eraser), bucket fills and
+ *    clears, with undo, redo and new steps after an undo mixed in
+ *  - the canvas is saved after every step; each undo/redo must give
+ *    back the saved canvas of the step it lands on, and succeed
+ *    exactly when undo_levels()/redo_levels() say it can
+ *  - the saved canvases follow the journal: a step made after an undo
+ *    drops the redo steps, a full step table merges the two oldest,
+ *    eviction drops the oldest (steps())
+ *  - sessions run long enough to evict and to merge steps; without
+ *    and with a CanvasSnap
+ *  - replay speed: one undo of a session of strokes with no clear,
+ *    which replays the whole ring (virtual time, SYS_CLK_FREQ)
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include <vector>
+#include "journal.h"
+#include "host_test.h"
+
+enum {
+   CX = 100,   // canvas
+   CY = 70,
+   CW = 440,
+   CH = 340,
+   BG = 0xfff
+};
+
+typedef std::vector<uint16_t> Image;
+
+static void grab(FrameCore *frame, Image &img) {
+   frame->hw_wait();
+   img.resize(CW * CH);
+   for (int y = 0; y < CH; y++)
+      for (int x = 0; x < CW; x++)
+         img[y * CW + x] = host_frame_pixel(CX + x, CY + y);
+}
+
+static int clamp(int v, int lo, int hi) {
+   return ((v < lo) ? lo : (v > hi) ? hi : v);
+}
+
+// random stroke of n samples; long: some moves beyond a short move
+static void stroke(Journal *journal, int n, int long_moves) {
+   const int size[4] = {5, 8, 11, 16};
+   int r = size[rand() % 4];
+   int erase = (rand() % 5 == 0);
+   int color = erase ? BG : rand() % 0x1000;
+   int x = CX + r + rand() % (CW - 2 * r);
+   int y = CY + r + rand() % (CH - 2 * r);
+
+   for (int i = 0; i < n; i++) {
+      journal->draw(x, y, r, color, erase);
+      int d = (long_moves && rand() % 8 == 0) ? 60 : 5;
+      x = clamp(x + rand() % (2 * d + 1) - d, CX + r, CX + CW - 1 - r);
+      y = clamp(y + rand() % (2 * d + 1) - d, CY + r, CY + CH - 1 - r);
+   }
+   journal->lift();
+}
+
+// one random step; return 1 if the journal recorded a step
+static int step(FrameCore *frame, Journal *journal) {
+   int k = rand() % 40;
+
+   if (k == 0) {
+      frame->fillRect(CX, CY, CW, CH, BG);
+      journal->clear();
+      return (1);
+   }
+   if (k < 5)
+      return (journal->fill(CX + rand() % CW, CY + rand() % CH, rand() % 0x1000) > 0);
+   stroke(journal, 2 + rand() % 40, 1);
+   return (1);
+}
+
+/*
+ * random session; hist holds the canvas after each step the journal
+ * keeps, hist.back() the newest; return # failed undo/redo
+ */
+static int session(FrameCore *frame, Journal *journal, int ops, int *n_undo, int *n_merge,
+                   int *n_drop) {
+   std::vector<Image> hist(1);
+   Image img;
+   int i, k, s, r, ok, bad = 0;
+
+   frame->fillRect(CX, CY, CW, CH, BG);
+   grab(frame, hist[0]);
+   for (i = 0; i < ops; i++) {
+      k = rand() % 8;
+      r = journal->redo_levels();
+      if (k < 2) {
+         ok = journal->undo_levels() > 0;
+         if (journal->undo() != ok)
+            bad++;
+         *n_undo += ok;
+      } else if (k < 3) {
+         ok = r > 0;
+         if (journal->redo() != ok)
+            bad++;
+      } else {
+         s = journal->steps() - r;    // steps kept before this one
+         if (!step(frame, journal))
+            continue;
+         hist.resize(hist.size() - r);
+         if (s == Journal::MAX_STEP && journal->steps() == Journal::MAX_STEP) {
+            hist.erase(hist.end() - s);   // two oldest steps merged
+            (*n_merge)++;
+         }
+         hist.push_back(Image());
+         grab(frame, hist.back());
+         while ((int) hist.size() > journal->steps() + 1) {
+            hist.erase(hist.begin());     // evicted
+            (*n_drop)++;
+         }
+         continue;
+      }
+      grab(frame, img);
+      if (img != hist[hist.size() - 1 - journal->redo_levels()])
+         bad++;
+   }
+   return (bad);
+}
+
+int main() {
+   int seed, bad, n_undo, n_merge, n_drop, merged = 0, dropped = 0;
+   uint32_t bytes;
+
+   host_set_no_blit(0);
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+   Stroke *strk = new Stroke(frame);
+   FloodFill *flood = new FloodFill(frame);
+   CanvasSnap *snap = new CanvasSnap(frame);
+   flood->set_clip(CX, CY, CX + CW - 1, CY + CH - 1);
+   snap->set_canvas(CX, CY, CW, CH);
+   frame->clr_screen(0xA8B);
+
+   for (seed = 1; seed <= 6; seed++) {
+      Journal *journal = new Journal(frame, strk, flood);
+      journal->set_canvas(CX, CY, CW, CH, BG);
+      if (seed > 3) {
+         snap->set_canvas(CX, CY, CW, CH);   // drop the last session's snapshots
+         journal->set_snap(snap);
+      }
+      srand(seed);
+      n_undo = n_merge = n_drop = 0;
+      bad = session(frame, journal, 600, &n_undo, &n_merge, &n_drop);
+      printf("  seed %d %-8s %3d undos  %3d merged  %3d evicted  %4d bytes  %2d steps\n", seed,
+             (seed > 3) ? "snap" : "no snap", n_undo, n_merge, n_drop, journal->bytes_used(),
+             journal->steps());
+      CHECK(bad == 0);
+      merged += n_merge;
+      dropped += n_drop;
+      delete journal;
+   }
+   CHECK(merged > 0 && dropped > 0);
+
+   // replay speed: strokes with no clear until the ring is nearly full
+   Journal *journal = new Journal(frame, strk, flood);
+   journal->set_canvas(CX, CY, CW, CH, BG);
+   frame->fillRect(CX, CY, CW, CH, BG);
+   srand(10);
+   do {
+      bytes = journal->bytes_used();   // replayed by the undo of the last stroke
+      stroke(journal, 60 + rand() % 60, 0);
+   } while (journal->bytes_used() < Journal::BUF_SIZE - 200 && journal->steps() < 40);
+   CHECK(journal->undo() == 1);
+   printf("  replay: %u bytes, %d steps in %.1f ms (%.0f KB/s)\n", (unsigned) bytes,
+          journal->steps(), journal->replay_us() / 1000.0,
+          bytes * 1000.0 / journal->replay_us());
+   CHECK(journal->replay_us() > 0);
+   delete journal;
+   delete snap;
+   delete flood;
+   delete strk;
+   delete frame;
+   return (test_result("journal_test"));
+}
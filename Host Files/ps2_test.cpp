@@ -0,0 +1,101 @@
+/*****************************************************************//**
+ * @file ps2_test.cpp
+ *
+ * @brief Ps2Core::poll_mouse() decoding of whole, split, truncated
+ *        and desynchronized byte streams
+ *
+ * Description:
+ *  - bytes reach the ps2 model's rx fifo 1 ms apart (virtual time);
+ *    sleep_ms() lets them arrive
+ *  - whole packets: buttons, signs and the 9-bit range ends
+ *  - split: one byte arrives between calls; a partial packet is kept,
+ *    never waited for; max bounds the packets per call
+ *  - truncated: a packet missing its last byte takes the next header
+ *    as that byte; the bytes after it (bit 3 clear) are dropped and
+ *    the following packet decodes again
+ *  - desynchronized: bytes with bit 3 clear ahead of a header are
+ *    dropped and counted in mouse_sync_errors()
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include "chu_init.h"
+#include "ps2_core.h"
+#include "host_test.h"
+
+static int same(const Ps2MousePacket &p, int dx, int dy, int l, int r) {
+   return (p.xmov == dx && p.ymov == dy && p.lbtn == l && p.rbtn == r);
+}
+
+int main() {
+   Ps2Core ps2(get_slot_addr(BRIDGE_BASE, S11_PS2));
+   Ps2MousePacket p[16];
+   uint64_t rd;
+   int n, i;
+
+   // nothing received: returns at once
+   rd = host_io_reads();
+   CHECK(ps2.poll_mouse(p, 16) == 0);
+   CHECK(host_io_reads() - rd == 1);
+
+   // whole packets
+   host_mouse_packet(3, -2, 1, 0);
+   host_mouse_packet(-1, 4, 0, 1);
+   host_mouse_packet(255, -256, 1, 1);
+   host_mouse_packet(-256, 255, 0, 0);
+   host_mouse_packet(0, 0, 0, 0);
+   sleep_ms(20);
+   n = ps2.poll_mouse(p, 2);   // bounded by max
+   CHECK(n == 2);
+   n += ps2.poll_mouse(&p[2], 16);
+   CHECK(n == 5);
+   CHECK(same(p[0], 3, -2, 1, 0));
+   CHECK(same(p[1], -1, 4, 0, 1));
+   CHECK(same(p[2], 255, -256, 1, 1));
+   CHECK(same(p[3], -256, 255, 0, 0));
+   CHECK(same(p[4], 0, 0, 0, 0));
+   CHECK(ps2.mouse_sync_errors() == 0);
+
+   // split: one byte arrives between calls
+   const uint8_t split[6] = {0x18, 0xf9, 0x09, 0x09, 0x02, 0x02};   // (-7, 9); (2, 2) left
+   for (i = 0, n = 0; i < 6; i++) {
+      host_ps2_push(split[i]);
+      sleep_ms(2);
+      n += ps2.poll_mouse(&p[n], 16);
+      CHECK(n == (i + 1) / 3);   // open packet kept until its third byte
+   }
+   CHECK(same(p[0], -7, 9, 0, 0));
+   CHECK(same(p[1], 2, 2, 1, 0));
+   CHECK(ps2.mouse_sync_errors() == 0);
+
+   // truncated: last byte of the first packet lost
+   host_ps2_push(0x09);   // header: left button, dx 5
+   host_ps2_push(0x05);
+   host_mouse_packet(2, 1, 0, 0);   // header taken as the lost dy
+   host_mouse_packet(-4, 6, 0, 1);
+   sleep_ms(20);
+   n = ps2.poll_mouse(p, 16);
+   CHECK(n == 2);
+   CHECK(same(p[0], 5, 0x08, 1, 0));
+   CHECK(same(p[1], -4, 6, 0, 1));
+   CHECK(ps2.mouse_sync_errors() == 2);   // dx 2, dy 1 of the second
+
+   // desynchronized: stream picked up mid-packet, noise bytes between
+   host_ps2_push(0x03);
+   host_ps2_push(0xf0);
+   host_mouse_packet(1, -1, 0, 0);
+   host_ps2_push(0x40);
+   host_ps2_push(0x07);
+   host_ps2_push(0x00);
+   host_mouse_packet(-3, -5, 1, 0);
+   sleep_ms(20);
+   n = ps2.poll_mouse(p, 16);
+   CHECK(n == 2);
+   CHECK(same(p[0], 1, -1, 0, 0));
+   CHECK(same(p[1], -3, -5, 1, 0));
+   CHECK(ps2.mouse_sync_errors() == 2 + 5);
+   printf("  sync errors: %u\n", (unsigned) ps2.mouse_sync_errors());
+   return (test_result("ps2_test"));
+}
@@ -0,0 +1,123 @@
+/*****************************************************************//**
+ * @file readback_test.cpp
+ *
+ * @brief FrameCore::rd_pix()/rd_span() against the frame buffer model
+ *
+ * Description:
+ *  - random frame content written around FrameCore (all tiles mixed):
+ *    random pixel reads spread over whole frame periods, in active
+ *    video and in vblank, one bus read each
+ *  - spans: random runs, clipped at the frame edges
+ *  - uniform tiles (after an aligned fillRect()) come from the tile
+ *    table without a bus read
+ *  - reads right after queued engine fills and spans return the filled
+ *    pixels (a bus read waits for the engine; a uniform tile answers
+ *    at once)
+ *  - unpack9() of a pixel read is the 12-bit color frame_palette_9
+ *    shows
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include "chu_init.h"
+#include "vga_core.h"
+#include "host_test.h"
+
+enum {
+   HMAX = FrameCore::HMAX,
+   VMAX = FrameCore::VMAX
+};
+
+int main() {
+   uint16_t buf[HMAX];
+   int i, k, x, y, w, n, ok, active = 0, blank = 0, bad = 0;
+   BusCount bus;
+
+   srand(5);
+   for (i = 0; i < HMAX * VMAX; i++)
+      io_write(FRAME_BASE, i, rand() & 0x1ff);
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+   CHECK(frame->has_blit());
+
+   // single pixels at every point of the beam
+   for (i = 0; i < 20000; i++) {
+      x = rand() % HMAX;
+      y = rand() % VMAX;
+      if (frame->in_vblank())
+         blank++;
+      else
+         active++;
+      bus.start();
+      bad += (frame->rd_pix(x, y) != host_frame_pixel(x, y) || bus.reads() != 1);
+      sleep_us(rand() % 50);
+   }
+   printf("  %d reads in active video, %d in vblank\n", active, blank);
+   CHECK(bad == 0);
+   CHECK(active > 0 && blank > 0);
+   CHECK(frame->rd_pix(-1, 0) == 0 && frame->rd_pix(0, VMAX) == 0);
+
+   // spans, clipped
+   for (i = 0, bad = 0; i < 2000; i++) {
+      x = rand() % (HMAX + 100) - 50;
+      y = rand() % (VMAX + 20) - 10;
+      w = rand() % 300;
+      n = frame->rd_span(x, y, w, buf);
+      int x0 = (x < 0) ? 0 : x;
+      int x1 = (x + w > HMAX) ? HMAX : x + w;
+      int len = (y < 0 || y >= VMAX || x1 <= x0) ? 0 : x1 - x0;
+      ok = (n == len);
+      for (k = 0; ok && k < n; k++)
+         ok = (buf[k] == host_frame_pixel(x0 + k, y));
+      bad += !ok;
+   }
+   CHECK(bad == 0);
+
+   // uniform tiles: no bus read
+   frame->fillRect(64, 64, 128, 64, 0x0f0);
+   frame->hw_wait();
+   bus.start();
+   n = frame->rd_span(64, 100, 128, buf);
+   for (k = 0, ok = (n == 128); ok && k < n; k++)
+      ok = (buf[k] == FrameCore::pack9(0x0f0));
+   CHECK(ok);
+   CHECK(frame->rd_pix(100, 70) == FrameCore::pack9(0x0f0));
+   CHECK(bus.reads() == 0);
+   // span across the rectangle edge: only the mixed tile pieces are read
+   bus.start();
+   n = frame->rd_span(60, 100, 12, buf);
+   CHECK(n == 12 && bus.reads() == 4);
+   for (k = 0, ok = 1; k < n; k++)
+      ok = ok && (buf[k] == host_frame_pixel(60 + k, 100));
+   CHECK(ok);
+
+   // reads right after queued engine work
+   for (i = 0, bad = 0; i < 500; i++) {
+      x = rand() % (HMAX - 64);
+      y = rand() % (VMAX - 32);
+      uint16_t pix = FrameCore::pack9(rand() & 0xfff);
+      if (i & 1)
+         frame->fillRect(x, y, 9 + rand() % 55, 1 + rand() % 31, FrameCore::unpack9(pix));
+      else
+         frame->wr_span(x, y, 9 + rand() % 55, FrameCore::unpack9(pix));
+      bad += (frame->rd_pix(x + 3, y) != pix);
+      frame->hw_wait();   // a uniform tile answers before the engine is done
+      bad += (host_frame_pixel(x + 3, y) != pix);
+   }
+   CHECK(bad == 0);
+
+   // unpack9(): 3-bit channel a shown as {a, a[2]}
+   for (i = 0, bad = 0; i < 512; i++) {
+      int c = FrameCore::unpack9((uint16_t) i);
+      for (k = 0; k < 3; k++) {
+         int a = (i >> (3 * k)) & 7;
+         bad += (((c >> (4 * k)) & 0xf) != ((a << 1) | (a >> 2)));
+      }
+      bad += (FrameCore::pack9(c) != i);
+   }
+   CHECK(bad == 0);
+   delete frame;
+   return (test_result("readback_test"));
+}
@@ -0,0 +1,122 @@
+/*****************************************************************//**
+ * @file rle2ppm.cpp
+ *
+ * @brief decode a canvas export stream (see xfer.h) into a PPM image
+ *
+ * Description:
+ *  - usage: rle2ppm [-r raw.p9rl] capture image.ppm
+ *  - capture: bytes received from the uart (console text around the
+ *    stream is skipped)
+ *  - the crc is checked; a bad stream is still decoded, exit code 2
+ *  - pixels are expanded as frame_palette_9 does, so the image
+ *    matches a host frame dump
+ *  - -r: also write the stream itself (e.g., for a later import)
+ *
+ * Build: g++ -O2 "Host Files"/rle2ppm.cpp -o rle2ppm
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <vector>
+
+static uint16_t crc16(const uint8_t *p, size_t n) {
+   uint16_t crc = 0xffff;
+
+   while (n--) {
+      crc = crc ^ ((uint16_t) *p++ << 8);
+      for (int i = 0; i < 8; i++)
+         crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+   }
+   return (crc);
+}
+
+int main(int argc, char *argv[]) {
+   std::vector<uint8_t> in, img;
+   const char *raw = 0;
+   FILE *fp;
+   size_t at, pos;
+   uint32_t left, k;
+   int c, w, h, run, pix, bad;
+
+   if (argc > 2 && !strcmp(argv[1], "-r")) {
+      raw = argv[2];
+      argc = argc - 2;
+      argv = argv + 2;
+   }
+   if (argc != 3) {
+      fprintf(stderr, "usage: rle2ppm [-r raw.p9rl] capture image.ppm\n");
+      return (1);
+   }
+   fp = fopen(argv[1], "rb");
+   if (!fp) {
+      fprintf(stderr, "rle2ppm: cannot open %s\n", argv[1]);
+      return (1);
+   }
+   while ((c = fgetc(fp)) != EOF)
+      in.push_back((uint8_t) c);
+   fclose(fp);
+   /* find the header */
+   for (at = 0; at + 8 <= in.size(); at++)
+      if (!memcmp(&in[at], "P9RL", 4))
+         break;
+   if (at + 8 > in.size()) {
+      fprintf(stderr, "rle2ppm: no stream found\n");
+      return (1);
+   }
+   w = in[at + 4] | (in[at + 5] << 8);
+   h = in[at + 6] | (in[at + 7] << 8);
+   if (w == 0 || h == 0 || w > 640 || h > 480) {
+      fprintf(stderr, "rle2ppm: bad size %d x %d\n", w, h);
+      return (1);
+   }
+   /* runs */
+   left = (uint32_t) w * h;
+   pos = at + 8;
+   while (left > 0 && pos + 2 <= in.size()) {
+      pix = (in[pos] | (in[pos + 1] << 8)) & 0x1ff;
+      run = ((in[pos + 1] >> 1) & 0x7f) + 1;
+      pos = pos + 2;
+      if ((uint32_t) run > left) {
+         fprintf(stderr, "rle2ppm: run past the end of the image\n");
+         return (1);
+      }
+      left = left - run;
+      for (k = 0; k < (uint32_t) run; k++)
+         for (int ch = 0; ch < 3; ch++) {
+            // frame_palette_9: 3-bit channel a expands to {a, a[2]}
+            int a = (pix >> (6 - 3 * ch)) & 0x07;
+            img.push_back((uint8_t) (((a << 1) | (a >> 2)) * 17));
+         }
+   }
+   if (left > 0 || pos + 2 > in.size()) {
+      fprintf(stderr, "rle2ppm: stream truncated\n");
+      return (1);
+   }
+   bad = (crc16(&in[at], pos - at) != (in[pos] | (in[pos + 1] << 8)));
+   if (bad)
+      fprintf(stderr, "rle2ppm: crc mismatch\n");
+   fp = fopen(argv[2], "wb");
+   if (!fp) {
+      fprintf(stderr, "rle2ppm: cannot write %s\n", argv[2]);
+      return (1);
+   }
+   fprintf(fp, "P6\n%d %d\n255\n", w, h);
+   fwrite(img.data(), 1, img.size(), fp);
+   fclose(fp);
+   if (raw) {
+      fp = fopen(raw, "wb");
+      if (!fp) {
+         fprintf(stderr, "rle2ppm: cannot write %s\n", raw);
+         return (1);
+      }
+      fwrite(&in[at], 1, pos + 2 - at, fp);
+      fclose(fp);
+   }
+   printf("%d x %d, %u bytes, %u runs%s\n", w, h, (unsigned) (pos + 2 - at),
+          (unsigned) ((pos - at - 8) / 2), bad ? ", bad crc" : "");
+   return (bad ? 2 : 0);
+}
@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# build and run the host tests and benchmarks
+#
+# usage (from the repository root): sh "Host Files/run_tests.sh" [build dir]
+#  - drivers are compiled once with -D_HOST_IO_USED; each program in
+#    TESTS links them with the host models
+#  - exit code: 0 if every program passed its checks
+#
+B=${1:-host_build}
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++14 -O2 -D_HOST_IO_USED -Wno-int-to-pointer-cast"
+TESTS="fill_bench dab_bench stroke_test swatch_test ps2_test vblank_test blit_test span_bench readback_test flood_test flood_bench journal_test snap_bench spi_bench spectrum_test"
+
+mkdir -p "$B/obj" || exit 1
+for f in "Driver Files"/*.cpp "Host Files"/host_io.cpp; do
+   o="$B/obj/$(basename "$f" .cpp).o"
+   $CXX $CXXFLAGS -I"Driver Files" -I"Host Files" -c "$f" -o "$o" || exit 1
+done
+
+fail=0
+for t in $TESTS; do
+   echo "== $t"
+   if ! $CXX $CXXFLAGS -I"Driver Files" -I"Host Files" "Host Files/$t.cpp" "$B"/obj/*.o -o "$B/$t"; then
+      fail=$((fail + 1))
+      continue
+   fi
+   "$B/$t" || fail=$((fail + 1))
+done
+echo "== $fail program(s) failed"
+[ $fail -eq 0 ]
@@ -0,0 +1,105 @@
+/*****************************************************************//**
+ * @file shake_replay.cpp
+ *
+ * @brief run the shake detector (shake.h) over recorded accelerometer traces
+ *
+ * Description:
+ *  - usage: shake_replay [-r rate_hz] [-p poll_ms] [-v] trace ...
+ *  - trace: lines "<ms> acl <x> <y> <z>" (mg), as logged by the 'a'
+ *    console command and as used in host event scripts; other lines
+ *    (console text, other events) are skipped
+ *  - the trace is sampled at the sensor rate (default 100 Hz), each
+ *    reading held until the next, as the host ADXL362 model does
+ *  - -p: also report when a poll every poll_ms would see each shake
+ *  - -v: print energy and peak count per sample
+ *  - exit code: 0; 1 on a usage or file error
+ *
+ * Build: g++ -O2 -I"Driver Files" "Host Files"/shake_replay.cpp \
+ *            "Driver Files"/shake.cpp -o shake_replay
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include "shake.h"
+
+struct Reading {
+   double ms;
+   int v[3];
+};
+
+static int load(const char *fname, std::vector<Reading> &tr) {
+   char line[256];
+   Reading r;
+   FILE *fp;
+
+   fp = fopen(fname, "r");
+   if (!fp)
+      return (-1);
+   while (fgets(line, sizeof(line), fp)) {
+      if (sscanf(line, "%lf acl %d %d %d", &r.ms, &r.v[0], &r.v[1], &r.v[2]) == 4)
+         tr.push_back(r);
+   }
+   fclose(fp);
+   return (0);
+}
+
+int main(int argc, char *argv[]) {
+   int rate = 100, poll = 0, verbose = 0;
+   int a, k, n_shake;
+   double t, t_end, seen;
+   size_t i;
+
+   for (a = 1; a < argc && argv[a][0] == '-'; a++) {
+      if (!strcmp(argv[a], "-r") && a + 1 < argc)
+         rate = atoi(argv[++a]);
+      else if (!strcmp(argv[a], "-p") && a + 1 < argc)
+         poll = atoi(argv[++a]);
+      else if (!strcmp(argv[a], "-v"))
+         verbose = 1;
+      else
+         break;
+   }
+   if (a >= argc || rate <= 0 || poll < 0) {
+      fprintf(stderr, "usage: shake_replay [-r rate_hz] [-p poll_ms] [-v] trace ...\n");
+      return (1);
+   }
+   for (; a < argc; a++) {
+      std::vector<Reading> tr;
+      ShakeDetector shake(rate);
+
+      if (load(argv[a], tr) != 0) {
+         fprintf(stderr, "shake_replay: cannot open %s\n", argv[a]);
+         return (1);
+      }
+      printf("%s: %u readings\n", argv[a], (unsigned) tr.size());
+      if (tr.empty())
+         continue;
+      // sample from the first reading to 1 s past the last
+      n_shake = 0;
+      i = 0;
+      t_end = tr.back().ms + 1000.0;
+      for (k = 0; (t = tr[0].ms + 1000.0 * k / rate) <= t_end; k++) {
+         while (i + 1 < tr.size() && tr[i + 1].ms <= t)
+            i++;
+         if (shake.feed(tr[i].v[0], tr[i].v[1], tr[i].v[2])) {
+            n_shake++;
+            printf("  shake at %.0f ms", t);
+            if (poll > 0) {
+               seen = poll * ceil(t / poll);   // first poll at or after the sample
+               printf(" (poll sees it at %.0f ms)", seen);
+            }
+            printf("\n");
+         }
+         if (verbose)
+            printf("  %.0f: %d %d %d energy %d peaks %d\n", t, tr[i].v[0], tr[i].v[1],
+                   tr[i].v[2], shake.energy(), shake.peaks());
+      }
+      printf("  %d shakes, %u samples\n", n_shake, (unsigned) shake.samples());
+   }
+   return (0);
+}
@@ -0,0 +1,174 @@
+/*****************************************************************//**
+ * @file snap_bench.cpp
+ *
+ * @brief undo latency with and without canvas snapshots, snapshot
+ *        pool use and capture/restore time (CanvasSnap)
+ *
+ * Description:
+ *  - random sessions on the 440-by-340 canvas: strokes (brush radius
+ *    5/8/11/16, short and long moves, eraser), bucket fills and
+ *    clears, as in journal_test
+ *  - after each step the latest step is undone (timed) and redone,
+ *    so both runs of a session draw the same canvas
+ *  - each session runs with a Journal alone (replay from the last
+ *    clear) and with a CanvasSnap attached (replay from the last
+ *    snapshot); the final canvases must be identical and every undo
+ *    must give back the canvas before the step
+ *  - time is virtual (bus accesses and engine, SYS_CLK_FREQ)
+ *  - pool: largest # run words in use, of POOL_WORDS; capture: longest
+ *    time and most run words encoded at pen-up; restore: longest tile
+ *    write-back
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include <vector>
+#include "journal.h"
+#include "host_test.h"
+
+enum {
+   STEPS = 300,
+   CX = 100,   // canvas
+   CY = 70,
+   CW = 440,
+   CH = 340,
+   BG = 0xfff
+};
+
+typedef std::vector<uint16_t> Image;
+
+struct Result {
+   uint32_t undo_sum, undo_max;
+   int n_undo;
+   int pool_max, words_max;
+   uint32_t cap_max, res_max;
+   int bad;
+   Image img;
+};
+
+static void grab(FrameCore *frame, Image &img) {
+   frame->hw_wait();
+   img.resize(CW * CH);
+   for (int y = 0; y < CH; y++)
+      for (int x = 0; x < CW; x++)
+         img[y * CW + x] = host_frame_pixel(CX + x, CY + y);
+}
+
+static int clamp(int v, int lo, int hi) {
+   return ((v < lo) ? lo : (v > hi) ? hi : v);
+}
+
+// random stroke of n samples, some moves beyond a short move
+static void stroke(Journal *journal, int n) {
+   const int size[4] = {5, 8, 11, 16};
+   int r = size[rand() % 4];
+   int erase = (rand() % 5 == 0);
+   int color = erase ? BG : rand() % 0x1000;
+   int x = CX + r + rand() % (CW - 2 * r);
+   int y = CY + r + rand() % (CH - 2 * r);
+
+   for (int i = 0; i < n; i++) {
+      journal->draw(x, y, r, color, erase);
+      int d = (rand() % 8 == 0) ? 60 : 5;
+      x = clamp(x + rand() % (2 * d + 1) - d, CX + r, CX + CW - 1 - r);
+      y = clamp(y + rand() % (2 * d + 1) - d, CY + r, CY + CH - 1 - r);
+   }
+   journal->lift();
+}
+
+// one random step; return 1 if the journal recorded a step
+static int step(FrameCore *frame, Journal *journal) {
+   int k = rand() % 40;
+
+   if (k == 0) {
+      frame->fillRect(CX, CY, CW, CH, BG);
+      journal->clear();
+      return (1);
+   }
+   if (k < 5)
+      return (journal->fill(CX + rand() % CW, CY + rand() % CH, rand() % 0x1000) > 0);
+   stroke(journal, 2 + rand() % 40);
+   return (1);
+}
+
+static void session(FrameCore *frame, Stroke *strk, FloodFill *flood, CanvasSnap *snap,
+                    int seed, Result *res) {
+   Image before, after;
+   uint32_t us;
+
+   Journal *journal = new Journal(frame, strk, flood);
+   journal->set_canvas(CX, CY, CW, CH, BG);
+   if (snap) {
+      snap->set_canvas(CX, CY, CW, CH);
+      journal->set_snap(snap);
+   }
+   *res = Result();
+   frame->fillRect(CX, CY, CW, CH, BG);
+   srand(seed);
+   grab(frame, before);
+   for (int i = 0; i < STEPS; i++) {
+      if (!step(frame, journal))
+         continue;
+      if (journal->undo_levels() == 0) {
+         grab(frame, before);   // history dropped: nothing to undo
+         continue;
+      }
+      if (snap && snap->words_used() > res->pool_max)
+         res->pool_max = snap->words_used();
+      if (snap && snap->last_words() > res->words_max)
+         res->words_max = snap->last_words();
+      if (snap && snap->capture_us() > res->cap_max)
+         res->cap_max = snap->capture_us();
+      grab(frame, after);
+      journal->undo();
+      us = journal->replay_us();
+      if (snap && snap->restore_us() > res->res_max)
+         res->res_max = snap->restore_us();
+      res->undo_sum += us;
+      res->undo_max = (us > res->undo_max) ? us : res->undo_max;
+      res->n_undo++;
+      grab(frame, res->img);
+      res->bad += (res->img != before);
+      journal->redo();
+      grab(frame, before);
+      res->bad += (before != after);
+   }
+   grab(frame, res->img);
+   delete journal;
+}
+
+int main() {
+   Result old, snp;
+
+   host_set_no_blit(0);
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+   Stroke *strk = new Stroke(frame);
+   FloodFill *flood = new FloodFill(frame);
+   CanvasSnap *snap = new CanvasSnap(frame);
+   flood->set_clip(CX, CY, CX + CW - 1, CY + CH - 1);
+   frame->clr_screen(0xA8B);
+
+   printf("  seed  undo mean/max ms   with snapshots   pool words  capture ms/words"
+          "  restore ms\n");
+   for (int seed = 1; seed <= 3; seed++) {
+      session(frame, strk, flood, 0, seed, &old);
+      session(frame, strk, flood, snap, seed, &snp);
+      CHECK(old.bad == 0 && snp.bad == 0);
+      CHECK(old.img == snp.img);
+      CHECK(snp.undo_sum < old.undo_sum);
+      CHECK(snp.pool_max <= CanvasSnap::POOL_WORDS);
+      printf("  %4d  %6.1f %6.1f     %6.1f %6.1f     %5d/%d  %6.1f %5d    %6.1f\n", seed,
+             old.undo_sum / 1000.0 / old.n_undo, old.undo_max / 1000.0,
+             snp.undo_sum / 1000.0 / snp.n_undo, snp.undo_max / 1000.0, snp.pool_max,
+             (int) CanvasSnap::POOL_WORDS, snp.cap_max / 1000.0, snp.words_max,
+             snp.res_max / 1000.0);
+   }
+   delete snap;
+   delete flood;
+   delete strk;
+   delete frame;
+   return (test_result("snap_bench"));
+}
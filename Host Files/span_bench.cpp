@@ -0,0 +1,94 @@
+/*****************************************************************//**
+ * @file span_bench.cpp
+ *
+ * @brief brush dabs per second with the span fifo and without the
+ *        fill engine
+ *
+ * Description:
+ *  - 2000 fillCircle() dabs of random color at random points of the
+ *    canvas, for each radius 1 to 20; the canvas is cleared to white
+ *    before each run (not timed), around FrameCore so the two
+ *    instances' tile tables never take it for uniform
+ *  - span fifo: FrameCore with the engine; no engine: as
+ *    HOST_NO_BLIT=1, one bus write per pixel
+ *  - time is virtual (4 clocks per bus access, engine one pixel per
+ *    clock) at SYS_CLK_FREQ, up to hw_wait() after the last dab
+ *  - both runs must leave the same frame
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include <vector>
+#include "vga_core.h"
+#include "host_test.h"
+
+enum {
+   DABS = 2000,
+   CX = 100,   // canvas
+   CY = 70,
+   CW = 440,
+   CH = 340
+};
+
+static void clear_canvas(void) {
+   for (int y = CY; y < CY + CH; y++)
+      for (int x = CX; x < CX + CW; x++)
+         io_write(FRAME_BASE, FrameCore::HMAX * y + x, FrameCore::pack9(0xfff));
+}
+
+static void grab(std::vector<uint16_t> &img) {
+   img.resize(CW * CH);
+   for (int y = 0; y < CH; y++)
+      for (int x = 0; x < CW; x++)
+         img[y * CW + x] = host_frame_pixel(CX + x, CY + y);
+}
+
+// dabs of radius r; return virtual clocks
+static uint64_t dabs(FrameCore *frame, int r, std::vector<uint16_t> &img) {
+   BusCount bus;
+   uint64_t cyc;
+
+   clear_canvas();
+   srand(r);
+   bus.start();
+   for (int i = 0; i < DABS; i++)
+      frame->fillCircle(CX + r + rand() % (CW - 2 * r), CY + r + rand() % (CH - 2 * r), r,
+                        rand() % 0xfff);
+   frame->hw_wait();
+   cyc = bus.cycles();
+   grab(img);
+   return (cyc);
+}
+
+static double rate(uint64_t cyc) {
+   return (DABS * (SYS_CLK_FREQ * 1e6) / cyc);
+}
+
+int main() {
+   std::vector<uint16_t> img_sw, img_hw;
+   uint64_t c_sw, c_hw;
+
+   host_set_no_blit(1);
+   FrameCore *sw = new FrameCore(FRAME_BASE);
+   CHECK(!sw->has_blit());
+   host_set_no_blit(0);
+   FrameCore *hw = new FrameCore(FRAME_BASE);
+   CHECK(hw->has_span());
+   printf("   r   no engine dabs/s   span fifo dabs/s   speed-up\n");
+   for (int r = 1; r <= FrameCore::BRUSH_R_MAX; r++) {
+      host_set_no_blit(1);
+      c_sw = dabs(sw, r, img_sw);
+      host_set_no_blit(0);
+      c_hw = dabs(hw, r, img_hw);
+      CHECK(img_sw == img_hw);
+      CHECK(c_hw < c_sw);
+      printf("  %2d   %16.0f   %16.0f   %8.2f\n", r, rate(c_sw), rate(c_hw),
+             (double) c_sw / c_hw);
+   }
+   delete sw;
+   delete hw;
+   return (test_result("span_bench"));
+}
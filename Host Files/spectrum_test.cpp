@@ -0,0 +1,173 @@
+/*****************************************************************//**
+ * @file spectrum_test.cpp
+ *
+ * @brief Spectrum::map() against the floating-point spectrum() and
+ *        map_rgb() of the original program
+ *
+ * Description:
+ *  - reference: the original code path for a color pot reading, with
+ *    the duty cycles PwmCore::set_duty(double) would have written
+ *    (the last write to each channel wins)
+ *  - all 4096 readings: brush colors must be identical, pwm duty
+ *    cycles within 1 LSB
+ *  - Spectrum::set() returns the color of map()
+ *  - speed: every reading REPS times through the original path
+ *    (spectrum() with its pwm writes, map_rgb()) and through
+ *    Spectrum::set(); host ns and virtual bus cycles (SYS_CLK_FREQ)
+ *    per update (the bus cycles leave out the MCS's software floating
+ *    point, which the host ns do not show either)
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <chrono>
+#include "chu_init.h"
+#include "spectrum.h"
+#include "host_test.h"
+
+enum {
+   REPS = 50
+};
+
+/* original program (floating point) */
+static PwmCore *ref_pwm = 0;   // set: also write the led as the original did
+
+static double map(double mag, double in_min, double in_max, double out_min, double out_max) {
+   return ((mag) - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+static uint16_t map_rgb(double mag, double in_min, double in_max, double out_min,
+                        double out_max) {
+   return (uint16_t) ((mag - in_min) * (out_max - out_min) / (in_max - in_min) + out_min);
+}
+
+// PwmCore::set_duty(double f, int channel)
+static void set_duty(int duty[3], double f, int ch) {
+   int d = (int) (f * PwmCore::MAX);
+
+   duty[ch] = (d > PwmCore::MAX) ? PwmCore::MAX : d;
+   if (ref_pwm)
+      ref_pwm->set_duty(f, ch);
+}
+
+static void spectrum(int duty[3], double duty_pot, double *r, double *g, double *b) {
+   double red = 0.0, green = 0.0, blue = 0.0;
+
+   if (ref_pwm)
+      ref_pwm->set_freq(50);
+   if (duty_pot >= 0.0 && duty_pot <= (1.0 / 6.0)) {
+      set_duty(duty, 1.0, 2);
+      red = 0.999;
+      set_duty(duty, map(duty_pot, 0, (1.0 / 6.0), 0.0, 1.0), 1);
+      green = map(duty_pot, 0, (1.0 / 6.0), 0.03, 0.999);
+      set_duty(duty, 0.0, 0);
+      blue = 0.03;
+   } else if (duty_pot > (1.0 / 6.0) && duty_pot <= (2.0 / 6.0)) {
+      set_duty(duty, map(duty_pot, (1.0 / 6.0), (2.0 / 6.0), 1.0, 0.0), 2);
+      red = map(duty_pot, (1.0 / 6.0), (2.0 / 6.0), 0.999, 0.03);
+      set_duty(duty, 1.0, 1);
+      green = 0.999;
+      set_duty(duty, 0.0, 0);
+      blue = 0.03;
+      if (duty_pot >= 0.33)
+         set_duty(duty, 0.0, 2);
+   } else if (duty_pot > (2.0 / 6.0) && duty_pot <= (3.0 / 6.0)) {
+      set_duty(duty, 0.0, 2);
+      red = 0.03;
+      set_duty(duty, 1.0, 1);
+      green = 0.999;
+      set_duty(duty, map(duty_pot, (2.0 / 6.0), (3.0 / 6.0), 0.0, 1.0), 0);
+      blue = map(duty_pot, (2.0 / 6.0), (3.0 / 6.0), 0.03, 0.999);
+   } else if (duty_pot > (3.0 / 6.0) && duty_pot <= (4.0 / 6.0)) {
+      set_duty(duty, 0.0, 2);
+      red = 0.03;
+      set_duty(duty, map(duty_pot, (3.0 / 6.0), (4.0 / 6.0), 1.0, 0.0), 1);
+      green = map(duty_pot, (3.0 / 6.0), (4.0 / 6.0), 0.999, 0.03);
+      set_duty(duty, 1.0, 0);
+      blue = 0.999;
+      if (duty_pot >= 0.66)
+         set_duty(duty, 0.0, 1);
+   } else if (duty_pot > (4.0 / 6.0) && duty_pot <= (5.0 / 6.0)) {
+      set_duty(duty, map(duty_pot, (4.0 / 6.0), (5.0 / 6.0), 0.0, 1.0), 2);
+      red = map(duty_pot, (4.0 / 6.0), (5.0 / 6.0), 0.03, 0.999);
+      set_duty(duty, 0.0, 1);
+      green = 0.03;
+      set_duty(duty, 1.0, 0);
+      blue = 0.999;
+   } else if (duty_pot > (5.0 / 6.0) && duty_pot <= 9.999) {
+      set_duty(duty, 1.0, 2);
+      red = 0.999;
+      set_duty(duty, 0.0, 1);
+      green = 0.03;
+      set_duty(duty, map(duty_pot, (5.0 / 6.0), 1.0, 1.0, 0.0), 0);
+      blue = map(duty_pot, (5.0 / 6.0), 1.0, 0.999, 0.03);
+   }
+   *r = red;
+   *g = green;
+   *b = blue;
+}
+
+// color of a reading as the original main loop built it
+static uint16_t old_color(int raw, int duty[3]) {
+   double r, g, b;
+
+   spectrum(duty, (double) raw / 4096.0, &r, &g, &b);   // XadcCore::read_adc_in()
+   return ((map_rgb(r, 0.03, .999, 0, 0xf) << 8) | (map_rgb(g, 0.03, .999, 0, 0xf) << 4)
+           | map_rgb(b, 0.03, .999, 0, 0xf));
+}
+
+// time REPS passes over all readings; ns and bus cycles per update
+static uint16_t timed(Spectrum *spec, double *ns, double *cyc) {
+   int duty[3];
+   uint16_t sum = 0;
+   BusCount bus;
+
+   auto t0 = std::chrono::steady_clock::now();
+   for (int k = 0; k < REPS; k++)
+      for (int raw = 0; raw < 4096; raw++)
+         sum += spec ? spec->set(raw) : old_color(raw, duty);
+   auto t1 = std::chrono::steady_clock::now();
+   *ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (REPS * 4096);
+   *cyc = (double) bus.cycles() / (REPS * 4096);
+   return (sum);
+}
+
+int main() {
+   PwmCore pwm(get_slot_addr(BRIDGE_BASE, S6_PWM));
+   Spectrum spec(&pwm);
+   int duty[3], ref[3];
+   int raw, ch, d, bad_color = 0, bad_duty = 0, exact = 0, set_ok = 1;
+   uint16_t color, sum_old, sum_new;
+   double ns_old, cyc_old, ns_new, cyc_new;
+
+   for (raw = 0; raw < 4096; raw++) {
+      ref[0] = ref[1] = ref[2] = 0;
+      color = spec.map(raw, duty);
+      bad_color += (color != old_color(raw, ref));
+      for (ch = 0, d = 1; ch < 3; ch++) {
+         bad_duty += (duty[ch] - ref[ch] > 1 || ref[ch] - duty[ch] > 1);
+         d = d && (duty[ch] == ref[ch]);
+      }
+      exact += d;
+      if ((raw & 0xff) == 0)
+         set_ok = set_ok && (spec.set(raw) == color);
+   }
+   printf("  4096 readings: %d colors differ, %d duties off by more than 1 LSB,"
+          " %d readings with all duties exact\n", bad_color, bad_duty, exact);
+   CHECK(bad_color == 0);
+   CHECK(bad_duty == 0);
+   CHECK(set_ok);
+
+   ref_pwm = &pwm;
+   sum_old = timed(0, &ns_old, &cyc_old);
+   ref_pwm = 0;
+   sum_new = timed(&spec, &ns_new, &cyc_new);
+   printf("  per update:     host ns   bus cycles\n");
+   printf("  double path   %9.1f   %10.1f\n", ns_old, cyc_old);
+   printf("  Spectrum      %9.1f   %10.1f\n", ns_new, cyc_new);
+   CHECK(sum_old == sum_new);
+   CHECK(cyc_new < cyc_old);
+   return (test_result("spectrum_test"));
+}
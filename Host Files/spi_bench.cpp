@@ -0,0 +1,93 @@
+/*****************************************************************//**
+ * @file spi_bench.cpp
+ *
+ * @brief spi bytes per second: per-byte transfer() vs transfer_block()
+ *        without and with the core fifos
+ *
+ * Description:
+ *  - 200 register reads of the ADXL362 model on ss_n[0], 194 bytes
+ *    each (command, address, 192 data bytes), at sclk 4 MHz (as
+ *    Adxl362) and 25 MHz, 4 and 16 system clocks per bus access
+ *  - transfer(): one call per byte, as the driver did before;
+ *    block, no fifo: transfer_block() on a core without fifos (as
+ *    HOST_NO_SPI_FIFO=1); block, fifo: transfer_block() with them
+ *  - wire: 8 sclk periods per byte at the sclk set_freq() gets (the
+ *    divisor rounds down), the upper bound
+ *  - time is virtual, at SYS_CLK_FREQ; every method must read the
+ *    same bytes
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstring>
+#include "chu_init.h"
+#include "spi_core.h"
+#include "host_test.h"
+
+enum {
+   REPS = 200,
+   N_DATA = 192,
+   N_BYTE = N_DATA + 2,
+   RD_CMD = 0x0b
+};
+
+// reads with one method; return bytes/s; rx gets the last read's data
+static double run(SpiCore *spi, int block, uint8_t *rx) {
+   const uint8_t cmd[2] = {RD_CMD, 0x00};
+   BusCount bus;
+
+   bus.start();
+   for (int r = 0; r < REPS; r++) {
+      spi->assert_ss(0);
+      if (block) {
+         spi->transfer_block(0, rx, N_DATA, cmd, 2);
+      } else {
+         spi->transfer(cmd[0]);
+         spi->transfer(cmd[1]);
+         for (int i = 0; i < N_DATA; i++)
+            rx[i] = spi->transfer(0x00);
+      }
+      spi->deassert_ss(0);
+   }
+   return ((double) REPS * N_BYTE * SYS_CLK_FREQ * 1e6 / bus.cycles());
+}
+
+int main() {
+   const int freq[2] = {4000000, 25000000};
+   const int io[2] = {4, 16};
+   uint8_t ref[N_DATA], rx[N_DATA];
+   double b_byte, b_nofifo, b_fifo, wire;
+
+   host_set_no_spi_fifo(1);
+   SpiCore *plain = new SpiCore(get_slot_addr(BRIDGE_BASE, S9_SPI));
+   CHECK(!plain->has_fifo());
+   host_set_no_spi_fifo(0);
+   SpiCore *spi = new SpiCore(get_slot_addr(BRIDGE_BASE, S9_SPI));
+   CHECK(spi->has_fifo());
+   printf("  sclk     clk/access   transfer()   block, no fifo   block, fifo      wire"
+          "   (KB/s)\n");
+   for (int k = 0; k < 4; k++) {
+      int f = freq[k % 2];
+      host_set_io_cycles(io[k / 2]);
+      spi->set_freq(f);
+      plain->set_freq(f);
+      b_byte = run(spi, 0, ref);
+      host_set_no_spi_fifo(1);
+      b_nofifo = run(plain, 1, rx);
+      CHECK(memcmp(rx, ref, N_DATA) == 0);
+      host_set_no_spi_fifo(0);
+      b_fifo = run(spi, 1, rx);
+      CHECK(memcmp(rx, ref, N_DATA) == 0);
+      CHECK(b_nofifo > b_byte && b_fifo > b_byte);
+      wire = SYS_CLK_FREQ * 1e6 / (16.0 * (SYS_CLK_FREQ * 1000000 / (2 * f)));
+      printf("  %2d MHz   %10d   %10.0f   %14.0f   %11.0f   %7.0f\n", f / 1000000, io[k / 2],
+             b_byte / 1000, b_nofifo / 1000, b_fifo / 1000, wire / 1000);
+   }
+   CHECK(ref[0] == 0xad && ref[2] == 0xf2);   // DEVID_AD, PARTID
+   host_set_io_cycles(4);
+   delete plain;
+   delete spi;
+   return (test_result("spi_bench"));
+}
@@ -0,0 +1,153 @@
+/*****************************************************************//**
+ * @file stroke_test.cpp
+ *
+ * @brief coverage and overdraw of Stroke/FrameCore::fill_capsule()
+ *
+ * Description:
+ *  - reference: a FrameCore::fillCircle() disc at every point of the
+ *    line between successive samples
+ *  - each stroke must cover exactly the reference pixels; the pixels
+ *    written (Stroke::total_pixels() and bus writes without the fill
+ *    engine) are compared with the area covered
+ *  - cases: slow straight stroke (radius 10, 40 samples 1 pixel
+ *    apart), fast zigzag, random walk with brush changes, stroke
+ *    against the frame edge, radius above BRUSH_R_MAX
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include <vector>
+#include "stroke.h"
+#include "host_test.h"
+
+struct Sample {
+   int x, y, r, color;
+};
+
+static const uint16_t WHITE = FrameCore::pack9(0xfff);
+
+static void blank(FrameCore *frame) {
+   frame->clr_screen(0x0f0);   // a different color first: nothing skipped
+   frame->clr_screen(0xfff);
+}
+
+static void grab(std::vector<uint16_t> &img) {
+   img.resize(FrameCore::HMAX * FrameCore::VMAX);
+   for (int y = 0; y < FrameCore::VMAX; y++)
+      for (int x = 0; x < FrameCore::HMAX; x++)
+         img[y * FrameCore::HMAX + x] = host_frame_pixel(x, y);
+}
+
+static int covered(const std::vector<uint16_t> &img) {
+   int n = 0;
+
+   for (size_t i = 0; i < img.size(); i++)
+      n += (img[i] != WHITE);
+   return (n);
+}
+
+// discs along the line from (x0, y0) to (x1, y1)
+static void ref_segment(FrameCore *frame, int x0, int y0, int x1, int y1, int r, int color) {
+   int dx = abs(x1 - x0), sx = (x0 < x1) ? 1 : -1;
+   int dy = -abs(y1 - y0), sy = (y0 < y1) ? 1 : -1;
+   int err = dx + dy, e2;
+
+   while (1) {
+      frame->fillCircle(x0, y0, r, color);
+      if (x0 == x1 && y0 == y1)
+         break;
+      e2 = 2 * err;
+      if (e2 >= dy) {
+         err += dy;
+         x0 += sx;
+      }
+      if (e2 <= dx) {
+         err += dx;
+         y0 += sy;
+      }
+   }
+}
+
+// draw a stroke both ways; return pixels written by the stroke engine
+static uint32_t run(FrameCore *frame, const char *name, const std::vector<Sample> &s,
+                    int expect_exact) {
+   std::vector<uint16_t> ref, img;
+   Stroke stroke(frame);
+   BusCount bus;
+   int area;
+
+   blank(frame);
+   for (size_t i = 0; i < s.size(); i++) {
+      if (i == 0)
+         ref_segment(frame, s[i].x, s[i].y, s[i].x, s[i].y, s[i].r, s[i].color);
+      else
+         ref_segment(frame, s[i - 1].x, s[i - 1].y, s[i].x, s[i].y, s[i].r, s[i].color);
+   }
+   grab(ref);
+   area = covered(ref);
+
+   blank(frame);
+   bus.start();
+   for (size_t i = 0; i < s.size(); i++)
+      stroke.draw(s[i].x, s[i].y, s[i].r, s[i].color);
+   stroke.lift();
+   grab(img);
+   CHECK(img == ref);
+   CHECK(bus.writes() <= stroke.total_pixels());   // less where tiles skip
+   if (expect_exact)
+      CHECK(stroke.total_pixels() == (uint32_t) area);
+   printf("  %-28s %4u segments %7u written %7d covered (%.2f)\n", name,
+          (unsigned) stroke.segments(), (unsigned) stroke.total_pixels(), area,
+          (double) stroke.total_pixels() / area);
+   return (stroke.total_pixels());
+}
+
+int main() {
+   std::vector<Sample> s;
+   uint32_t n;
+
+   host_set_no_blit(1);        // one bus write per pixel written
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+
+   // slow stroke: each segment adds one column of the disc
+   for (int i = 0; i < 40; i++)
+      s.push_back({200 + i, 200, 10, 0x001});
+   n = run(frame, "slow, r 10, 1 px steps", s, 1);
+   CHECK(n < 1200);
+
+   s.clear();
+   for (int i = 0; i < 12; i++)
+      s.push_back({150 + 25 * i, (i & 1) ? 150 : 260, 6, 0xf00});
+   run(frame, "fast zigzag, r 6", s, 0);
+
+   s.clear();
+   srand(7);
+   int x = 320, y = 240, r = 5, c = 0x00f;
+   for (int i = 0; i < 300; i++) {
+      x += rand() % 9 - 4;
+      y += rand() % 9 - 4;
+      if (i % 50 == 49)
+         r = 1 + rand() % FrameCore::BRUSH_R_MAX;
+      if (i % 70 == 69)
+         c = (c == 0x00f) ? 0xf00 : 0x00f;
+      s.push_back({x, y, r, c});
+   }
+   run(frame, "random walk, brush changes", s, 0);
+
+   s.clear();
+   for (int i = 0; i < 30; i++)
+      s.push_back({3 + i, 2 + i / 3, 12, 0x0f0});
+   run(frame, "along the frame corner", s, 0);
+
+   // no span table: one disc per line point; count is their area
+   s.clear();
+   s.push_back({320, 240, FrameCore::BRUSH_R_MAX + 5, 0x001});
+   n = run(frame, "single disc, r 25", s, 1);
+   s.push_back({322, 240, FrameCore::BRUSH_R_MAX + 5, 0x001});
+   CHECK(run(frame, "r 25, two more points", s, 0) == 3 * n);
+   delete frame;
+   return (test_result("stroke_test"));
+}
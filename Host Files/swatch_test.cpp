@@ -0,0 +1,144 @@
+/*****************************************************************//**
+ * @file swatch_test.cpp
+ *
+ * @brief 9-bit pixels of the palette swatches (pack9()/fill_dither())
+ *
+ * Description:
+ *  - draws the swatches of initialize_canvas() (frame color, canvas,
+ *    black/white/red and the seven rand() % 4094 colors main() picks)
+ *    with dithering off, then on
+ *  - off: every swatch pixel is the 3 MSBs of each 4-bit channel
+ *  - on: each 2-by-2 cell takes per channel one of the two 3-bit levels
+ *    around the 4-bit one (expanded as frame_palette_9 does, {a, a[2]});
+ *    the pattern repeats every 2 pixels, a cell averages to the 4-bit
+ *    level within 1/4 and a level exact in 9 bits stays a plain color
+ *  - the same checks on one swatch for all 4096 colors
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include "vga_core.h"
+#include "host_test.h"
+
+struct Swatch {
+   const char *name;
+   int x, y, w, h, color;
+};
+
+// 3-bit level expanded to 4 bits by frame_palette_9
+static int expand(int a) {
+   return ((a << 1) | (a >> 2));
+}
+
+// 9-bit pixel from the 3 MSBs of each channel, written out per channel
+static uint16_t msb9(int color) {
+   return (uint16_t) ((((color >> 9) & 7) << 6) | (((color >> 5) & 7) << 3) | ((color >> 1) & 7));
+}
+
+static int exact9(int color) {
+   for (int ch = 0; ch < 3; ch++) {
+      int v = (color >> (4 * ch)) & 0xf;
+      if (expand(v >> 1) != v)
+         return (0);
+   }
+   return (1);
+}
+
+static int plain_ok(const Swatch &s) {
+   for (int y = s.y; y < s.y + s.h; y++)
+      for (int x = s.x; x < s.x + s.w; x++)
+         if (host_frame_pixel(x, y) != msb9(s.color))
+            return (0);
+   return (1);
+}
+
+// dithered swatch; cell receives the pixels at even/odd x and y
+static int dither_ok(const Swatch &s, uint16_t cell[2][2]) {
+   int x, y, ch, v, a, lo, sum;
+
+   for (y = 0; y < 2; y++)
+      for (x = 0; x < 2; x++)
+         cell[(s.y + y) & 1][(s.x + x) & 1] = host_frame_pixel(s.x + x, s.y + y);
+   for (y = s.y; y < s.y + s.h; y++)
+      for (x = s.x; x < s.x + s.w; x++)
+         if (host_frame_pixel(x, y) != cell[y & 1][x & 1])
+            return (0);
+   for (ch = 0; ch < 3; ch++) {
+      v = (s.color >> (4 * ch)) & 0xf;
+      for (lo = 7; expand(lo) > v; lo--)
+         ;
+      sum = 0;
+      for (y = 0; y < 2; y++)
+         for (x = 0; x < 2; x++) {
+            a = (cell[y][x] >> (3 * ch)) & 7;
+            if (a != lo && !(a == lo + 1 && expand(lo) != v))
+               return (0);
+            sum += expand(a);
+         }
+      if (abs(sum - 4 * v) > 1)   // average within 1/4 of the level
+         return (0);
+   }
+   if (exact9(s.color))
+      return (cell[0][0] == cell[0][1] && cell[0][0] == cell[1][0] && cell[0][0] == cell[1][1]);
+   return (1);
+}
+
+int main() {
+   Swatch sw[] = {
+      {"frame",  0,   0,   30,  60,  0xA8B},
+      {"canvas", 100, 70,  440, 340, 0xfff},
+      {"black",  39,  251, 13,  13,  0x001},
+      {"red",    69,  251, 13,  13,  0xf00},
+      {"orange", 39,  271, 13,  13,  0},
+      {"yellow", 69,  271, 13,  13,  0},
+      {"green",  39,  291, 13,  13,  0},
+      {"blue",   69,  291, 13,  13,  0},
+      {"purple", 39,  311, 13,  13,  0},
+      {"pink",   69,  311, 13,  13,  0},
+      {"brown",  39,  331, 13,  13,  0},
+      {"white",  69,  331, 13,  13,  0xfff}
+   };
+   const int N = sizeof(sw) / sizeof(sw[0]);
+   uint16_t cell[2][2];
+   int i, c, bad_plain = 0, bad_dither = 0;
+
+   srand(0);   // as main(): srand(NULL), one value skipped, color1..color7
+   rand();
+   for (i = 4; i < 11; i++)
+      sw[i].color = rand() % 4094;
+
+   host_set_no_blit(1);
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+   printf("  swatch  color  pack9  dither cells\n");
+   for (i = 0; i < N; i++) {
+      frame->set_dither(0);
+      frame->fillRect(sw[i].x, sw[i].y, sw[i].w, sw[i].h, sw[i].color);
+      CHECK(FrameCore::pack9(sw[i].color) == msb9(sw[i].color));
+      CHECK(plain_ok(sw[i]));
+      frame->set_dither(1);
+      frame->fillRect(sw[i].x, sw[i].y, sw[i].w, sw[i].h, sw[i].color);
+      CHECK(dither_ok(sw[i], cell));
+      printf("  %-7s %03x    %03x    %03x %03x %03x %03x\n", sw[i].name, sw[i].color,
+             FrameCore::pack9(sw[i].color), cell[0][0], cell[0][1], cell[1][0], cell[1][1]);
+   }
+
+   // every 12-bit color on the red swatch
+   for (c = 0; c < 4096; c++) {
+      Swatch s = {"all", 69, 251, 13, 13, c};
+
+      frame->set_dither(0);
+      frame->fillRect(s.x, s.y, s.w, s.h, c);
+      bad_plain += (FrameCore::pack9(c) != msb9(c) || !plain_ok(s));
+      frame->set_dither(1);
+      frame->fillRect(s.x, s.y, s.w, s.h, c);
+      bad_dither += !dither_ok(s, cell);
+   }
+   printf("  all 4096 colors: %d plain, %d dithered mismatches\n", bad_plain, bad_dither);
+   CHECK(bad_plain == 0);
+   CHECK(bad_dither == 0);
+   delete frame;
+   return (test_result("swatch_test"));
+}
@@ -0,0 +1,45 @@
+#!/bin/sh
+#
+# bus writes of a recorded drawing session with and without the
+# FrameCore tile tracker
+#
+# usage (from the repository root): sh "Host Files/tile_replay.sh" [build dir]
+#  - builds the program twice: as is and with -D_NO_TILE_TRACK
+#  - replays session.txt with each, with the fill engine and without
+#    it (HOST_NO_BLIT=1)
+#  - writes: between the "stats" lines before and after the session
+#  - exit code: 0 if all four runs leave the same frame
+#
+B=${1:-host_build}
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++14 -O2 -D_HOST_IO_USED -Wno-int-to-pointer-cast"
+SCRIPT="$(pwd)/Host Files/session.txt"
+
+mkdir -p "$B" || exit 1
+for v in track notrack; do
+   [ $v = notrack ] && def=-D_NO_TILE_TRACK || def=
+   $CXX $CXXFLAGS $def -I"Driver Files" -I"Host Files" "Driver Files"/*.cpp \
+      "Host Files"/host_io.cpp "Main File/main.cpp" -o "$B/pixelpoet_$v" || exit 1
+done
+
+printf "  %-12s %-9s %12s\n" "frame buffer" "tiles" "writes"
+for nb in 0 1; do
+   for v in track notrack; do
+      d="$B/replay_${v}_$nb"
+      mkdir -p "$d" || exit 1
+      (cd "$d" && HOST_NO_BLIT=$nb HOST_SCRIPT="$SCRIPT" "../pixelpoet_$v" > console.log 2> stats.log)
+      w=$(awk '/^host:/ { if (n++ == 0) first = $6; last = $6 } END { print last - first }' "$d/stats.log")
+      [ $nb = 0 ] && fb=engine || fb="no engine"
+      printf "  %-12s %-9s %12s\n" "$fb" "$v" "$w"
+   done
+done
+
+fail=0
+for d in "$B"/replay_notrack_0 "$B"/replay_track_1 "$B"/replay_notrack_1; do
+   if ! cmp -s "$B/replay_track_0/session.ppm" "$d/session.ppm"; then
+      echo "FAIL $d/session.ppm differs"
+      fail=1
+   fi
+done
+[ $fail -eq 0 ] && echo "tile_replay: frames identical"
+[ $fail -eq 0 ]
@@ -0,0 +1,66 @@
+#!/bin/sh
+#
+# slow uart consumer: task run times and dropped console messages with
+# the waiting uart output and with the transmit buffer
+#
+# usage (from the repository root): sh "Host Files/uart_replay.sh" [build dir]
+#  - builds the program twice: as is (paint path under TX_DROP) and
+#    with -D_UART_DIRECT (every byte waits for room in the uart fifo)
+#  - replays uart_clicks.txt with each: 150 mouse updates, each
+#    printing "CLICK COLOR Red", at about 1.8 times the rate 9600 baud
+#    drains
+#  - prints the longest run of the mouse and frame tasks, the messages
+#    that arrived intact, and the bytes the buffer dropped (whole
+#    messages); direct output drops nothing, but the mouse task stalls
+#    and the packets that arrive meanwhile merge into fewer updates
+#  - exit code: 0 if no message arrived mangled, every buffered update
+#    either printed its message or counted it as dropped, and the
+#    buffered mouse task never waited as long as the direct one
+#
+B=${1:-host_build}
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++14 -O2 -D_HOST_IO_USED -Wno-int-to-pointer-cast"
+SCRIPT="$(pwd)/Host Files/uart_clicks.txt"
+MSG="CLICK COLOR Red"
+N_MSG=150
+
+mkdir -p "$B" || exit 1
+for v in buffered direct; do
+   [ $v = direct ] && def=-D_UART_DIRECT || def=
+   $CXX $CXXFLAGS $def -I"Driver Files" -I"Host Files" "Driver Files"/*.cpp \
+      "Host Files"/host_io.cpp "Main File/main.cpp" -o "$B/pixelpoet_$v" || exit 1
+done
+
+fail=0
+printf "  %-9s %14s %14s %8s %14s\n" "uart" "mouse max us" "frame max us" "intact" "dropped bytes"
+for v in buffered direct; do
+   d="$B/uart_$v"
+   mkdir -p "$d" || exit 1
+   (cd "$d" && HOST_SCRIPT="$SCRIPT" "../pixelpoet_$v" > console.log 2> stats.log)
+   tr -d '\r' < "$d/console.log" > "$d/console.txt"
+   mouse=$(awk '$1 == "mouse" { sub("max=", "", $5); print $5 }' "$d/console.txt")
+   frame=$(awk '$1 == "frame" { sub("max=", "", $5); print $5 }' "$d/console.txt")
+   drop=$(awk '/^uart tx:/ { print $6 }' "$d/console.txt")
+   intact=$(grep -c "^$MSG\$" "$d/console.txt")
+   mangled=$(grep "CLICK" "$d/console.txt" | grep -vc "^$MSG\$")
+   printf "  %-9s %14s %14s %8s %14s\n" $v "$mouse" "$frame" "$intact" "$drop"
+   if [ "$mangled" -ne 0 ]; then
+      echo "FAIL $v: $mangled mangled lines"
+      fail=1
+   fi
+   if [ $v = buffered ] && { [ $((intact + drop / 17)) -ne $N_MSG ] || [ $((drop % 17)) -ne 0 ]; }; then
+      echo "FAIL $v: $intact intact + $drop bytes dropped, $N_MSG updates"
+      fail=1
+   fi
+   if [ $v = direct ] && [ "$drop" -ne 0 ]; then
+      echo "FAIL $v: $drop bytes dropped"
+      fail=1
+   fi
+   eval "mouse_$v=$mouse"
+done
+if [ "$mouse_buffered" -ge "$mouse_direct" ]; then
+   echo "FAIL buffered mouse task not faster"
+   fail=1
+fi
+[ $fail -eq 0 ] && echo "uart_replay: no message mangled or lost uncounted"
+[ $fail -eq 0 ]
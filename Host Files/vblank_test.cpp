@@ -0,0 +1,102 @@
+/*****************************************************************//**
+ * @file vblank_test.cpp
+ *
+ * @brief FrameCore::frame_count()/in_vblank()/wait_vblank() against
+ *        the beam of the frame buffer model
+ *
+ * Description:
+ *  - beam: 800-by-525 scan at 4 system clocks per pixel; lines 480 to
+ *    524 are the vertical blanking interval and the frame count steps
+ *    when it starts
+ *  - the beam position of each status read is taken from the virtual
+ *    clock before and after the read; reads whose window spans a
+ *    vblank edge are not judged
+ *  - polling over 10 frames: in_vblank() matches the beam on every
+ *    read; frame_count() steps by 1 once per frame, at vblank start
+ *  - wait_vblank() from random points in the frame: returns within one
+ *    frame period, in vblank, one frame later
+ *
+ * Build: see run_tests.sh
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdlib>
+#include "chu_init.h"
+#include "vga_core.h"
+#include "host_test.h"
+
+enum {
+   LINE_CYCLES = 800 * 4,
+   FRAME_CYCLES = 525 * LINE_CYCLES,
+   VBLANK_START = 480 * LINE_CYCLES
+};
+
+// beam in vblank at virtual clock c
+static int beam_vblank(uint64_t c) {
+   return ((c % FRAME_CYCLES) >= VBLANK_START);
+}
+
+// # vblank starts up to virtual clock c
+static uint64_t beam_frames(uint64_t c) {
+   return ((c + FRAME_CYCLES - VBLANK_START) / FRAME_CYCLES);
+}
+
+int main() {
+   FrameCore *frame = new FrameCore(FRAME_BASE);
+   uint64_t c0, c1, t0, f0;
+   uint32_t n, n0, last;
+   int v, steps = 0, bad_vblank = 0, bad_count = 0, judged = 0;
+   int i, line, bad_wait = 0;
+
+   // polling
+   t0 = host_cycles();
+   f0 = beam_frames(t0);
+   last = frame->frame_count();
+   n0 = last;
+   while (host_cycles() - t0 < 10ULL * FRAME_CYCLES) {
+      c0 = host_cycles();
+      v = frame->in_vblank();
+      c1 = host_cycles();
+      if (beam_vblank(c0) == beam_vblank(c1)) {
+         judged++;
+         bad_vblank += (v != beam_vblank(c1));
+      }
+      c0 = host_cycles();
+      n = frame->frame_count();
+      c1 = host_cycles();
+      if (n != last) {
+         steps++;
+         bad_count += (n != last + 1);   // one step per frame
+         bad_count += (beam_frames(c0) == beam_frames(c1) && !beam_vblank(c1));
+      }
+      if (beam_frames(c0) == beam_frames(c1))
+         bad_count += ((n - n0) != (uint32_t) (beam_frames(c1) - f0));
+      last = n;
+   }
+   printf("  polled 10 frames: %d reads judged, %d frame steps\n", judged, steps);
+   CHECK(bad_vblank == 0);
+   CHECK(bad_count == 0);
+   CHECK((uint64_t) steps == beam_frames(c1) - f0);
+
+   // wait_vblank() from random points of the frame
+   srand(12);
+   for (i = 0; i < 50; i++) {
+      sleep_us(rand() % 17000);
+      n = frame->frame_count();
+      c0 = host_cycles();
+      if (!frame->wait_vblank()) {
+         bad_wait++;
+         continue;
+      }
+      c1 = host_cycles();
+      line = (int) ((c1 % FRAME_CYCLES) / LINE_CYCLES);
+      if (!frame->in_vblank() || line < 480 || c1 - c0 > FRAME_CYCLES
+            || frame->frame_count() != n + 1 || beam_frames(c1) != beam_frames(c0) + 1)
+         bad_wait++;
+   }
+   printf("  wait_vblank() 50 times: %d bad\n", bad_wait);
+   CHECK(bad_wait == 0);
+   delete frame;
+   return (test_result("vblank_test"));
+}
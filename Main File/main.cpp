@@ -15,6 +15,17 @@
 #include "xadc_core.h"
 #include "ps2_core.h"
 #include "spi_core.h"
+#include "adxl362.h"
+#include "shake.h"
+#include "spectrum.h"
+#include "stroke.h"
+#include "flood.h"
+#include "journal.h"
+#include "xfer.h"
+#include "pointer.h"
+#include "sched.h"
+#include "io_prof.h"
+#include "trace.h"
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -74,11 +85,11 @@ void frame_check(FrameCore *frame_p) {
 
    frame_p->bypass(0);
    for (int i = 0; i < 10; i++) {
-      frame_p->clr_screen(0x008);  // dark green
+      frame_p->clr_screen(0x040);  // dark green
       for (int j = 0; j < 20; j++) {
          x = rand() % 640;
          y = rand() % 480;
-         color = rand() % 512;
+         color = rand() % 4096;
          frame_p->plot_line(400, 200, x, y, color);
       }
       sleep_ms(300);
@@ -147,124 +158,12 @@ void ghost_check(SpriteCore *ghost_p) {
 
 /* CANVAS FUNCTIONS */
 
-double pot_value_color(XadcCore *adc_p) { // read potentiometer value for RGB LED spectrum color
-   double reading;
+uint32_t pot_update(XadcCore *adc_p) { // read both potentiometers; returns the ones that moved (bit 0: color, bit 1: brush)
+   IO_PROF_SCOPE("pot");
 
-   reading = adc_p->read_adc_in(0);
-   return reading;
-
-}
-
-double pot_value_brush(XadcCore *adc_p) { // read potentiometer value for brush size
-   double reading;
-
-   reading = adc_p->read_adc_in(1);
-   return reading;
-
-}
-
-double map(double mag, double in_min, double in_max, double out_min, double out_max) {
-
-   return ((mag) - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
-}
-
-uint16_t map_rgb(double mag, double in_min, double in_max, double out_min, double out_max) {
-
-   return (uint16_t)((mag - in_min) * (out_max - out_min) / (in_max - in_min) + out_min);
+   return (adc_p->update(0x3));
 }
 
-
-void spectrum(PwmCore *pwm_p, double duty_pot, double *r, double *g, double *b) {   // function for RGB LED spectrum
-   double red, green, blue;
-
-   pwm_p->set_freq(50); // set frequency to 50
-
-	if (duty_pot >= 0.0 && duty_pot <= (1.0/6.0)) { // section 1 of pot
-		pwm_p->set_duty(1.0, 2);   // red is maxed
-      red = 0.999;
-
-		pwm_p->set_duty(map(duty_pot, 0, (1.0/6.0), 0.0, 1.0), 1);  // green is varied (increasing)
-      green = map(duty_pot, 0, (1.0/6.0), 0.03, 0.999);
-
-		pwm_p->set_duty(0.0, 0);   // blue is off
-      blue = 0.03;
-
-
-	}
-	else if(duty_pot > (1.0/6.0) && duty_pot <= (2.0/6.0)) { // section 2 of pot
-		pwm_p->set_duty(map(duty_pot, (1.0/6.0), (2.0/6.0), 1.0, 0.0), 2);   // red is varied (decreasing)
-      red = map(duty_pot, (1.0/6.0), (2.0/6.0), 0.999, 0.03);
-
-		pwm_p->set_duty(1.0, 1);   // green is maxed
-      green = 0.999;
-
-		pwm_p->set_duty(0.0, 0);   // blue is off
-      blue = 0.03;
-      
-
-		if(duty_pot >= 0.33) {
-			pwm_p->set_duty(0.0, 2);   // smooth transitions
-		}
-	}
-   else if(duty_pot > (2.0/6.0) && duty_pot <= (3.0/6.0)) { // section 3 of pot
-		pwm_p->set_duty(0.0, 2);   // red is off
-      red = 0.03;
-
-		pwm_p->set_duty(1.0, 1);   // green is maxed
-      green = 0.999;
-
-		pwm_p->set_duty(map(duty_pot, (2.0/6.0), (3.0/6.0), 0.0, 1.0), 0);   // blue is varied (increasing)
-      blue = map(duty_pot, (2.0/6.0), (3.0/6.0), 0.03, 0.999);
-
-	}
-   else if(duty_pot > (3.0/6.0) && duty_pot <= (4.0/6.0)) { // section 4 of pot
-		pwm_p->set_duty(0.0, 2);   // red is off
-      red = 0.03;
-
-		pwm_p->set_duty(map(duty_pot, (3.0/6.0), (4.0/6.0), 1.0, 0.0), 1);   // green is varied (increasing)
-      green = map(duty_pot, (3.0/6.0), (4.0/6.0), 0.999, 0.03);
-
-		pwm_p->set_duty(1.0, 0);   // blue is maxed
-      blue = 0.999;
-
-
-		if(duty_pot >= 0.66) {
-			pwm_p->set_duty(0.0, 1);   // smooth transitions
-		}
-	}
-   else if(duty_pot > (4.0/6.0) && duty_pot <= (5.0/6.0)) { // section 5 of pot
-		pwm_p->set_duty(map(duty_pot, (4.0/6.0), (5.0/6.0), 0.0, 1.0), 2);   // red is varied (increasing)
-      red = map(duty_pot, (4.0/6.0), (5.0/6.0), 0.03, 0.999);
-
-		pwm_p->set_duty(0.0, 1);   // green is off
-      green = 0.03;
-
-		pwm_p->set_duty(1.0, 0);   // blue is maxed
-      blue = 0.999;
-
-	}
-   else if(duty_pot > (5.0/6.0) && duty_pot <= 9.999) {// section 6 of pot
-      pwm_p->set_duty(1.0, 2);   // red is maxed
-      red = 0.999;
-
-      pwm_p->set_duty(0.0, 1);   // green is off
-      green = 0.03;
-
-      pwm_p->set_duty(map(duty_pot, (5.0/6.0), 1.0, 1.0, 0.0), 0);   // blue is varied (decreasing)
-      blue = map(duty_pot, (5.0/6.0), 1.0, 0.999, 0.03);
-
-
-	}
-
-
-   // return RGB values
-   *r = red;
-   *g = green;
-   *b = blue;
-
-}
-
-
 int ps2_init(Ps2Core *ps2_p) {   // initialize ps2 by getting device ID
    int id;
    uart.disp("\n\rPS2 device (1-keyboard / 2-mouse): ");
@@ -274,19 +173,19 @@ int ps2_init(Ps2Core *ps2_p) {   // initialize ps2 by getting device ID
    return id;
 }
 
-int canvas_mouse(Ps2Core *ps2_p, SsegCore *sseg_p, int id, int *btn_left, int *btn_right, int *xcord, int *ycord) {  // get mouse data
-   int lbtn, rbtn, xmov, ymov;
+int canvas_mouse(PointerMotion *pointer_p, int id, int *btn_left, int *btn_right, int *x, int *y) {  // get mouse data
+   IO_PROF_SCOPE("mouse");
 
       if(id == 2) {
-         if (ps2_p->get_mouse_activity(&lbtn, &rbtn, &xmov, &ymov)) {   // if mouse data is valid
+         if (pointer_p->update()) {   // if queued packets moved the cursor or changed the buttons
             // get the mouse data
-            *btn_left = lbtn;
-            *btn_right = rbtn;
-            *xcord = xmov;
-            *ycord = ymov;
+            *btn_left = pointer_p->lbtn();
+            *btn_right = pointer_p->rbtn();
+            *x = pointer_p->x();
+            *y = pointer_p->y();
 
             return 1;
-         }   // end get_mouse_activitiy()
+         }   // end update()
          else {
             return 0;
          }
@@ -294,60 +193,12 @@ int canvas_mouse(Ps2Core *ps2_p, SsegCore *sseg_p, int id, int *btn_left, int *b
       }
       else
          return 0;
-   
-   
 
 }
 
-void move_brush (SpriteCore *mouse_p, int btn_x, int btn_y, int *x, int *y) { // function to move brush around the screen based on the mouse data
-   //
-   int xx = *x;
-   int yy = *y;
+void move_brush (SpriteCore *mouse_p, int x, int y) { // function to move brush sprite to the cursor position
    mouse_p->bypass(0);  // do not bypass the mouse
-   mouse_p->move_xy(xx, yy);  // move the mouse sprite to the x/y position
-
-   // mouse movement based on sign of mouse data
-   if(btn_x > 0) {
-      xx = xx + 4;  // if moving mouse to the right (data x is positive), then cursor position x will increase 
-   }
-   else if (btn_x < 0) {
-      xx = xx - 4;   // if moving mouse to left (data x is negative), then cursor position x will decrease
-   }
-   else {
-      xx = xx; // dont move if mouse isnt moving
-   }
-   
-   if(btn_y > 0) {
-      yy = yy - 4;  // if moving mouse up (data y is positive), then cursor position y will decrease (since y decrements upward) 
-   }
-   else if (btn_y < 0) {
-      yy = yy + 4;   // if moving mouse down (data y is negative), then cursor position y will increase (since y increments downward) 
-   }
-   else {
-      yy = yy; // dont move if mouse isnt moving
-   }
-
-
-   // Checking if cursor exceeds the boundaries... if so, stop at boundary
-   if(xx >= 630) {
-      xx = 630;
-   }
-
-   if(xx <= 0) {
-      xx = 0;
-   }
-
-   if(yy >= 450) {
-      yy = 450;
-   }
-
-   if(yy <= 0) {
-      yy = 0;
-   }
-
-   *x = xx;
-   *y = yy;
-
+   mouse_p->move_xy(x, y);  // move the mouse sprite to the x/y position
 }
 
 void trademark(OsdCore *osd_p) {
@@ -406,6 +257,24 @@ void trademark(OsdCore *osd_p) {
    osd_p->wr_char(8, 24, 97);   // a
    osd_p->wr_char(9, 24, 114);  // r
 
+   // Fill button
+   osd_p->wr_char(6, 26, 70);   // F
+   osd_p->wr_char(7, 26, 105);  // i
+   osd_p->wr_char(8, 26, 108);  // l
+   osd_p->wr_char(9, 26, 108);  // l
+
+   // Undo button
+   osd_p->wr_char(71, 6, 85);   // U
+   osd_p->wr_char(72, 6, 110);  // n
+   osd_p->wr_char(73, 6, 100);  // d
+   osd_p->wr_char(74, 6, 111);  // o
+
+   // Redo button
+   osd_p->wr_char(71, 8, 82);   // R
+   osd_p->wr_char(72, 8, 101);  // e
+   osd_p->wr_char(73, 8, 100);  // d
+   osd_p->wr_char(74, 8, 111);  // o
+
 }
 
 void welcome_msg_off(OsdCore *osd_p) {
@@ -437,6 +306,7 @@ void welcome_msg_off(OsdCore *osd_p) {
 }
 
 void welcome_msg(OsdCore *osd_p) {  // function to display a welcome message
+   TRACE_SCOPE("welcome");
    osd_p->set_color(0x111, 0x000);  // set foreground to black and background to transparent
    osd_p->bypass(0); // do not bypass OSD
    osd_p->clr_screen(); // clear screen initially
@@ -520,6 +390,8 @@ void welcome_msg(OsdCore *osd_p) {  // function to display a welcome message
 }
 
 void initialize_canvas(FrameCore *frame_p, int color0, int color1, int color2, int color3, int color4, int color5, int color6, int color7) { // function to initialize screen to white canvas
+   IO_PROF_SCOPE("canvas");
+   TRACE_SCOPE("canvas");
    frame_p->clr_screen(0xA8B);  // frame color
    frame_p->bypass(0);  // do not bypass frame buffer
    frame_p->fillRect(100, 70, 440, 340, 0xfff); // white canvas drawing area
@@ -567,80 +439,58 @@ void initialize_canvas(FrameCore *frame_p, int color0, int color1, int color2, i
    frame_p->fillRect(69, 331, 13, 13, 0xfff);
 
 
-   frame_p->drawRect(37, 382, 45, 20, 0x001);
+   frame_p->drawRect(37, 382, 45, 20, 0x001);   // clear button
+
+   frame_p->drawRect(37, 414, 45, 20, 0x001);   // fill button
+
+   frame_p->drawRect(560, 94, 45, 20, 0x001);   // undo button
+   frame_p->drawRect(560, 126, 45, 20, 0x001);  // redo button
 
 }
 
 void color_palette(FrameCore *frame_p, int color) {
+   IO_PROF_SCOPE("palette");
    frame_p->fillCircle(60, 110, 29, color);
 }
 
-uint16_t map_brush(float mag, float in_min, float in_max, int out_min, int out_max) {
+int map_brush(int raw) { // 12-bit brush pot reading to a brush radius of 1-20 (0.03-0.999 of full scale spans 1-20)
+   int size;
 
-   return (uint16_t)((mag - in_min) * (out_max - out_min) / (in_max - in_min) + out_min);
+   size = 1 + ((raw - 123) * 19) / 3969;
+   if (size < 1)
+      size = 1;
+   if (size > 20)
+      size = 20;
+   return size;
 }
 
-void draw_brush(FrameCore *frame_p, int x, int y, int color, int size) {   // function for drawing
-   frame_p->fillCircle(x, y, size, color);   // call fillCircle function with passed parameters
+void draw_brush(Journal *journal_p, int x, int y, int color, int size, int erase) {   // function for drawing
+   IO_PROF_SCOPE("brush");
+   TRACE_SCOPE("brush");
+   journal_p->draw(x, y, size, color, erase);   // sweep the brush from its previous position to (x, y) and record it
 }
 
-float tapper(SpiCore *spi_p) {   // function to get accelerometer reading from board
-
-   const uint8_t RD_CMD = 0x0b;
-   const uint8_t PART_ID_REG = 0x02;
-   const uint8_t DATA_REG = 0x08;
-   const float raw_max = 127.0 / 2.0;  //128 max 8-bit reading for +/-2g
-
-   int8_t xraw, yraw, zraw;
-   float x, y, z;
-   int id;
-   float mag;
-
-   spi_p->set_freq(400000);
-   spi_p->set_mode(0, 0);
-   // check part id
-   spi_p->assert_ss(0);    // activate
-   spi_p->transfer(RD_CMD);  // for read operation
-   spi_p->transfer(PART_ID_REG);  // part id address
-   id = (int) spi_p->transfer(0x00);
-   spi_p->deassert_ss(0);
-   // uart.disp("read ADXL362 id (should be 0xf2): ");
-   // uart.disp(id, 16);
-   // uart.disp("\n\r");
-   // read 8-bit x/y/z g values once
-   spi_p->assert_ss(0);    // activate
-   spi_p->transfer(RD_CMD);  // for read operation
-   spi_p->transfer(DATA_REG);  //
-   xraw = spi_p->transfer(0x00);
-   yraw = spi_p->transfer(0x00);
-   zraw = spi_p->transfer(0x00);
-   spi_p->deassert_ss(0);
-   x = (float) xraw / raw_max;
-   if(x < 0)
-      x = -x;
-   y = (float) yraw / raw_max;
-   if(y < 0)
-      y = -y;
-   z = (float) zraw / raw_max;
-   if(z < 0)
-      z = -z;
-
-   mag = x + y + z;
-
-   return mag;
-   
+void bucket_fill(Journal *journal_p, int x, int y, int color) {  // fill the canvas region under the cursor
+   IO_PROF_SCOPE("fill");
+   TRACE_SCOPE("fill");
+   journal_p->fill(x, y, color);
 }
 
 void select(FrameCore *frame_p, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+   IO_PROF_SCOPE("select");
    frame_p->drawRect(x, y, w, h, color);
 }
 
 
-
 // external core instantiation
 GpoCore led(get_slot_addr(BRIDGE_BASE, S2_LED));
 GpiCore sw(get_slot_addr(BRIDGE_BASE, S3_SW));
 FrameCore frame(FRAME_BASE);
+Stroke stroke(&frame);
+FloodFill flood(&frame);
+CanvasSnap snap(&frame);
+Journal journal(&frame, &stroke, &flood);
+CanvasXfer xfer(&frame, &uart);
 GpvCore bar(get_sprite_addr(BRIDGE_BASE, V7_BAR));
 GpvCore gray(get_sprite_addr(BRIDGE_BASE, V6_GRAY));
 SpriteCore ghost(get_sprite_addr(BRIDGE_BASE, V3_GHOST), 1024);
@@ -649,283 +499,430 @@ OsdCore osd(get_sprite_addr(BRIDGE_BASE, V2_OSD));
 SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
 
 Ps2Core ps2(get_slot_addr(BRIDGE_BASE, S11_PS2));
+PointerMotion pointer(&ps2, 630, 450);
 XadcCore adc(get_slot_addr(BRIDGE_BASE, S5_XDAC));
 PwmCore pwm(get_slot_addr(BRIDGE_BASE, S6_PWM));
+Spectrum spectrum(&pwm);   // color pot to rgb led and brush color
 SpiCore spi(get_slot_addr(BRIDGE_BASE, S9_SPI));
+Adxl362 accel(&spi, 0);
+ShakeDetector shake(100);   // accelerometer samples at 100 Hz
+Scheduler sched;
+
+// application state (shared by the tasks below)
+int id;        // ps2 device id
+int x = 320;   // x coordinate position of the mouse (initialized to center of screen)
+int y = 240;   // y coordinate position ofthe mouse (initialized to center of screen)
+int btn_left, btn_right = 0; // take mouse info and use to move sprite, etc
+uint16_t color = 0;  // RGB values concatenated together R-G-B: 4-4-4
+uint16_t palette_shown = 0xffff;  // color last drawn in the palette circle (none yet)
+int brush_size = 5;  // brush size when drawing circles (initialized to radius of 5)
+int welcome_on = 1;  // welcome message still displayed
+int fill_mode = 0;   // 1: left click in the canvas fills a region instead of painting
+int btn_left_old = 0;   // left button state of the previous update (click edges)
+const int FAST_BAUD = 115200;   // console rate for canvas transfers ('b')
+int fast_baud = 0;   // 1: console runs at FAST_BAUD
+
+int frame_paced = 0;     // 1: apply cursor updates and redraws in vertical blanking
+uint32_t last_frame = 0; // frame count of the last paced update
+int mouse_pending = 0;   // a cursor update is waiting to be applied
+int pend_x, pend_y, pend_left, pend_right;   // the pending update
+
+int accel_log = 0;   // 1: print accelerometer samples (a trace for Host Files/shake_replay)
+
+int color0 = 0xf00;
+int color1, color2, color3, color4, color5, color6, color7;   // random palette colors
+
+/* TASKS */
+
+void console(int cmd) { // handle a uart console command
+   if (cmd == 's') { // print task statistics
+      sched.dump();
+      uart.disp("uart tx: peak ");
+      uart.disp(uart.tx_peak());
+      uart.disp(" dropped ");
+      uart.disp((int) uart.tx_dropped());
+      uart.disp("\n\raccel poll: ");
+      uart.disp(accel.last_bytes());
+      uart.disp(" bytes ");
+      uart.disp((int) accel.last_us());
+      uart.disp(" us\n\r");
+   }
+   if (cmd == 'v') { // toggle frame-paced updates
+      frame_paced = !frame_paced;
+      uart.disp(frame_paced ? "frame paced\n\r" : "not paced\n\r");
+   }
+   if (cmd == 'a') { // toggle the accelerometer trace (at 9600 baud, lines are dropped; use 'b')
+      accel_log = !accel_log;
+      uart.disp(accel_log ? "# acl trace on\n\r" : "# acl trace off\n\r");
+   }
+   if (cmd == 'u')   // undo
+      journal.undo();
+   if (cmd == 'y')   // redo
+      journal.redo();
+   if (cmd == 'j')   // print journal memory use
+      journal.dump();
+   if (cmd == 'b') { // toggle the console baud rate
+      fast_baud = !fast_baud;
+      uart.disp(fast_baud ? "baud 115200\n\r" : "baud 9600\n\r");
+      uart.flush();
+      while (!uart.tx_fifo_empty()) {
+      };  // let the message go out at the old rate
+      uart.set_baud_rate(fast_baud ? FAST_BAUD : 9600);
+   }
+   if (cmd == 'x') { // export the canvas
+      journal.lift();
+      xfer.send();
+      uart.disp("\n\rexport ");
+      uart.disp(xfer.last_bytes());
+      uart.disp(" bytes ");
+      uart.disp((int) (xfer.last_us() / 1000));
+      uart.disp(" ms\n\r");
+   }
+   if (cmd == 'i') { // import a canvas
+      int st;
+      journal.lift();
+      uart.disp("import: send image\n\r");
+      uart.flush();  // prompt goes out before the loop below takes over
+      st = xfer.receive(10000);
+      if (xfer.last_bytes() > 8)
+         journal.restart();   // canvas may have been painted: undo stops here
+      uart.disp(st == CanvasXfer::XFER_OK ? "import ok " : "import failed ");
+      uart.disp(st);
+      uart.disp(" ");
+      uart.disp(xfer.last_bytes());
+      uart.disp(" bytes\n\r");
+   }
+#ifdef _IO_PROFILE
+   if (cmd == 'p')   // print bus transaction profile
+      io_prof_dump();
+   if (cmd == 'c')   // clear bus transaction profile
+      io_prof_clear();
+#endif
+#ifdef _TRACE
+   if (cmd == 't')   // print section timing
+      trace_dump();
+   if (cmd == 'r')   // reset section timing
+      trace_clear();
+#endif
+}
 
-int main() {
+void task_pots() {   // 50 Hz: color and brush potentiometers
+   uint32_t moved = pot_update(&adc);  // filtered readings that moved past the hysteresis band
 
-   srand(NULL);
-   int id = ps2_init(&ps2);   // grab mouse ID
-   int x = 320;   // x coordinate position of the mouse (initialized to center of screen)
-   int y = 240;   // y coordinate position ofthe mouse (initialized to center of screen)
-   int btn_left, btn_right, xcord, ycord = 0; // take mouse info and use to move sprite, etc
-   double r, g, b = 0.0;   // RGB values from the spectrum function
-   uint16_t rint, gint, bint; // RGB values converted to uint from double
-   uint16_t color = 0;  // RGB values concatenated together R-G-B: 4-4-4
-   int brush_size = 5;  // brush size when drawing circles (initialized to radius of 5)
-
-   float mag_old = 0;   // previous magnitude of accelerometerreading (initialized to 0)
-   float spike;   // spike value of accelerometer (the difference between the new and old magnitudes)
-
-   double colorpot_old = 0.0;
-   double brushpot_old = 0.0;
-   bool colorpotflag = false;
-   bool brushpotflag = false;
-
-   int color0 = 0xf00;
-   int temporary = rand() % 4094;
-   int color1 = rand() % 4094;
-   int color2 = rand() % 4094;
-   int color3 = rand() % 4094;
-   int color4 = rand() % 4094;
-   int color5 = rand() % 4094;
-   int color6 = rand() % 4094;
-   int color7 = rand() % 4094;
+   if(moved & 0x1)   // color pot turned: drive the RGB LED and take its color for the brush (integer only)
+      color = spectrum.set(adc.value(0));
 
-   /* Turn off all seven segments */
-   sseg.write_1ptn(0b1111111,0);
-   sseg.write_1ptn(0b1111111,1);
-   sseg.write_1ptn(0b1111111,2);
-   sseg.write_1ptn(0b1111111,3);
-   sseg.write_1ptn(0b1111111,4);
-   sseg.write_1ptn(0b1111111,5);
-   sseg.write_1ptn(0b1111111,6);
-   sseg.set_dp(0);
+   if(moved & 0x2) { // brush pot turned
+      brush_size = map_brush(adc.value(1));  // map brush sizes from 1-20 radius
+      select(&frame, 28, 159, 25, 25, 0xA8B);   // clear all borders around brushes bc we are using pot now
+      select(&frame, 63, 159, 25, 25, 0xA8B);
+      select(&frame, 28, 199, 25, 25, 0xA8B);
+      select(&frame, 58, 194, 35, 35, 0xA8B);
+   }
+}
 
-   /* Bypass all cores */
-   frame.bypass(1);
-   bar.bypass(1);
-   gray.bypass(1);
-   ghost.bypass(1);
-   osd.bypass(1);
-   mouse.bypass(1);
+void apply_mouse() {  // cursor, painting and palette clicks for the pending update
+   // take the mouse info and RGB info and use to paint, etc
+   x = pend_x;
+   y = pend_y;
+   btn_left = pend_left;
+   btn_right = pend_right;
+   mouse_pending = 0;
+
+   if(welcome_on) {
+      welcome_msg_off(&osd);  // turn off welcome message
+      welcome_on = 0;
+   }
 
-   initialize_canvas(&frame, color0, color1, color2, color3, color4, color5, color6, color7); // initialize the canvas by setting screen to white
-   welcome_msg(&osd);   // call the welcome message
-   trademark(&osd); // display trademark
+   move_brush(&mouse, x, y); // move the brush to the new mouse position
 
-   while (1) {
+   if(fill_mode && (x >= 100 && x < 540) && (y >= 70 && y < 410)) { // bucket tool inside the canvas
+      if(btn_left && !btn_left_old)   // fill once per click
+         bucket_fill(&journal, x, y, color);
+      if(btn_right)
+         draw_brush(&journal, x, y, 0xfff, brush_size, 1); // right click still erases
+      else
+         journal.lift();
+   }
+   else if((x > 100 + brush_size && x < 540 - brush_size) && (y > 70 + brush_size && y < 410 - brush_size)) { // drawing boundaries for the canvas
+      if(btn_left) { // if you are left clicking
+         draw_brush(&journal, x, y, color, brush_size, 0); // draw a circle where the cursor is
+         // uart.disp("left click\n\r");
+      }
+      if(btn_right) {   // if you are right clicking
+         draw_brush(&journal, x, y, 0xfff, brush_size, 1); // draw a WHITE circle where the cursor is (to simulate erasing)
+         // uart.disp("right click\n\r");
+      }
+      if(!btn_left && !btn_right) {
+         journal.lift(); // buttons released, end the stroke
+      }
+   }
+   else {   // if not within canvas drawing boundaries
+      journal.lift(); // leaving the canvas ends the stroke
+
+      if(btn_left) { // check if left clicking outside of canvas
+         // CLICK ON BRUSH SIZES
+         if((x > 28 && x < 52) && (y > 158 && y < 182)) {   // if left click on brush size 5 circle
+            brush_size = 5;   // set brush size
+            select(&frame, 28, 159, 25, 25, 0x001);   // draw border around brush 5
+            select(&frame, 63, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
+            select(&frame, 28, 199, 25, 25, 0xA8B);
+            select(&frame, 58, 194, 35, 35, 0xA8B);
+            uart.disp("CLICK BRUSH 5\n\r");
+         }
 
-      int ret; // for errors
+         if((x > 63 && x < 87) && (y > 158 && y < 182)) {   // if left click on brush size 8 circle
+            brush_size = 8;   // set brush size
+            select(&frame, 63, 159, 25, 25, 0x001);   // draw border around brush 8
+            select(&frame, 28, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
+            select(&frame, 28, 199, 25, 25, 0xA8B);
+            select(&frame, 58, 194, 35, 35, 0xA8B);
+            uart.disp("CLICK BRUSH 8\n\r");
+         }
 
-      double colorpot_new = pot_value_color(&adc); // grab the color potentiometer adc value
-      double colorpot_diff = colorpot_new - colorpot_old;   // calc the difference between the previous and current adc value
-      if (colorpot_diff < 0 ) 
-         colorpot_diff = colorpot_diff * -1; // keep the difference positive (absolute/magnitude value)
+         if((x > 28 && x < 52) && (y > 198 && y < 222)) {   // if left click on brush size 11 circle
+            brush_size = 11;  // set brush size
+            select(&frame, 28, 199, 25, 25, 0x001);   // draw border around brush 11
+            select(&frame, 28, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
+            select(&frame, 63, 159, 25, 25, 0xA8B);
+            select(&frame, 58, 194, 35, 35, 0xA8B);
+            uart.disp("CLICK BRUSH 11\n\r");
+         }
 
-      if(colorpot_diff > 0.008)
-         colorpotflag = true;    // if above threshold difference of 0.008, then set flag to use potentiometer color for brush
+         if((x > 58 && x < 92) && (y > 193 && y < 227)) {   // if left click on brush size 16 circle
+            brush_size = 16;  // set brush size
+            select(&frame, 58, 194, 35, 35, 0x001);   // draw border around brush 16
+            select(&frame, 28, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
+            select(&frame, 63, 159, 25, 25, 0xA8B);
+            select(&frame, 28, 199, 25, 25, 0xA8B);
+            uart.disp("CLICK BRUSH 16\n\r");
+         }
 
+         // CLICK ON PAINT COLORS
+         if((x > 37 && x < 53) && (y > 249 && y < 266)) {   // if left click on black color
+            color = 0x001; // set brush color
+            uart.disp("CLICK COLOR Black\n\r");
+         }
 
-      double brushpot_new = pot_value_brush(&adc); // grab the brush potentiometer adc value
-      double brushpot_diff = brushpot_new - brushpot_old;   // calc the difference betwen the previous and current adc value
-      if (brushpot_diff < 0 ) 
-         brushpot_diff = brushpot_diff * -1; // keep the difference positive (absolute/magnitude value)
+         if((x > 67 && x < 84) && (y > 249 && y < 266)) {   // if left click on red color
+            color = color0; // set brush color
+            uart.disp("CLICK COLOR Red\n\r");
+         }
 
-      if(brushpot_diff > 0.008)
-         brushpotflag = true;    // if above threshold difference of 0.008, then set flag to use potentiometer brush size
+         if((x > 37 && x < 53) && (y > 269 && y < 286)) {   // if left click on orange color
+            color = color1; // set brush color
+            uart.disp("CLICK COLOR Orange\n\r");
+         }
 
+         if((x > 67 && x < 84) && (y > 269 && y < 286)) {   // if left click on yellow color
+            color = color2; // set brush color
+            uart.disp("CLICK COLOR Yellow\n\r");
+         }
 
-      if(colorpot_new != colorpot_old) { // if there is a change in potentiometer value, update 
-         colorpot_old = colorpot_new;
-         if(colorpotflag){ // if change is above the threshold
-            spectrum(&pwm, colorpot_new, &r, &g, &b);   // call the RGB LED spectrum function
-            // map double rgb values from 0-15 uint
-            rint = map_rgb(r, 0.03, .999, 0, 0xf);
-            gint = map_rgb(g, 0.03, .999, 0, 0xf);
-            bint = map_rgb(b, 0.03, .999, 0, 0xf);
+         if((x > 37 && x < 53) && (y > 289 && y < 306)) {   // if left click on green color
+            color = color3; // set brush color
+            uart.disp("CLICK COLOR Green\n\r");
+         }
 
-            
-            // concatenate the individual rgb uints
-            uint16_t temp = rint << 8;
-            uint16_t temp2 = gint << 4;
-            uint16_t temp3 = bint;
-            color = (temp) | (temp2) | (temp3);
+         if((x > 67 && x < 84) && (y > 289 && y < 306)) {   // if left click on blue color
+            color = color4; // set brush color
+            uart.disp("CLICK COLOR Blue\n\r");
+         }
 
-            // uart.disp("COLOR pot\n\r");
+         if((x > 37 && x < 53) && (y > 309 && y < 326)) {   // if left click on purple color
+            color = color5; // set brush color
+            uart.disp("CLICK COLOR Purple\n\r");
          }
-      }
 
-      if(brushpot_new != brushpot_old) {  // if there is a change in potentiometer value, update
-         brushpot_old = brushpot_new;
-         if(brushpotflag) {   // if change is above the threshold
-            brush_size = map_brush(brushpot_new, 0.03, 0.999, 1, 20);  // map brush sizes from 1-15 radius
-            select(&frame, 28, 159, 25, 25, 0xA8B);   // clear all borders around brushes bc we are using pot now
-            select(&frame, 63, 159, 25, 25, 0xA8B);
-            select(&frame, 28, 199, 25, 25, 0xA8B);
-            select(&frame, 58, 194, 35, 35, 0xA8B);
-            // uart.disp("BRUSH pot\n\r");
+         if((x > 67 && x < 84) && (y > 309 && y < 326)) {   // if left click on pink color
+            color = color6; // set brush color
+            uart.disp("CLICK COLOR Pink\n\r");
          }
-         
-      }
 
-      
-      color_palette(&frame, color); // update the palette color on screen
-      
+         if((x > 37 && x < 53) && (y > 329 && y < 346)) {   // if left click on brown color
+            color = color7; // set brush color
+            uart.disp("CLICK COLOR Brown\n\r");
+         }
 
-      // take the mouse info and RGB info and use to paint, etc
-      ret = canvas_mouse(&ps2, &sseg, id, &btn_left, &btn_right, &xcord, &ycord);
-      int tmpcount = 1; // temp counter make sure welcome msg off runs only once
-      if(ret) {   // only if mouse data is valid (if you move/click the mouse)
+         if((x > 67 && x < 84) && (y > 329 && y < 346)) {   // if left click on white color
+            color = 0xfff; // set brush color
+            uart.disp("CLICK COLOR White\n\r");
+         }
 
-         if(tmpcount) {
-            welcome_msg_off(&osd);  // turn off welcome message
-            tmpcount = 0;
+         // LEFT CLICK ON CLEAR 
+         if((x > 36 && x < 82) && (y > 381 && y < 403)) {   // if leftclick on clear button
+            initialize_canvas(&frame, color0, color1, color2, color3, color4, color5, color6, color7); // clear canvas
+            journal.clear();   // a clear can be undone too
+            palette_shown = 0xffff;   // palette circle was overwritten
+            select(&frame, 36, 413, 47, 22, fill_mode ? 0x001 : 0xA8B);   // redraw fill button state
          }
-         // uart.disp("[");
-         // uart.disp(btn_left);
-         // uart.disp(", ");
-         // uart.disp(btn_right);
-         // uart.disp(", ");
-         // uart.disp(xcord);
-         // uart.disp(", ");
-         // uart.disp(ycord);
-         // uart.disp("] \r\n");
-
-         move_brush(&mouse, xcord, ycord, &x, &y); // move the brush to the new mouse position using the mouse data
-
-         if((x > 100 + brush_size && x < 540 - brush_size) && (y > 70 + brush_size && y < 410 - brush_size)) { // drawing boundaries for the canvas
-            if(btn_left) { // if you are left clicking
-               draw_brush(&frame, x, y, color, brush_size); // draw a circle where the cursor is
-               // uart.disp("left click\n\r");
-            }
-            if(btn_right) {   // if you are right clicking
-               draw_brush(&frame, x, y, 0xfff, brush_size); // draw a WHITE circle where the cursor is (to simulate erasing)
-               // uart.disp("right click\n\r");
-            }
+
+         // LEFT CLICK ON FILL
+         if((x > 36 && x < 82) && (y > 413 && y < 435) && !btn_left_old) {   // if left click on fill button
+            fill_mode = !fill_mode;   // toggle bucket tool
+            select(&frame, 36, 413, 47, 22, fill_mode ? 0x001 : 0xA8B);   // highlight while active
+            uart.disp(fill_mode ? "FILL ON\n\r" : "FILL OFF\n\r");
          }
-         else {   // if not within canvas drawing boundaries
-
-            if(btn_left) { // check if left clicking outside of canvas
-               // CLICK ON BRUSH SIZES
-               if((x > 28 && x < 52) && (y > 158 && y < 182)) {   // if left click on brush size 5 circle
-                  brush_size = 5;   // set brush size
-                  brushpotflag = false;   // unset flag so user is not using potentiometer value for brush size
-                  select(&frame, 28, 159, 25, 25, 0x001);   // draw border around brush 5
-                  select(&frame, 63, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
-                  select(&frame, 28, 199, 25, 25, 0xA8B);
-                  select(&frame, 58, 194, 35, 35, 0xA8B);
-                  uart.disp("CLICK BRUSH 5\n\r");
-               }
-
-               if((x > 63 && x < 87) && (y > 158 && y < 182)) {   // if left click on brush size 8 circle
-                  brush_size = 8;   // set brush size
-                  brushpotflag = false;   // unset flag so user is not using potentiometer value for brush size
-                  select(&frame, 63, 159, 25, 25, 0x001);   // draw border around brush 8
-                  select(&frame, 28, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
-                  select(&frame, 28, 199, 25, 25, 0xA8B);
-                  select(&frame, 58, 194, 35, 35, 0xA8B);
-                  uart.disp("CLICK BRUSH 8\n\r");
-               }
-
-               if((x > 28 && x < 52) && (y > 198 && y < 222)) {   // if left click on brush size 11 circle
-                  brush_size = 11;  // set brush size
-                  brushpotflag = false;   // unset flag so user is not using potentiometer value for brush size
-                  select(&frame, 28, 199, 25, 25, 0x001);   // draw border around brush 11
-                  select(&frame, 28, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
-                  select(&frame, 63, 159, 25, 25, 0xA8B);
-                  select(&frame, 58, 194, 35, 35, 0xA8B);
-                  uart.disp("CLICK BRUSH 11\n\r");
-               }
-
-               if((x > 58 && x < 92) && (y > 193 && y < 227)) {   // if left click on brush size 16 circle
-                  brush_size = 16;  // set brush size
-                  brushpotflag = false;   // unset flag so user is not using potentiometer value for brush size
-                  select(&frame, 58, 194, 35, 35, 0x001);   // draw border around brush 16
-                  select(&frame, 28, 159, 25, 25, 0xA8B);   // clear borders around previous brushes
-                  select(&frame, 63, 159, 25, 25, 0xA8B);
-                  select(&frame, 28, 199, 25, 25, 0xA8B);
-                  uart.disp("CLICK BRUSH 16\n\r");
-               }
-
-               // CLICK ON PAINT COLORS
-               if((x > 37 && x < 53) && (y > 249 && y < 266)) {   // if left click on black color
-                  color = 0x001; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Black\n\r");
-               }
-
-               if((x > 67 && x < 84) && (y > 249 && y < 266)) {   // if left click on red color
-                  color = color0; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Red\n\r");
-               }
-
-               if((x > 37 && x < 53) && (y > 269 && y < 286)) {   // if left click on orange color
-                  color = color1; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Orange\n\r");
-               }
-
-               if((x > 67 && x < 84) && (y > 269 && y < 286)) {   // if left click on yellow color
-                  color = color2; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Yellow\n\r");
-               }
-
-               if((x > 37 && x < 53) && (y > 289 && y < 306)) {   // if left click on green color
-                  color = color3; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Green\n\r");
-               }
-
-               if((x > 67 && x < 84) && (y > 289 && y < 306)) {   // if left click on blue color
-                  color = color4; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Blue\n\r");
-               }
-
-               if((x > 37 && x < 53) && (y > 309 && y < 326)) {   // if left click on purple color
-                  color = color5; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Purple\n\r");
-               }
-
-               if((x > 67 && x < 84) && (y > 309 && y < 326)) {   // if left click on pink color
-                  color = color6; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Pink\n\r");
-               }
-
-               if((x > 37 && x < 53) && (y > 329 && y < 346)) {   // if left click on brown color
-                  color = color7; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR Brown\n\r");
-               }
-
-               if((x > 67 && x < 84) && (y > 329 && y < 346)) {   // if left click on white color
-                  color = 0xfff; // set brush color
-                  colorpotflag = false;   // unset flag so user is not using potentiometer value for brush color
-                  uart.disp("CLICK COLOR White\n\r");
-               }
-
-               // LEFT CLICK ON CLEAR 
-               if((x > 36 && x < 82) && (y > 381 && y < 403)) {   // if leftclick on clear button
-                  initialize_canvas(&frame, color0, color1, color2, color3, color4, color5, color6, color7); // clear canvas
-               }
-
-
-            }
 
+         // LEFT CLICK ON UNDO / REDO
+         if((x > 559 && x < 605) && (y > 93 && y < 114) && !btn_left_old) {   // if left click on undo button
+            if(!journal.undo())
+               uart.disp("nothing to undo\n\r");
+         }
+         if((x > 559 && x < 605) && (y > 125 && y < 146) && !btn_left_old) {   // if left click on redo button
+            if(!journal.redo())
+               uart.disp("nothing to redo\n\r");
          }
-         
-      }
-           
 
-      float mag_new = tapper(&spi); // grab the new magnitude from the accelerometer
-      spike = mag_new - mag_old; // calc the difference between the magnitudes (spike)
 
+      }
 
-      if(mag_new != mag_old)  // if there is a spike, update the magnitudes
-         mag_old = mag_new;
+   }
+   btn_left_old = btn_left;
+}
+
+void task_accel() {  // 10 Hz: shake the board to clear the canvas
+   int n, i, ax, ay, az;
+   int shaken = 0;
+   unsigned long t;
 
-      if(spike > 1.0) { // if spike exceeds a certain threshhold
-         initialize_canvas(&frame, color0, color1, color2, color3, color4, color5, color6, color7); // clear the canvas
-         // uart.disp("canvas cleared\n\n\r");
+   {
+      IO_PROF_SCOPE("accel");
+      TRACE_SCOPE("accel");
+      n = accel.poll();  // samples since the last poll (the sensor fifo holds 1.7 s)
+   }
+   t = now_ms();
+   for (i = 0; i < n; i++) {
+      accel.sample(i, &ax, &ay, &az);
+      if (shake.feed(ax, ay, az))
+         shaken = 1;
+      if (accel_log) {  // "<ms> acl <x> <y> <z>", 10 ms apart, newest at t
+         uart.disp((int) (t - 10 * (n - 1 - i)));
+         uart.disp(" acl ");
+         uart.disp(ax);
+         uart.disp(" ");
+         uart.disp(ay);
+         uart.disp(" ");
+         uart.disp(az);
+         uart.disp("\n\r");
       }
-         
+   }
+   if(shaken) { // back-and-forth strokes, not a single bump
+      initialize_canvas(&frame, color0, color1, color2, color3, color4, color5, color6, color7); // clear the canvas
+      journal.clear();
+      palette_shown = 0xffff;   // palette circle was overwritten
+      select(&frame, 36, 413, 47, 22, fill_mode ? 0x001 : 0xA8B);   // redraw fill button state
+      // uart.disp("canvas cleared\n\n\r");
+   }
+}
+
+void task_mouse() {  // every pass: collect cursor updates
+   int l, r, nx, ny;
+
+   if(!canvas_mouse(&pointer, id, &l, &r, &nx, &ny))  // merge queued packets into one cursor update
+      return;  // only if mouse data is valid (if you move/click the mouse)
+   if(mouse_pending && (l != pend_left || r != pend_right))
+      apply_mouse();  // button change: do not merge it with the pending update
+   pend_x = nx;
+   pend_y = ny;
+   pend_left = l;
+   pend_right = r;
+   mouse_pending = 1;
+   if(!frame_paced)
+      apply_mouse();  // not paced: draw right away
+}
+
+void task_frame() {  // every pass: in paced mode, flush updates once per frame in vblank
+   uint32_t n;
+
+   if(frame_paced) {
+      n = frame.frame_count();
+      if(n == last_frame)
+         return;  // wait for the next vertical blank
+      last_frame = n;
+   }
+   if(mouse_pending)
+      apply_mouse();  // sprite move and brush writes while the beam is off screen
+   if(color != palette_shown) {  // redraw the palette circle when the color changed
+      color_palette(&frame, color); // update the palette color on screen
+      palette_shown = color;
+   }
+}
+
+void task_console() {   // 10 Hz: uart console commands
+   int old;
+
+   old = uart.tx_policy(UartCore::TX_WAIT);  // requested output is never dropped
+   console(uart.rx_byte());
+   uart.tx_policy(old);
+}
+
+void task_uart() {   // every pass: move queued console output into the uart fifo
+   uart.pump();
+}
+
+int main() {
+
+   srand(NULL);
+   id = ps2_init(&ps2);   // grab mouse ID
+   pointer.set_xy(x, y);   // cursor starts at the center
+
+   rand();  // skip one value to keep the previous palette
+   color1 = rand() % 4094;
+   color2 = rand() % 4094;
+   color3 = rand() % 4094;
+   color4 = rand() % 4094;
+   color5 = rand() % 4094;
+   color6 = rand() % 4094;
+   color7 = rand() % 4094;
 
+   /* Turn off all seven segments */
+   sseg.write_1ptn(0b1111111,0);
+   sseg.write_1ptn(0b1111111,1);
+   sseg.write_1ptn(0b1111111,2);
+   sseg.write_1ptn(0b1111111,3);
+   sseg.write_1ptn(0b1111111,4);
+   sseg.write_1ptn(0b1111111,5);
+   sseg.write_1ptn(0b1111111,6);
+   sseg.set_dp(0);
+
+   /* Bypass all cores */
+   frame.bypass(1);
+   bar.bypass(1);
+   gray.bypass(1);
+   ghost.bypass(1);
+   osd.bypass(1);
+   mouse.bypass(1);
+
+   initialize_canvas(&frame, color0, color1, color2, color3, color4, color5, color6, color7); // initialize the canvas by setting screen to white
+   welcome_msg(&osd);   // call the welcome message
+   trademark(&osd); // display trademark
+   pwm.set_freq(50);   // rgb led pwm rate
+   adc.set_filter(0, 2, 8);  // pots: 1/4 IIR, report moves of more than 8 LSBs
+   adc.set_filter(1, 2, 8);
+   adc.set_hw_avg(16);  // average 16 conversions on chip if the core has the DRP port
+   if (!accel.init())   // set up the accelerometer once
+      uart.disp("ADXL362 not found\n\r");
+   flood.set_clip(100, 70, 539, 409);   // bucket fill stays inside the canvas
+   journal.set_canvas(100, 70, 440, 340, 0xfff);   // undo rebuilds the canvas from white
+   snap.set_canvas(100, 70, 440, 340);
+   journal.set_snap(&snap);   // ... or from a recent snapshot
+   xfer.set_canvas(100, 70, 440, 340);
+   frame_paced = frame.wait_vblank();  // pace updates to vblank if the frame counter is present
+   last_frame = frame.frame_count();
+
+#ifndef _UART_DIRECT   // -D_UART_DIRECT: output waits for the uart fifo as before (uart_replay.sh)
+   uart.tx_policy(UartCore::TX_DROP);   // messages from the paint path never wait for the uart
+#endif
+   sched.add("mouse", task_mouse, 0);
+   sched.add("pots", task_pots, 20000);
+   sched.add("accel", task_accel, 100000);
+   sched.add("frame", task_frame, 0);
+   sched.add("console", task_console, 100000);
+   sched.add("uart", task_uart, 0);
+
+   while (1) {
+      sched.run();
    } //while
 
 